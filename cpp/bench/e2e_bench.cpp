@@ -0,0 +1,386 @@
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <termios.h>
+#include <unistd.h>
+
+#if defined(__APPLE__)
+#include <util.h>
+#else
+#include <pty.h>
+#endif
+
+#include "serialtab.h"
+#include "timestampformatter.h"
+
+// End-to-end benchmark: drives SerialTab instances through pseudo-terminals
+// with a synthetic line generator and measures what reaches the screen.
+// Every generated line starts with "<seq> <monotonic ns> " so the harness can
+// compute write-to-paint latency and detect lost lines from the LineStore.
+
+struct Config {
+    int ports = 1;
+    int seconds = 10;
+    double linesPerSecond = 20000;
+    int minLength = 16;
+    int maxLength = 160;
+    bool exponentialLength = false;
+    int burstLines = 0;
+    int burstIntervalMs = 1000;
+    double noisePercent = 0;
+    QString jsonPath;
+};
+
+struct PortRun {
+    int master = -1;
+    int slave = -1;
+    QString slaveName;
+    SerialTab* tab = nullptr;
+    std::thread generator;
+    std::atomic<quint64> linesWritten{0};
+    std::atomic<quint64> bytesWritten{0};
+
+    qsizetype checkedLines = 0;
+    quint64 nextSeq = 0;
+    quint64 linesSeen = 0;
+    quint64 bytesSeen = 0;
+    quint64 linesLost = 0;
+    std::vector<qint64> latenciesNs;
+};
+
+static std::atomic<bool> g_stop{false};
+
+static void usage() {
+    std::fprintf(stderr,
+                 "usage: e2e-bench [--ports N] [--seconds S] [--rate LINES_PER_S]\n"
+                 "                 [--min-len N] [--max-len N] [--len-dist uniform|exponential]\n"
+                 "                 [--burst-lines N] [--burst-interval-ms MS] [--noise PERCENT]\n"
+                 "                 [--json PATH]\n");
+}
+
+static bool parseArgs(const QStringList& args, Config* config) {
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& arg = args[i];
+        if (i + 1 >= args.size()) return false;
+        const QString value = args[++i];
+        if (arg == "--ports") config->ports = qMax(1, value.toInt());
+        else if (arg == "--seconds") config->seconds = qMax(1, value.toInt());
+        else if (arg == "--rate") config->linesPerSecond = qMax(1.0, value.toDouble());
+        else if (arg == "--min-len") config->minLength = qMax(1, value.toInt());
+        else if (arg == "--max-len") config->maxLength = qMax(1, value.toInt());
+        else if (arg == "--len-dist") config->exponentialLength = value == "exponential";
+        else if (arg == "--burst-lines") config->burstLines = qMax(0, value.toInt());
+        else if (arg == "--burst-interval-ms") config->burstIntervalMs = qMax(1, value.toInt());
+        else if (arg == "--noise") config->noisePercent = qBound(0.0, value.toDouble(), 100.0);
+        else if (arg == "--json") config->jsonPath = value;
+        else return false;
+    }
+    config->maxLength = qMax(config->maxLength, config->minLength);
+    return true;
+}
+
+static bool openPty(PortRun* port) {
+    char name[256] = {};
+    if (openpty(&port->master, &port->slave, name, nullptr, nullptr) != 0) return false;
+    termios tio;
+    if (tcgetattr(port->slave, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(port->slave, TCSANOW, &tio);
+    }
+    fcntl(port->master, F_SETFL, fcntl(port->master, F_GETFL) | O_NONBLOCK);
+    port->slaveName = QString::fromLocal8Bit(name);
+    return true;
+}
+
+// Writes lines on a 1 ms schedule so the offered rate holds regardless of
+// how the pty drains; bursts are extra lines written back to back.
+static void generate(PortRun* port, const Config& config, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> uniformLength(config.minLength, config.maxLength);
+    std::exponential_distribution<double> expLength(1.0 / ((config.minLength + config.maxLength) / 2.0));
+    std::uniform_int_distribution<int> printable(0x21, 0x7e);
+    std::uniform_int_distribution<int> anyByte(0, 255);
+    std::uniform_real_distribution<double> percent(0.0, 100.0);
+
+    const qint64 startNs = TimestampFormatter::monotonicNs();
+    qint64 nextBurstNs = startNs + qint64(config.burstIntervalMs) * 1000000;
+    quint64 burstTotal = 0;
+    quint64 seq = 0;
+    std::vector<char> buffer;
+
+    while (!g_stop.load(std::memory_order_relaxed)) {
+        const qint64 now = TimestampFormatter::monotonicNs();
+        if (config.burstLines > 0 && now >= nextBurstNs) {
+            burstTotal += quint64(config.burstLines);
+            nextBurstNs += qint64(config.burstIntervalMs) * 1000000;
+        }
+        const quint64 target = quint64(double(now - startNs) / 1e9 * config.linesPerSecond) + burstTotal;
+        const quint64 due = target > seq ? target - seq : 0;
+
+        buffer.clear();
+        for (quint64 i = 0; i < due; ++i) {
+            char header[48];
+            const int headerLen = std::snprintf(header, sizeof(header), "%llu %lld ",
+                                                static_cast<unsigned long long>(seq++),
+                                                static_cast<long long>(TimestampFormatter::monotonicNs()));
+            buffer.insert(buffer.end(), header, header + headerLen);
+            int length = config.exponentialLength ? config.minLength + int(expLength(rng)) : uniformLength(rng);
+            length = qBound(config.minLength, length, config.maxLength * 4);
+            const bool noisy = config.noisePercent > 0 && percent(rng) < config.noisePercent;
+            for (int c = 0; c < length; ++c) {
+                char byte = char(printable(rng));
+                if (noisy) {
+                    byte = char(anyByte(rng));
+                    if (byte == '\n' || byte == '\r' || byte == '\0') byte = '?';
+                }
+                buffer.push_back(byte);
+            }
+            buffer.push_back('\n');
+        }
+
+        std::size_t offset = 0;
+        while (offset < buffer.size() && !g_stop.load(std::memory_order_relaxed)) {
+            const ssize_t n = ::write(port->master, buffer.data() + offset, buffer.size() - offset);
+            if (n < 0) {
+                if (errno == EAGAIN) std::this_thread::sleep_for(std::chrono::microseconds(200));
+                if (errno == EINTR || errno == EAGAIN) continue;
+                return;
+            }
+            offset += std::size_t(n);
+        }
+        port->linesWritten.store(seq, std::memory_order_relaxed);
+        port->bytesWritten.fetch_add(offset, std::memory_order_relaxed);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+static bool parseNumber(QByteArrayView line, qsizetype* pos, quint64* value) {
+    const qsizetype start = *pos;
+    quint64 v = 0;
+    while (*pos < line.size() && line[*pos] >= '0' && line[*pos] <= '9') v = v * 10 + quint64(line[(*pos)++] - '0');
+    if (*pos == start || *pos >= line.size() || line[*pos] != ' ') return false;
+    ++*pos;
+    *value = v;
+    return true;
+}
+
+static bool parseHeader(QByteArrayView line, quint64* seq, qint64* ns) {
+    qsizetype pos = 0;
+    quint64 stamp = 0;
+    if (!parseNumber(line, &pos, seq) || !parseNumber(line, &pos, &stamp)) return false;
+    *ns = qint64(stamp);
+    return true;
+}
+
+// Paint events on the log viewport mark when lines actually reach the screen.
+class PaintProbe : public QObject {
+public:
+    PaintProbe(PortRun* port, QObject* parent) : QObject(parent), m_port(port) {}
+
+protected:
+    bool eventFilter(QObject* watched, QEvent* event) override {
+        if (event->type() == QEvent::Paint) collect();
+        return QObject::eventFilter(watched, event);
+    }
+
+private:
+    void collect() {
+        const qint64 now = TimestampFormatter::monotonicNs();
+        const LineStore& store = m_port->tab->lineStore();
+        const qsizetype complete = store.completeLineCount();
+        for (; m_port->checkedLines < complete; ++m_port->checkedLines) {
+            const QByteArrayView line = store.line(m_port->checkedLines);
+            quint64 seq = 0;
+            qint64 ns = 0;
+            m_port->bytesSeen += quint64(line.size()) + 1;
+            if (!parseHeader(line, &seq, &ns)) continue;
+            if (seq > m_port->nextSeq) m_port->linesLost += seq - m_port->nextSeq;
+            m_port->nextSeq = seq + 1;
+            ++m_port->linesSeen;
+            m_port->latenciesNs.push_back(now - ns);
+        }
+    }
+
+    PortRun* m_port;
+};
+
+static double percentile(std::vector<qint64>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    const std::size_t index = std::min(sorted.size() - 1, std::size_t(p / 100.0 * double(sorted.size())));
+    return double(sorted[index]) / 1e6;
+}
+
+static qint64 peakRssBytes() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return qint64(usage.ru_maxrss);
+#else
+    return qint64(usage.ru_maxrss) * 1024;
+#endif
+}
+
+int main(int argc, char** argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+    QApplication app(argc, argv);
+
+    Config config;
+    if (!parseArgs(app.arguments(), &config)) {
+        usage();
+        return 2;
+    }
+
+    std::vector<std::unique_ptr<PortRun>> ports;
+    for (int i = 0; i < config.ports; ++i) {
+        auto port = std::make_unique<PortRun>();
+        if (!openPty(port.get())) {
+            std::fprintf(stderr, "openpty failed: %s\n", std::strerror(errno));
+            return 1;
+        }
+        port->tab = new SerialTab(port->slaveName);
+        port->tab->resize(1000, 600);
+        port->tab->show();
+        port->tab->logView()->viewport()->installEventFilter(new PaintProbe(port.get(), port->tab));
+        port->tab->connectPort();
+        ports.push_back(std::move(port));
+    }
+
+    // Frame stalls: gaps between 16 ms ticks of the GUI event loop.
+    QElapsedTimer frameClock;
+    qint64 lastTickMs = 0;
+    qint64 maxGapMs = 0;
+    int stalls = 0;
+    QTimer frameTimer;
+    frameTimer.setInterval(16);
+    QObject::connect(&frameTimer, &QTimer::timeout, [&]() {
+        const qint64 now = frameClock.elapsed();
+        const qint64 gap = now - lastTickMs;
+        lastTickMs = now;
+        maxGapMs = qMax(maxGapMs, gap);
+        if (gap > 50) ++stalls;
+    });
+
+    QElapsedTimer runClock;
+    const qint64 drainMs = 2000;
+
+    auto startGenerators = [&]() {
+        for (std::size_t i = 0; i < ports.size(); ++i) {
+            ports[i]->generator = std::thread(generate, ports[i].get(), std::cref(config), unsigned(1234 + i));
+        }
+        frameClock.start();
+        frameTimer.start();
+        runClock.start();
+        QTimer::singleShot(config.seconds * 1000, [&]() {
+            g_stop = true;
+            for (auto& port : ports) port->generator.join();
+            QTimer::singleShot(drainMs, &app, &QApplication::quit);
+        });
+    };
+
+    QTimer waitOpen;
+    QElapsedTimer openClock;
+    openClock.start();
+    QObject::connect(&waitOpen, &QTimer::timeout, [&]() {
+        const bool allOpen = std::all_of(ports.begin(), ports.end(), [](const auto& p) { return p->tab->isConnected(); });
+        if (allOpen) {
+            waitOpen.stop();
+            startGenerators();
+        } else if (openClock.elapsed() > 5000) {
+            std::fprintf(stderr, "ports did not open\n");
+            app.exit(1);
+        }
+    });
+    waitOpen.start(10);
+
+    const int rc = app.exec();
+    if (rc != 0) return rc;
+    const double elapsedS = double(runClock.elapsed() - drainMs) / 1000.0;
+
+    QJsonArray portResults;
+    quint64 totalBytes = 0;
+    quint64 totalLines = 0;
+    std::vector<qint64> allLatencies;
+    for (auto& port : ports) {
+        const quint64 written = port->linesWritten.load();
+        const quint64 lost = port->linesLost + (written > port->nextSeq ? written - port->nextSeq : 0);
+        std::vector<qint64>& lat = port->latenciesNs;
+        allLatencies.insert(allLatencies.end(), lat.begin(), lat.end());
+        std::sort(lat.begin(), lat.end());
+
+        QJsonObject result;
+        result["port"] = port->slaveName;
+        result["lines_written"] = qint64(written);
+        result["bytes_written"] = qint64(port->bytesWritten.load());
+        result["lines_seen"] = qint64(port->linesSeen);
+        result["lines_lost"] = qint64(lost);
+        result["bytes_dropped"] = qint64(port->tab->droppedBytes());
+        result["latency_p50_ms"] = percentile(lat, 50);
+        result["latency_p99_ms"] = percentile(lat, 99);
+        portResults.append(result);
+        totalBytes += port->bytesSeen;
+        totalLines += port->linesSeen;
+    }
+    std::sort(allLatencies.begin(), allLatencies.end());
+
+    QJsonObject settings;
+    settings["ports"] = config.ports;
+    settings["seconds"] = config.seconds;
+    settings["lines_per_second"] = config.linesPerSecond;
+    settings["min_length"] = config.minLength;
+    settings["max_length"] = config.maxLength;
+    settings["length_distribution"] = config.exponentialLength ? "exponential" : "uniform";
+    settings["burst_lines"] = config.burstLines;
+    settings["burst_interval_ms"] = config.burstIntervalMs;
+    settings["noise_percent"] = config.noisePercent;
+
+    QJsonObject report;
+    report["config"] = settings;
+    report["bytes_per_second"] = double(totalBytes) / elapsedS;
+    report["lines_per_second"] = double(totalLines) / elapsedS;
+    report["latency_p50_ms"] = percentile(allLatencies, 50);
+    report["latency_p90_ms"] = percentile(allLatencies, 90);
+    report["latency_p99_ms"] = percentile(allLatencies, 99);
+    report["latency_p999_ms"] = percentile(allLatencies, 99.9);
+    report["latency_max_ms"] = allLatencies.empty() ? 0.0 : double(allLatencies.back()) / 1e6;
+    report["peak_rss_bytes"] = peakRssBytes();
+    report["frame_stalls"] = stalls;
+    report["max_frame_gap_ms"] = maxGapMs;
+    report["ports"] = portResults;
+
+    const QByteArray json = QJsonDocument(report).toJson();
+    if (config.jsonPath.isEmpty()) {
+        std::fwrite(json.constData(), 1, std::size_t(json.size()), stdout);
+    } else {
+        QFile file(config.jsonPath);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::fprintf(stderr, "cannot write %s\n", qPrintable(config.jsonPath));
+            return 1;
+        }
+        file.write(json);
+    }
+
+    for (auto& port : ports) {
+        delete port->tab;
+        ::close(port->master);
+        ::close(port->slave);
+    }
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <QByteArray>
+#include <QtEndian>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "framedecoder.h"
+
+// Feeds ~64 MB of encoded frames through each FrameDecoder in read-sized
+// chunks and compares the throughput with what a 3 Mbaud UART can deliver.
+// Every chunk is first copied into a scratch buffer, as a port read would
+// be, since the delimited decoders work in place.
+
+static const std::size_t kTotalBytes = 64 * 1024 * 1024;
+static const double kLineRateBytes = 3000000.0 / 10.0;
+
+static QByteArray payload(std::mt19937& rng, int minSize, int maxSize) {
+    std::uniform_int_distribution<int> size(minSize, maxSize);
+    std::uniform_int_distribution<int> byte(0, 255);
+    QByteArray data(size(rng), Qt::Uninitialized);
+    for (char& c : data) c = char(byte(rng));
+    return data;
+}
+
+static QByteArray withCcitt(QByteArray data) {
+    const quint16 crc = FrameDecoder::crc16Ccitt(data);
+    data.append(char(crc >> 8));
+    data.append(char(crc & 0xFF));
+    return data;
+}
+
+static void appendSlip(QByteArray& out, const QByteArray& frame) {
+    for (char c : frame) {
+        if (c == char(0xC0)) out.append("\xDB\xDC", 2);
+        else if (c == char(0xDB)) out.append("\xDB\xDD", 2);
+        else out.append(c);
+    }
+    out.append(char(0xC0));
+}
+
+static void appendCobs(QByteArray& out, const QByteArray& frame) {
+    qsizetype codePos = out.size();
+    out.append(char(1));
+    for (char c : frame) {
+        if (c != 0) {
+            out.append(c);
+            ++out[codePos];
+            if (out[codePos] != char(0xFF)) continue;
+        }
+        codePos = out.size();
+        out.append(char(1));
+    }
+    out.append(char(0));
+}
+
+static void appendLengthPrefixed(QByteArray& out, const QByteArray& frame) {
+    char header[2];
+    qToLittleEndian<quint16>(quint16(frame.size()), header);
+    out.append(header, 2);
+    out.append(frame);
+}
+
+template <typename Encode>
+static QByteArray makeStream(Encode&& encode, int minSize, int maxSize, std::size_t* frames) {
+    std::mt19937 rng(42);
+    QByteArray data;
+    data.reserve(qsizetype(kTotalBytes + 1024));
+    *frames = 0;
+    while (std::size_t(data.size()) < kTotalBytes) {
+        encode(data, withCcitt(payload(rng, minSize, maxSize)));
+        ++*frames;
+    }
+    return data;
+}
+
+static std::vector<std::size_t> makeChunks(std::size_t total) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> size(64, 4096);
+    std::vector<std::size_t> chunks;
+    for (std::size_t pos = 0; pos < total;) {
+        const std::size_t n = std::min(size(rng), total - pos);
+        chunks.push_back(n);
+        pos += n;
+    }
+    return chunks;
+}
+
+static void run(const char* name, const FrameOptions& options, const QByteArray& input, std::size_t expected) {
+    const std::vector<std::size_t> chunks = makeChunks(std::size_t(input.size()));
+    FrameDecoder decoder(options);
+    QByteArray scratch(4096, Qt::Uninitialized);
+    std::size_t frames = 0;
+    std::size_t bad = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    std::size_t pos = 0;
+    for (const std::size_t n : chunks) {
+        std::copy_n(input.constData() + pos, n, scratch.data());
+        decoder.feed(scratch.data(), qsizetype(n), [&](const FrameDecoder::Frame& frame) {
+            ++frames;
+            if (!frame.valid || frame.crc != FrameDecoder::Check::Ok) ++bad;
+        });
+        pos += n;
+    }
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const double bytesPerSec = double(input.size()) / secs;
+    std::printf("%-10s %8.1f MB/s %12.0f frames/s %7.0fx line rate  (%zu frames, %zu bad)\n", name,
+                bytesPerSec / (1024.0 * 1024.0), double(frames) / secs, bytesPerSec / kLineRateBytes, frames, bad);
+    if (frames != expected || bad != 0) std::printf("%-10s expected %zu good frames\n", name, expected);
+}
+
+int main() {
+    std::size_t frames = 0;
+    FrameOptions options;
+    options.crc = FrameOptions::Crc::Crc16Ccitt;
+
+    options.kind = FrameOptions::Kind::Slip;
+    const QByteArray slip = makeStream(appendSlip, 8, 256, &frames);
+    run("slip", options, slip, frames);
+
+    options.kind = FrameOptions::Kind::Cobs;
+    const QByteArray cobs = makeStream(appendCobs, 8, 256, &frames);
+    run("cobs", options, cobs, frames);
+
+    options.kind = FrameOptions::Kind::LengthPrefixed;
+    const QByteArray length = makeStream(appendLengthPrefixed, 8, 256, &frames);
+    run("length", options, length, frames);
+
+    options.kind = FrameOptions::Kind::FixedSize;
+    options.fixedSize = 34;
+    const QByteArray fixed = makeStream([](QByteArray& out, const QByteArray& frame) { out.append(frame); },
+                                        32, 32, &frames);
+    run("fixed", options, fixed, frames);
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "ingestkernel.h"
+
+// Compares the byte-level IngestKernel against the QString path SerialTab
+// used before it: fromUtf8, three replace() passes and a split('\n').
+
+static const std::size_t kTotalBytes = 64 * 1024 * 1024;
+
+static QByteArray makeInput() {
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> lineLen(8, 160);
+    std::uniform_int_distribution<int> printable(0x20, 0x7e);
+    std::uniform_int_distribution<int> percent(0, 99);
+
+    QByteArray data;
+    data.reserve(qsizetype(kTotalBytes + 256));
+    while (std::size_t(data.size()) < kTotalBytes) {
+        const int len = lineLen(rng);
+        for (int i = 0; i < len; ++i) data.append(char(printable(rng)));
+        if (percent(rng) < 2) data.append('\0');
+        data.append(percent(rng) < 80 ? "\r\n" : "\n");
+    }
+    return data;
+}
+
+static std::vector<std::size_t> makeChunks(std::size_t total) {
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::size_t> size(64, 4096);
+    std::vector<std::size_t> chunks;
+    for (std::size_t pos = 0; pos < total;) {
+        const std::size_t n = std::min(size(rng), total - pos);
+        chunks.push_back(n);
+        pos += n;
+    }
+    return chunks;
+}
+
+static std::size_t runLegacy(const QByteArray& input, const std::vector<std::size_t>& chunks) {
+    QString lineBuffer;
+    std::size_t lines = 0;
+    std::size_t pos = 0;
+    for (const std::size_t n : chunks) {
+        QString text = QString::fromUtf8(input.constData() + pos, qsizetype(n));
+        text.replace(QChar('\0'), QString());
+        text.replace("\r\n", "\n");
+        text.replace("\r", "\n");
+        QStringList split = (lineBuffer + text).split('\n');
+        lineBuffer = split.takeLast();
+        lines += std::size_t(split.size());
+        pos += n;
+    }
+    return lines;
+}
+
+static std::size_t runKernel(IngestKernel::Isa isa, const QByteArray& input, const std::vector<std::size_t>& chunks) {
+    IngestKernel kernel(isa);
+    std::vector<char> out(4096 + IngestKernel::kMaxCarry);
+    std::vector<std::uint32_t> lineEnds;
+    std::size_t lines = 0;
+    std::size_t pos = 0;
+    for (const std::size_t n : chunks) {
+        lineEnds.clear();
+        kernel.process(input.constData() + pos, n, out.data(), lineEnds);
+        lines += lineEnds.size();
+        pos += n;
+    }
+    return lines;
+}
+
+template <typename Fn>
+static void report(const char* name, std::size_t bytes, Fn&& fn) {
+    const auto start = std::chrono::steady_clock::now();
+    const std::size_t lines = fn();
+    const double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::printf("%-8s %10.1f MB/s %12.0f lines/s  (%zu lines)\n", name,
+                double(bytes) / secs / (1024.0 * 1024.0), double(lines) / secs, lines);
+}
+
+int main() {
+    const QByteArray input = makeInput();
+    const std::vector<std::size_t> chunks = makeChunks(std::size_t(input.size()));
+    const std::size_t bytes = std::size_t(input.size());
+
+    report("legacy", bytes, [&] { return runLegacy(input, chunks); });
+    report("scalar", bytes, [&] { return runKernel(IngestKernel::Isa::Scalar, input, chunks); });
+    if (IngestKernel(IngestKernel::Isa::Sse2).isa() == IngestKernel::Isa::Sse2) {
+        report("sse2", bytes, [&] { return runKernel(IngestKernel::Isa::Sse2, input, chunks); });
+    }
+    if (IngestKernel(IngestKernel::Isa::Avx2).isa() == IngestKernel::Isa::Avx2) {
+        report("avx2", bytes, [&] { return runKernel(IngestKernel::Isa::Avx2, input, chunks); });
+    }
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include "ansiparser.h"
+
+#include <QVarLengthArray>
+
+#include <cstring>
+
+static const char kEsc = '\x1b';
+static const qsizetype kMaxParams = 64;
+
+static constexpr quint32 rgb(int r, int g, int b) {
+    return 0xff000000u | quint32(r) << 16 | quint32(g) << 8 | quint32(b);
+}
+
+static const quint32 kPalette[16] = {
+    rgb(0, 0, 0),       rgb(205, 49, 49),   rgb(13, 188, 121),  rgb(229, 229, 16),
+    rgb(36, 114, 200),  rgb(188, 63, 188),  rgb(17, 168, 205),  rgb(229, 229, 229),
+    rgb(102, 102, 102), rgb(241, 76, 76),   rgb(35, 209, 139),  rgb(245, 245, 67),
+    rgb(59, 142, 234),  rgb(214, 112, 214), rgb(41, 184, 219),  rgb(255, 255, 255),
+};
+
+// xterm's 256-colour table: 16 system colours, a 6x6x6 cube, 24 greys.
+static quint32 indexedColor(int index) {
+    if (index < 16) return kPalette[index];
+    if (index < 232) {
+        static const int levels[6] = {0, 95, 135, 175, 215, 255};
+        index -= 16;
+        return rgb(levels[index / 36], levels[(index / 6) % 6], levels[index % 6]);
+    }
+    const int grey = 8 + (index - 232) * 10;
+    return rgb(grey, grey, grey);
+}
+
+void AnsiParser::reset() {
+    m_state = State::Text;
+    m_style = TextStyle();
+    m_params.clear();
+}
+
+void AnsiParser::feed(QByteArrayView in, QByteArray* out, QVector<StyleRun>* changes) {
+    const char* p = in.data();
+    const char* end = p + in.size();
+    while (p < end) {
+        if (m_state == State::Text) {
+            const char* esc = static_cast<const char*>(std::memchr(p, kEsc, std::size_t(end - p)));
+            const char* textEnd = esc ? esc : end;
+            out->append(p, textEnd - p);
+            if (!esc) return;
+            m_state = State::Escape;
+            p = esc + 1;
+            continue;
+        }
+
+        const char c = *p;
+        if (uchar(c) < 0x20 && c != kEsc && c != '\a') {
+            m_state = State::Text;
+            continue;
+        }
+        ++p;
+
+        switch (m_state) {
+        case State::Escape:
+            if (c == '[') {
+                m_state = State::Csi;
+                m_params.resize(0);
+                m_csiPlain = true;
+            } else if (c == ']') {
+                m_state = State::Osc;
+            } else if (uchar(c) >= 0x20 && uchar(c) <= 0x2f) {
+                m_state = State::EscapeIntermediate;
+            } else if (c != kEsc) {
+                m_state = State::Text;
+            }
+            break;
+        case State::EscapeIntermediate:
+            if (uchar(c) >= 0x30) m_state = State::Text;
+            break;
+        case State::Csi:
+            if (uchar(c) >= 0x40 && uchar(c) <= 0x7e) {
+                m_state = State::Text;
+                if (c == 'm' && m_csiPlain) {
+                    const TextStyle before = m_style;
+                    applySgr();
+                    if (m_style != before) {
+                        if (!changes->isEmpty() && changes->last().offset == out->size()) {
+                            changes->last().style = m_style;
+                        } else {
+                            changes->append({out->size(), m_style});
+                        }
+                    }
+                }
+            } else if (uchar(c) >= 0x30 && uchar(c) <= 0x3f) {
+                if ((c >= '<' && c <= '?') || m_params.size() >= kMaxParams) m_csiPlain = false;
+                else m_params.append(c);
+            } else if (c == kEsc) {
+                m_state = State::Escape;
+            } else {
+                m_csiPlain = false;
+            }
+            break;
+        case State::Osc:
+            if (c == '\a') m_state = State::Text;
+            else if (c == kEsc) m_state = State::OscEscape;
+            break;
+        case State::OscEscape:
+            m_state = c == '\\' ? State::Text : State::Osc;
+            break;
+        case State::Text:
+            break;
+        }
+    }
+}
+
+void AnsiParser::applySgr() {
+    QVarLengthArray<int, 16> codes;
+    int value = 0;
+    bool any = false;
+    for (char c : m_params) {
+        if (c >= '0' && c <= '9') {
+            value = qMin(value * 10 + (c - '0'), 0xffff);
+            any = true;
+        } else {
+            codes.append(any ? value : 0);
+            value = 0;
+            any = false;
+        }
+    }
+    codes.append(any ? value : 0);
+
+    for (qsizetype i = 0; i < codes.size(); ++i) {
+        const int code = codes[i];
+        if (code == 0) {
+            m_style = TextStyle();
+        } else if (code == 1) {
+            m_style.flags |= TextStyle::Bold;
+        } else if (code == 2) {
+            m_style.flags |= TextStyle::Dim;
+        } else if (code == 3) {
+            m_style.flags |= TextStyle::Italic;
+        } else if (code == 4) {
+            m_style.flags |= TextStyle::Underline;
+        } else if (code == 7) {
+            m_style.flags |= TextStyle::Inverse;
+        } else if (code == 22) {
+            m_style.flags &= ~(TextStyle::Bold | TextStyle::Dim);
+        } else if (code == 23) {
+            m_style.flags &= ~TextStyle::Italic;
+        } else if (code == 24) {
+            m_style.flags &= ~TextStyle::Underline;
+        } else if (code == 27) {
+            m_style.flags &= ~TextStyle::Inverse;
+        } else if (code >= 30 && code <= 37) {
+            m_style.fg = kPalette[code - 30];
+        } else if (code == 39) {
+            m_style.fg = 0;
+        } else if (code >= 40 && code <= 47) {
+            m_style.bg = kPalette[code - 40];
+        } else if (code == 49) {
+            m_style.bg = 0;
+        } else if (code >= 90 && code <= 97) {
+            m_style.fg = kPalette[code - 90 + 8];
+        } else if (code >= 100 && code <= 107) {
+            m_style.bg = kPalette[code - 100 + 8];
+        } else if (code == 38 || code == 48) {
+            quint32 color = 0;
+            if (i + 2 < codes.size() && codes[i + 1] == 5) {
+                color = indexedColor(qBound(0, codes[i + 2], 255));
+                i += 2;
+            } else if (i + 4 < codes.size() && codes[i + 1] == 2) {
+                color = rgb(qMin(codes[i + 2], 255), qMin(codes[i + 3], 255), qMin(codes[i + 4], 255));
+                i += 4;
+            } else {
+                break;
+            }
+            (code == 38 ? m_style.fg : m_style.bg) = color;
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QVector>
+
+// Character attributes selected by ANSI SGR sequences. Colours are 0xAARRGGBB
+// like QRgb; 0 means the view's default, real colours are always opaque.
+struct TextStyle {
+    enum Flag : quint8 { Bold = 0x01, Dim = 0x02, Italic = 0x04, Underline = 0x08, Inverse = 0x10 };
+
+    quint32 fg = 0;
+    quint32 bg = 0;
+    quint8 flags = 0;
+
+    bool isPlain() const { return fg == 0 && bg == 0 && flags == 0; }
+    bool operator==(const TextStyle& other) const {
+        return fg == other.fg && bg == other.bg && flags == other.flags;
+    }
+    bool operator!=(const TextStyle& other) const { return !(*this == other); }
+};
+
+// A style that applies from byte `offset` up to the next run.
+struct StyleRun {
+    qsizetype offset = 0;
+    TextStyle style;
+};
+
+// Streaming ANSI escape parser. Escape sequences are removed from the text;
+// SGR sequences update the current style and every other CSI, OSC or
+// two-byte escape is dropped. A sequence split across feed() calls is
+// finished by the next one. Control bytes abort an unfinished sequence so
+// line noise cannot swallow a newline.
+class AnsiParser {
+public:
+    // Appends the text of `in` to `out` and, whenever the style changes,
+    // records a run whose offset is the position in `out`.
+    void feed(QByteArrayView in, QByteArray* out, QVector<StyleRun>* changes);
+    void reset();
+
+    bool isIdle() const { return m_state == State::Text; }
+    const TextStyle& style() const { return m_style; }
+
+private:
+    enum class State { Text, Escape, EscapeIntermediate, Csi, Osc, OscEscape };
+
+    void applySgr();
+
+    State m_state = State::Text;
+    TextStyle m_style;
+    QByteArray m_params;
+    bool m_csiPlain = true;
+};
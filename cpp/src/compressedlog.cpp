@@ -0,0 +1,357 @@
+#include "compressedlog.h"
+
+#include <QDataStream>
+
+#include <algorithm>
+#include <cstring>
+
+static const char kFileMagic[4] = {'U', 'L', 'V', 'Z'};
+static const char kIndexMagic[4] = {'U', 'L', 'V', 'I'};
+static const quint32 kVersion = 2;
+static const qint64 kHeaderSize = 8;
+static const qint64 kFooterSize = 16;
+static const int kCachedBlocks = 4;
+
+namespace CompressedLog {
+
+bool isCompressedLogPath(const QString& path) {
+    return path.endsWith(".ulz", Qt::CaseInsensitive);
+}
+
+static qint64 blockHeaderSize(quint32 version) {
+    return version >= 2 ? 40 : 28;
+}
+
+static qint64 indexEntrySize(quint32 version) {
+    return version >= 2 ? 48 : 36;
+}
+
+static void writeHeader(QDataStream& out, const BlockInfo& b, quint32 version) {
+    out << b.compressedSize << b.lineCount << b.longestLine << b.firstLine << b.firstMs;
+    if (version >= 2) out << b.lastMs << b.marksSize;
+}
+
+// Version 1 blocks only know their first time.
+static void readHeader(QDataStream& in, BlockInfo& b, quint32 version) {
+    in >> b.compressedSize >> b.lineCount >> b.longestLine >> b.firstLine >> b.firstMs;
+    b.lastMs = b.firstMs;
+    b.marksSize = 0;
+    if (version >= 2) in >> b.lastMs >> b.marksSize;
+}
+
+static bool readFooter(QFile& file, quint32 version, QVector<BlockInfo>* blocks, qint64* dataEnd) {
+    const qint64 size = file.size();
+    if (size < kHeaderSize + kFooterSize || !file.seek(size - kFooterSize)) return false;
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    qint64 indexOffset = 0;
+    quint32 count = 0;
+    char magic[4];
+    in >> indexOffset >> count;
+    if (in.readRawData(magic, 4) != 4 || std::memcmp(magic, kIndexMagic, 4) != 0) return false;
+    if (indexOffset < kHeaderSize || indexOffset > size - kFooterSize) return false;
+    if (qint64(count) * indexEntrySize(version) != size - kFooterSize - indexOffset) return false;
+
+    file.seek(indexOffset);
+    blocks->resize(count);
+    for (BlockInfo& b : *blocks) {
+        in >> b.offset;
+        readHeader(in, b, version);
+    }
+    *dataEnd = indexOffset;
+    return in.status() == QDataStream::Ok;
+}
+
+static void scanHeaders(QFile& file, quint32 version, QVector<BlockInfo>* blocks, qint64* dataEnd) {
+    const qint64 size = file.size();
+    const qint64 headerSize = blockHeaderSize(version);
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    blocks->clear();
+
+    qint64 pos = kHeaderSize;
+    while (pos + headerSize <= size && file.seek(pos)) {
+        BlockInfo b;
+        b.offset = pos;
+        readHeader(in, b, version);
+        const qint64 end = pos + headerSize + b.marksSize + b.compressedSize;
+        if (in.status() != QDataStream::Ok || end > size) break;
+        blocks->append(b);
+        pos = end;
+    }
+    *dataEnd = pos;
+}
+
+// Reads the version and block list of an existing file, falling back to a
+// header walk when the trailing index is missing or damaged.
+static bool loadBlocks(QFile& file, quint32* version, QVector<BlockInfo>* blocks, qint64* dataEnd) {
+    char magic[4];
+    if (!file.seek(0) || file.read(magic, 4) != 4 || std::memcmp(magic, kFileMagic, 4) != 0) return false;
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in >> *version;
+    if (in.status() != QDataStream::Ok || *version < 1 || *version > kVersion) return false;
+    if (!readFooter(file, *version, blocks, dataEnd)) scanHeaders(file, *version, blocks, dataEnd);
+    return true;
+}
+
+}
+
+using CompressedLog::BlockInfo;
+
+bool CompressedLogEncoder::begin(QFile* file) {
+    m_file = file;
+    m_version = kVersion;
+    m_blocks.clear();
+    m_nextLine = 0;
+    m_block.resize(0);
+    m_blockLines = 0;
+    m_blockLongest = 0;
+    m_blockMarks.clear();
+    m_partial.resize(0);
+
+    if (file->size() > 0) {
+        qint64 dataEnd = 0;
+        if (!CompressedLog::loadBlocks(*file, &m_version, &m_blocks, &dataEnd)) return false;
+        if (!m_blocks.isEmpty()) m_nextLine = m_blocks.last().firstLine + m_blocks.last().lineCount;
+        file->resize(dataEnd);
+        return file->seek(dataEnd);
+    }
+
+    QDataStream out(file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.writeRawData(kFileMagic, 4);
+    out << kVersion;
+    return out.status() == QDataStream::Ok;
+}
+
+// Marks are only kept where the time changes, and never go backwards.
+void CompressedLogEncoder::addMark(quint32 line, qint64 ms) {
+    if (!m_blockMarks.isEmpty()) {
+        ms = qMax(ms, m_blockMarks.last().second);
+        if (ms == m_blockMarks.last().second) return;
+    }
+    m_blockMarks.append({line, ms});
+}
+
+void CompressedLogEncoder::append(QByteArrayView data, qint64 timeMs) {
+    if (!m_file || data.isEmpty()) return;
+
+    qsizetype lastNl = data.size() - 1;
+    while (lastNl >= 0 && data[lastNl] != '\n') --lastNl;
+    if (lastNl < 0) {
+        if (m_partial.isEmpty()) m_partialMs = timeMs;
+        m_partial.append(data);
+        return;
+    }
+
+    if (m_block.isEmpty()) {
+        m_blockFirstMs = m_partial.isEmpty() ? timeMs : m_partialMs;
+        m_blockAge.start();
+    }
+
+    // A line carried over from an earlier append started at that append's
+    // time; every other line here starts at this one's.
+    const char* p = data.data();
+    const char* end = p + lastNl + 1;
+    qsizetype carried = m_partial.size();
+    qint64 lineMs = m_partial.isEmpty() ? timeMs : m_partialMs;
+    while (p < end) {
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const quint32 length = quint32(carried + (nl - p));
+        m_blockLongest = std::max(m_blockLongest, length);
+        addMark(m_blockLines, lineMs);
+        m_blockLastMs = m_blockMarks.last().second;
+        ++m_blockLines;
+        carried = 0;
+        lineMs = timeMs;
+        p = nl + 1;
+    }
+
+    m_block.append(m_partial);
+    m_block.append(data.first(lastNl + 1));
+    m_partial = data.sliced(lastNl + 1).toByteArray();
+    m_partialMs = timeMs;
+
+    if (m_block.size() >= kBlockBytes) flushBlock();
+}
+
+void CompressedLogEncoder::flushBlock() {
+    if (!m_file || m_block.isEmpty()) return;
+    writeBlock(m_block, m_blockLines, m_blockLongest);
+    m_block.resize(0);
+    m_blockLines = 0;
+    m_blockLongest = 0;
+    m_blockMarks.clear();
+}
+
+void CompressedLogEncoder::flushIfStale() {
+    if (!m_block.isEmpty() && m_blockAge.elapsed() >= kMaxBlockAgeMs) flushBlock();
+}
+
+void CompressedLogEncoder::finish() {
+    if (!m_file) return;
+    flushBlock();
+    if (!m_partial.isEmpty()) {
+        m_blockFirstMs = m_partialMs;
+        m_blockLastMs = m_partialMs;
+        addMark(0, m_partialMs);
+        writeBlock(m_partial, 1, quint32(m_partial.size()));
+        m_partial.resize(0);
+        m_blockMarks.clear();
+    }
+
+    QDataStream out(m_file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    const qint64 indexOffset = m_file->pos();
+    for (const BlockInfo& b : m_blocks) {
+        out << b.offset;
+        CompressedLog::writeHeader(out, b, m_version);
+    }
+    out << indexOffset << quint32(m_blocks.size());
+    out.writeRawData(kIndexMagic, 4);
+    m_file = nullptr;
+}
+
+void CompressedLogEncoder::writeBlock(QByteArrayView data, quint32 lines, quint32 longest) {
+    const QByteArray compressed = qCompress(reinterpret_cast<const uchar*>(data.data()), data.size());
+    QByteArray marks;
+    if (m_version >= 2) {
+        QDataStream table(&marks, QIODevice::WriteOnly);
+        table.setByteOrder(QDataStream::LittleEndian);
+        for (const auto& mark : m_blockMarks) table << mark.first << mark.second;
+        marks = qCompress(marks);
+    }
+
+    BlockInfo b;
+    b.offset = m_file->pos();
+    b.compressedSize = quint32(compressed.size());
+    b.lineCount = lines;
+    b.longestLine = longest;
+    b.firstLine = m_nextLine;
+    b.firstMs = m_blockFirstMs;
+    b.lastMs = m_blockLastMs;
+    b.marksSize = quint32(marks.size());
+
+    QDataStream out(m_file);
+    out.setByteOrder(QDataStream::LittleEndian);
+    CompressedLog::writeHeader(out, b, m_version);
+    out.writeRawData(marks.constData(), int(marks.size()));
+    out.writeRawData(compressed.constData(), int(compressed.size()));
+
+    m_blocks.append(b);
+    m_nextLine += lines;
+}
+
+bool CompressedLogReader::open(const QString& path, QString* error) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    qint64 dataEnd = 0;
+    if (!CompressedLog::loadBlocks(m_file, &m_version, &m_blocks, &dataEnd)) {
+        if (error) *error = "Not a compressed UART log.";
+        return false;
+    }
+    m_longest = 0;
+    for (const BlockInfo& b : m_blocks) m_longest = std::max<qsizetype>(m_longest, b.longestLine);
+    m_cache.clear();
+    return true;
+}
+
+qsizetype CompressedLogReader::lineCount() const {
+    if (m_blocks.isEmpty()) return 0;
+    return m_blocks.last().firstLine + m_blocks.last().lineCount;
+}
+
+const CompressedLogReader::CachedBlock& CompressedLogReader::loadBlock(int block) const {
+    for (CachedBlock& c : m_cache) {
+        if (c.block == block) {
+            c.lastUse = ++m_useCounter;
+            return c;
+        }
+    }
+
+    if (m_cache.size() < kCachedBlocks) m_cache.append(CachedBlock());
+    CachedBlock* slot = &m_cache.first();
+    for (CachedBlock& c : m_cache) {
+        if (c.lastUse < slot->lastUse) slot = &c;
+    }
+
+    const BlockInfo& info = m_blocks.at(block);
+    slot->block = block;
+    slot->lastUse = ++m_useCounter;
+    slot->starts.clear();
+    slot->marks.clear();
+    if (m_file.seek(info.offset + CompressedLog::blockHeaderSize(m_version))) {
+        const QByteArray marks = info.marksSize > 0 ? qUncompress(m_file.read(info.marksSize)) : QByteArray();
+        slot->data = qUncompress(m_file.read(info.compressedSize));
+        QDataStream table(marks);
+        table.setByteOrder(QDataStream::LittleEndian);
+        while (!table.atEnd()) {
+            QPair<quint32, qint64> mark;
+            table >> mark.first >> mark.second;
+            if (table.status() != QDataStream::Ok) break;
+            slot->marks.append(mark);
+        }
+    } else {
+        slot->data.clear();
+    }
+
+    const char* base = slot->data.constData();
+    const char* p = base;
+    const char* end = base + slot->data.size();
+    while (p < end) {
+        slot->starts.append(p - base);
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        p = nl ? nl + 1 : end;
+    }
+    slot->starts.append(slot->data.size());
+    return *slot;
+}
+
+QByteArrayView CompressedLogReader::line(qsizetype index) const {
+    if (index < 0 || index >= lineCount()) return {};
+    auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), index,
+                               [](qsizetype line, const BlockInfo& b) { return line < b.firstLine; });
+    const int block = int(it - m_blocks.cbegin()) - 1;
+    const CachedBlock& c = loadBlock(block);
+    const qsizetype local = index - m_blocks.at(block).firstLine;
+    if (local + 1 >= c.starts.size()) return {};
+
+    const qsizetype start = c.starts.at(local);
+    qsizetype end = c.starts.at(local + 1);
+    if (end > start && c.data.at(end - 1) == '\n') --end;
+    return QByteArrayView(c.data.constData() + start, end - start);
+}
+
+// The block is found from the index; within it the marks give the last
+// line that started at or before `ms`. Version 1 blocks have no marks and
+// resolve to their first line.
+qsizetype CompressedLogReader::lineForTime(qint64 ms) const {
+    if (m_blocks.isEmpty()) return 0;
+    auto it = std::upper_bound(m_blocks.cbegin(), m_blocks.cend(), ms,
+                               [](qint64 t, const BlockInfo& b) { return t < b.firstMs; });
+    if (it == m_blocks.cbegin()) return 0;
+    const int block = int(it - m_blocks.cbegin()) - 1;
+    const BlockInfo& info = m_blocks.at(block);
+    if (info.marksSize == 0) return info.firstLine;
+    if (ms >= info.lastMs) return info.firstLine + info.lineCount - 1;
+
+    const CachedBlock& c = loadBlock(block);
+    auto mark = std::upper_bound(c.marks.cbegin(), c.marks.cend(), ms,
+                                 [](qint64 t, const QPair<quint32, qint64>& m) { return t < m.second; });
+    if (mark == c.marks.cbegin()) return info.firstLine;
+    const qsizetype next = mark == c.marks.cend() ? qsizetype(info.lineCount) : qsizetype(mark->first);
+    return info.firstLine + next - 1;
+}
+
+qint64 CompressedLogReader::firstTime() const {
+    return m_blocks.isEmpty() ? 0 : m_blocks.first().firstMs;
+}
+
+qint64 CompressedLogReader::lastTime() const {
+    return m_blocks.isEmpty() ? 0 : m_blocks.last().lastMs;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QPair>
+#include <QVector>
+
+#include "linesource.h"
+
+// Block-compressed log format (.ulz). Lines are grouped into independent
+// zlib blocks (qCompress), each carrying its first line number and the
+// arrival times of its first and last lines. Each block also has a
+// compressed table of { u32 line in block, i64 ms } marks where the arrival
+// time changes. A trailing index repeats the headers so a reader can seek to
+// any line or time by decompressing a single block:
+//
+//   "ULVZ" u32 version
+//   { u32 size, u32 lines, u32 longest, i64 firstLine, i64 firstMs, i64 lastMs,
+//     u32 marksSize, marks[marksSize], data[size] } ...
+//   { i64 offset, u32 size, u32 lines, u32 longest, i64 firstLine, i64 firstMs,
+//     i64 lastMs, u32 marksSize } ...
+//   i64 indexOffset, u32 blockCount, "ULVI"
+//
+// All integers are little-endian. Version 1 files lack lastMs, marksSize and
+// the marks; they are still read, and appended to in their own format. A
+// file without the footer (for example after a crash) is still readable by
+// walking the block headers.
+namespace CompressedLog {
+
+struct BlockInfo {
+    qint64 offset = 0;
+    quint32 compressedSize = 0;
+    quint32 lineCount = 0;
+    quint32 longestLine = 0;
+    qint64 firstLine = 0;
+    qint64 firstMs = 0;
+    qint64 lastMs = 0;
+    quint32 marksSize = 0;
+};
+
+bool isCompressedLogPath(const QString& path);
+
+}
+
+class CompressedLogEncoder {
+public:
+    static const qsizetype kBlockBytes = 256 * 1024;
+    static const int kMaxBlockAgeMs = 5000;
+
+    bool begin(QFile* file);
+    void append(QByteArrayView data, qint64 timeMs);
+    void flushBlock();
+    void flushIfStale();
+    void finish();
+
+private:
+    void addMark(quint32 line, qint64 ms);
+    void writeBlock(QByteArrayView data, quint32 lines, quint32 longest);
+
+    QFile* m_file = nullptr;
+    quint32 m_version = 0;
+    QVector<CompressedLog::BlockInfo> m_blocks;
+    qint64 m_nextLine = 0;
+
+    QByteArray m_block;
+    quint32 m_blockLines = 0;
+    quint32 m_blockLongest = 0;
+    qint64 m_blockFirstMs = 0;
+    qint64 m_blockLastMs = 0;
+    QVector<QPair<quint32, qint64>> m_blockMarks;
+    QElapsedTimer m_blockAge;
+
+    QByteArray m_partial;
+    qint64 m_partialMs = 0;
+};
+
+class CompressedLogReader : public LineSource {
+public:
+    bool open(const QString& path, QString* error);
+
+    qsizetype lineCount() const override;
+    QByteArrayView line(qsizetype index) const override;
+    qsizetype longestLine() const override { return m_longest; }
+
+    bool hasTimeIndex() const override { return true; }
+    qsizetype lineForTime(qint64 ms) const override;
+    qint64 firstTime() const override;
+    qint64 lastTime() const override;
+
+    qsizetype blockCount() const { return m_blocks.size(); }
+
+private:
+    struct CachedBlock {
+        int block = -1;
+        quint64 lastUse = 0;
+        QByteArray data;
+        QVector<qsizetype> starts;
+        QVector<QPair<quint32, qint64>> marks;
+    };
+
+    bool readIndex();
+    void scanBlocks();
+    const CachedBlock& loadBlock(int block) const;
+
+    mutable QFile m_file;
+    quint32 m_version = 0;
+    QVector<CompressedLog::BlockInfo> m_blocks;
+    qsizetype m_longest = 0;
+
+    mutable QVector<CachedBlock> m_cache;
+    mutable quint64 m_useCounter = 0;
+};
@@ -0,0 +1,87 @@
+#include "exportdialog.h"
+
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+#include <climits>
+
+ExportDialog::ExportDialog(const LineSource* source, qsizetype selectionFirst, qsizetype selectionLast, QWidget* parent)
+    : QDialog(parent), m_source(source), m_lineCount(source->lineCount()),
+      m_selectionFirst(selectionFirst), m_selectionLast(selectionLast) {
+    setWindowTitle("Save Logs");
+
+    m_all = new QRadioButton("All lines", this);
+    m_selection = new QRadioButton("Selected lines", this);
+    m_lines = new QRadioButton("Lines", this);
+    m_time = new QRadioButton("Time", this);
+    m_all->setChecked(true);
+    m_selection->setEnabled(selectionFirst >= 0);
+
+    const int maxLine = int(qMin<qsizetype>(qMax<qsizetype>(m_lineCount, 1), INT_MAX));
+    m_fromLine = new QSpinBox(this);
+    m_fromLine->setRange(1, maxLine);
+    m_fromLine->setValue(1);
+    m_toLine = new QSpinBox(this);
+    m_toLine->setRange(1, maxLine);
+    m_toLine->setValue(maxLine);
+
+    m_fromTime = new QDateTimeEdit(this);
+    m_toTime = new QDateTimeEdit(this);
+    m_fromTime->setDisplayFormat("dd-MM-yyyy HH:mm:ss");
+    m_toTime->setDisplayFormat("dd-MM-yyyy HH:mm:ss");
+    if (source->hasTimeIndex()) {
+        const QDateTime first = QDateTime::fromMSecsSinceEpoch(source->firstTime());
+        const QDateTime last = QDateTime::fromMSecsSinceEpoch(source->lastTime());
+        m_fromTime->setDateTimeRange(first, last);
+        m_toTime->setDateTimeRange(first, last);
+        m_fromTime->setDateTime(first);
+        m_toTime->setDateTime(last);
+    } else {
+        m_time->setEnabled(false);
+        m_fromTime->setEnabled(false);
+        m_toTime->setEnabled(false);
+    }
+
+    auto grid = new QGridLayout();
+    grid->addWidget(m_all, 0, 0);
+    grid->addWidget(m_selection, 1, 0);
+    grid->addWidget(m_lines, 2, 0);
+    grid->addWidget(m_fromLine, 2, 1);
+    grid->addWidget(new QLabel("to", this), 2, 2);
+    grid->addWidget(m_toLine, 2, 3);
+    grid->addWidget(m_time, 3, 0);
+    grid->addWidget(m_fromTime, 3, 1);
+    grid->addWidget(new QLabel("to", this), 3, 2);
+    grid->addWidget(m_toTime, 3, 3);
+
+    auto okBtn = new QPushButton("Save...", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(grid);
+    layout->addLayout(buttons);
+}
+
+qsizetype ExportDialog::firstLine() const {
+    if (m_selection->isChecked()) return m_selectionFirst;
+    if (m_lines->isChecked()) return m_fromLine->value() - 1;
+    if (m_time->isChecked()) return qMax<qsizetype>(0, m_source->lineForTime(m_fromTime->dateTime().toMSecsSinceEpoch()));
+    return 0;
+}
+
+qsizetype ExportDialog::lastLine() const {
+    if (m_selection->isChecked()) return m_selectionLast + 1;
+    if (m_lines->isChecked()) return qMin<qsizetype>(m_lineCount, m_toLine->value());
+    if (m_time->isChecked()) return m_source->lineForTime(m_toTime->dateTime().toMSecsSinceEpoch()) + 1;
+    return m_lineCount;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QDialog>
+#include <QDateTimeEdit>
+#include <QRadioButton>
+#include <QSpinBox>
+
+#include "linesource.h"
+
+// Picks the line range for Save Logs: everything, the current selection, a
+// line span, or a time span on sources with a time index.
+class ExportDialog : public QDialog {
+    Q_OBJECT
+public:
+    ExportDialog(const LineSource* source, qsizetype selectionFirst, qsizetype selectionLast, QWidget* parent = nullptr);
+
+    // Half-open range [first, last) into the source.
+    qsizetype firstLine() const;
+    qsizetype lastLine() const;
+
+private:
+    const LineSource* m_source;
+    qsizetype m_lineCount;
+    qsizetype m_selectionFirst;
+    qsizetype m_selectionLast;
+    QRadioButton* m_all;
+    QRadioButton* m_selection;
+    QRadioButton* m_lines;
+    QRadioButton* m_time;
+    QSpinBox* m_fromLine;
+    QSpinBox* m_toLine;
+    QDateTimeEdit* m_fromTime;
+    QDateTimeEdit* m_toTime;
+};
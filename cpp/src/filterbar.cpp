@@ -0,0 +1,75 @@
+#include "filterbar.h"
+
+#include <QHBoxLayout>
+#include <QPushButton>
+
+FilterBar::FilterBar(QWidget* parent)
+    : QWidget(parent) {
+    m_include = new QLineEdit(this);
+    m_include->setPlaceholderText("ERR, WDT, I2C");
+    m_exclude = new QLineEdit(this);
+    m_regex = new QCheckBox("Regex", this);
+    m_matchCase = new QCheckBox("Match case", this);
+    m_mode = new QComboBox(this);
+    m_mode->addItem("Hide others");
+    m_mode->addItem("Dim others");
+    m_summary = new QLabel(this);
+
+    auto applyBtn = new QPushButton("Apply", this);
+    auto clearBtn = new QPushButton("Clear", this);
+
+    connect(m_include, &QLineEdit::returnPressed, this, &FilterBar::filterChanged);
+    connect(m_exclude, &QLineEdit::returnPressed, this, &FilterBar::filterChanged);
+    connect(applyBtn, &QPushButton::clicked, this, &FilterBar::filterChanged);
+    connect(m_regex, &QCheckBox::toggled, this, &FilterBar::filterChanged);
+    connect(m_matchCase, &QCheckBox::toggled, this, &FilterBar::filterChanged);
+    connect(m_mode, &QComboBox::currentIndexChanged, this, &FilterBar::filterChanged);
+    connect(clearBtn, &QPushButton::clicked, this, [this]() {
+        m_include->clear();
+        m_exclude->clear();
+        emit filterChanged();
+    });
+
+    auto row = new QHBoxLayout(this);
+    row->setContentsMargins(0, 0, 0, 0);
+    row->addWidget(new QLabel("Include:", this));
+    row->addWidget(m_include);
+    row->addWidget(new QLabel("Exclude:", this));
+    row->addWidget(m_exclude);
+    row->addWidget(m_regex);
+    row->addWidget(m_matchCase);
+    row->addWidget(m_mode);
+    row->addWidget(applyBtn);
+    row->addWidget(clearBtn);
+    row->addWidget(m_summary);
+}
+
+QStringList FilterBar::patterns(const QLineEdit* edit) const {
+    const QString text = edit->text().trimmed();
+    if (text.isEmpty()) return {};
+    if (m_regex->isChecked()) return {text};
+
+    QStringList out;
+    for (const QString& part : text.split(',')) {
+        const QString pattern = part.trimmed();
+        if (!pattern.isEmpty()) out.append(pattern);
+    }
+    return out;
+}
+
+LineFilter::Spec FilterBar::spec() const {
+    LineFilter::Spec spec;
+    spec.include = patterns(m_include);
+    spec.exclude = patterns(m_exclude);
+    spec.regex = m_regex->isChecked();
+    spec.matchCase = m_matchCase->isChecked();
+    return spec;
+}
+
+FilteredLineSource::Mode FilterBar::mode() const {
+    return m_mode->currentIndex() == 1 ? FilteredLineSource::Mode::Dim : FilteredLineSource::Mode::Hide;
+}
+
+void FilterBar::setSummary(const QString& text) {
+    m_summary->setText(text);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <QWidget>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
+
+#include "linefilter.h"
+
+// Per-tab include/exclude filter controls. Literal patterns are separated by
+// commas; in regex mode each field is a single expression.
+class FilterBar : public QWidget {
+    Q_OBJECT
+public:
+    explicit FilterBar(QWidget* parent = nullptr);
+
+    LineFilter::Spec spec() const;
+    FilteredLineSource::Mode mode() const;
+    void setSummary(const QString& text);
+
+signals:
+    void filterChanged();
+
+private:
+    QStringList patterns(const QLineEdit* edit) const;
+
+    QLineEdit* m_include;
+    QLineEdit* m_exclude;
+    QCheckBox* m_regex;
+    QCheckBox* m_matchCase;
+    QComboBox* m_mode;
+    QLabel* m_summary;
+};
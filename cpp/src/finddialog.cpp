@@ -2,7 +2,42 @@
 
 #include <QHBoxLayout>
 #include <QVBoxLayout>
-#include <QLabel>
+#include <QAbstractListModel>
+#include <QLocale>
+
+// Lists the engine's matches as "line: text"; rows are only converted when
+// the view asks for them.
+class SearchResultModel : public QAbstractListModel {
+public:
+    SearchResultModel(SearchEngine* engine, QObject* parent)
+        : QAbstractListModel(parent), m_engine(engine) {}
+
+    int rowCount(const QModelIndex& parent) const override {
+        return parent.isValid() ? 0 : int(m_rows);
+    }
+
+    QVariant data(const QModelIndex& index, int role) const override {
+        if (role != Qt::DisplayRole || !m_engine->source() || index.row() >= m_rows) return {};
+        const SearchMatch& match = m_engine->matches().at(index.row());
+        return QString("%1: %2").arg(match.line + 1).arg(m_engine->source()->lineText(match.line).left(200));
+    }
+
+    void clear() {
+        beginResetModel();
+        m_rows = 0;
+        endResetModel();
+    }
+
+    void append(qsizetype first, qsizetype count) {
+        beginInsertRows(QModelIndex(), int(first), int(first + count - 1));
+        m_rows = first + count;
+        endInsertRows();
+    }
+
+private:
+    SearchEngine* m_engine;
+    qsizetype m_rows = 0;
+};
 
 FindDialog::FindDialog(QWidget* parent)
     : QDialog(parent) {
@@ -11,14 +46,29 @@ FindDialog::FindDialog(QWidget* parent)
 
     m_query = new QLineEdit(this);
     m_matchCase = new QCheckBox("Match case", this);
+    m_regex = new QCheckBox("Regular expression", this);
     m_down = new QRadioButton("Down", this);
     m_up = new QRadioButton("Up", this);
     m_down->setChecked(true);
 
+    m_countLabel = new QLabel(this);
+    m_results = new QListView(this);
+    m_results->setUniformItemSizes(true);
+    m_results->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_results->hide();
+
     auto findBtn = new QPushButton("Find Next", this);
+    auto findAllBtn = new QPushButton("Find All", this);
     auto closeBtn = new QPushButton("Close", this);
 
     connect(findBtn, &QPushButton::clicked, this, &FindDialog::findNextRequested);
+    connect(findAllBtn, &QPushButton::clicked, this, [this]() {
+        m_results->show();
+        emit findAllRequested();
+    });
+    connect(m_results, &QListView::activated, this, [this](const QModelIndex& index) {
+        emit matchActivated(index.row());
+    });
     connect(closeBtn, &QPushButton::clicked, this, &FindDialog::close);
 
     auto row = new QHBoxLayout();
@@ -27,6 +77,7 @@ FindDialog::FindDialog(QWidget* parent)
 
     auto opts = new QHBoxLayout();
     opts->addWidget(m_matchCase);
+    opts->addWidget(m_regex);
     opts->addSpacing(10);
     opts->addWidget(new QLabel("Direction:", this));
     opts->addWidget(m_down);
@@ -34,18 +85,62 @@ FindDialog::FindDialog(QWidget* parent)
     opts->addStretch();
 
     auto buttons = new QHBoxLayout();
+    buttons->addWidget(m_countLabel);
     buttons->addStretch();
     buttons->addWidget(findBtn);
+    buttons->addWidget(findAllBtn);
     buttons->addWidget(closeBtn);
 
     auto layout = new QVBoxLayout(this);
     layout->addLayout(row);
     layout->addLayout(opts);
     layout->addLayout(buttons);
+    layout->addWidget(m_results);
 
     m_query->setFocus();
 }
 
 QString FindDialog::query() const { return m_query->text(); }
 bool FindDialog::matchCase() const { return m_matchCase->isChecked(); }
+bool FindDialog::useRegex() const { return m_regex->isChecked(); }
 bool FindDialog::directionDown() const { return m_down->isChecked(); }
+
+SearchEngine::Query FindDialog::searchQuery() const {
+    SearchEngine::Query q;
+    q.text = query();
+    q.matchCase = matchCase();
+    q.regex = useRegex();
+    return q;
+}
+
+void FindDialog::setEngine(SearchEngine* engine) {
+    m_engine = engine;
+    m_model = new SearchResultModel(engine, this);
+    m_results->setModel(m_model);
+
+    connect(engine, &SearchEngine::cleared, this, [this]() {
+        m_model->clear();
+        updateCount();
+    });
+    connect(engine, &SearchEngine::matchesAdded, this, [this](qsizetype first, qsizetype count) {
+        m_model->append(first, count);
+    });
+    connect(engine, &SearchEngine::progress, this, &FindDialog::updateCount);
+}
+
+void FindDialog::setStatus(const QString& text) {
+    m_countLabel->setText(text);
+}
+
+void FindDialog::updateCount() {
+    if (!m_engine || !m_engine->isActive()) {
+        m_countLabel->clear();
+        return;
+    }
+    QString text = QString("%1 matches").arg(QLocale().toString(m_engine->totalMatches()));
+    if (m_engine->totalMatches() > m_engine->matches().size()) {
+        text += QString(", first %1 listed").arg(QLocale().toString(qlonglong(m_engine->matches().size())));
+    }
+    if (!m_engine->isCaughtUp()) text += " (searching...)";
+    m_countLabel->setText(text);
+}
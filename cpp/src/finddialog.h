@@ -5,6 +5,12 @@
 #include <QCheckBox>
 #include <QRadioButton>
 #include <QPushButton>
+#include <QLabel>
+#include <QListView>
+
+#include "searchengine.h"
+
+class SearchResultModel;
 
 class FindDialog : public QDialog {
     Q_OBJECT
@@ -13,14 +19,28 @@ public:
 
     QString query() const;
     bool matchCase() const;
+    bool useRegex() const;
     bool directionDown() const;
+    SearchEngine::Query searchQuery() const;
+
+    void setEngine(SearchEngine* engine);
+    void setStatus(const QString& text);
 
 signals:
     void findNextRequested();
+    void findAllRequested();
+    void matchActivated(qsizetype index);
 
 private:
+    void updateCount();
+
     QLineEdit* m_query;
     QCheckBox* m_matchCase;
+    QCheckBox* m_regex;
     QRadioButton* m_down;
     QRadioButton* m_up;
+    QLabel* m_countLabel;
+    QListView* m_results;
+    SearchResultModel* m_model = nullptr;
+    SearchEngine* m_engine = nullptr;
 };
@@ -0,0 +1,105 @@
+#include "framedecoder.h"
+
+#include <QtEndian>
+
+#include <array>
+
+QString FrameOptions::describe() const {
+    QString text;
+    switch (kind) {
+    case Kind::None: return "None";
+    case Kind::Slip: text = "SLIP"; break;
+    case Kind::Cobs: text = "COBS"; break;
+    case Kind::LengthPrefixed:
+        text = QString("Length (%1 B %2)").arg(lengthBytes).arg(bigEndian ? "BE" : "LE");
+        break;
+    case Kind::FixedSize: text = QString("Fixed %1 B").arg(fixedSize); break;
+    }
+    switch (crc) {
+    case Crc::None: break;
+    case Crc::Crc16Ccitt: text += " + CRC-16/CCITT"; break;
+    case Crc::Crc16Modbus: text += " + CRC-16/Modbus"; break;
+    case Crc::Crc32: text += " + CRC-32"; break;
+    }
+    return text;
+}
+
+FrameDecoder::FrameDecoder(const FrameOptions& options)
+    : m_options(options), m_decoder(makeDecoder(options)) {}
+
+FrameDecoder::Decoder FrameDecoder::makeDecoder(const FrameOptions& options) {
+    switch (options.kind) {
+    case FrameOptions::Kind::Cobs: return Framing::CobsDecoder(options.maxFrame);
+    case FrameOptions::Kind::LengthPrefixed: return Framing::LengthPrefixedDecoder(options);
+    case FrameOptions::Kind::FixedSize: return Framing::FixedSizeDecoder(options.fixedSize);
+    case FrameOptions::Kind::Slip:
+    case FrameOptions::Kind::None: break;
+    }
+    return Framing::SlipDecoder(options.maxFrame);
+}
+
+void FrameDecoder::reset() {
+    std::visit([](auto& decoder) { decoder.reset(); }, m_decoder);
+}
+
+// The CRC occupies the last bytes of the frame: CRC-16/CCITT big-endian as it
+// is usually transmitted, Modbus and CRC-32 little-endian.
+FrameDecoder::Check FrameDecoder::checkCrc(QByteArrayView frame) const {
+    const uchar* bytes = reinterpret_cast<const uchar*>(frame.data());
+    switch (m_options.crc) {
+    case FrameOptions::Crc::None:
+        return Check::None;
+    case FrameOptions::Crc::Crc16Ccitt:
+        if (frame.size() < 2) return Check::Bad;
+        return crc16Ccitt(frame.chopped(2)) == qFromBigEndian<quint16>(bytes + frame.size() - 2) ? Check::Ok
+                                                                                                   : Check::Bad;
+    case FrameOptions::Crc::Crc16Modbus:
+        if (frame.size() < 2) return Check::Bad;
+        return crc16Modbus(frame.chopped(2)) == qFromLittleEndian<quint16>(bytes + frame.size() - 2) ? Check::Ok
+                                                                                                      : Check::Bad;
+    case FrameOptions::Crc::Crc32:
+        if (frame.size() < 4) return Check::Bad;
+        return crc32(frame.chopped(4)) == qFromLittleEndian<quint32>(bytes + frame.size() - 4) ? Check::Ok
+                                                                                                : Check::Bad;
+    }
+    return Check::None;
+}
+
+template <typename T, T Poly, bool Reflected>
+static std::array<T, 256> makeCrcTable() {
+    std::array<T, 256> table{};
+    const int bits = int(sizeof(T)) * 8;
+    for (unsigned i = 0; i < 256; ++i) {
+        T crc;
+        if (Reflected) {
+            crc = T(i);
+            for (int b = 0; b < 8; ++b) crc = (crc & 1) ? T((crc >> 1) ^ Poly) : T(crc >> 1);
+        } else {
+            crc = T(T(i) << (bits - 8));
+            for (int b = 0; b < 8; ++b) crc = (crc >> (bits - 1)) ? T((crc << 1) ^ Poly) : T(crc << 1);
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+quint16 FrameDecoder::crc16Ccitt(QByteArrayView data) {
+    static const auto table = makeCrcTable<quint16, 0x1021, false>();
+    quint16 crc = 0xFFFF;
+    for (char c : data) crc = quint16((crc << 8) ^ table[((crc >> 8) ^ uchar(c)) & 0xFF]);
+    return crc;
+}
+
+quint16 FrameDecoder::crc16Modbus(QByteArrayView data) {
+    static const auto table = makeCrcTable<quint16, 0xA001, true>();
+    quint16 crc = 0xFFFF;
+    for (char c : data) crc = quint16((crc >> 8) ^ table[(crc ^ uchar(c)) & 0xFF]);
+    return crc;
+}
+
+quint32 FrameDecoder::crc32(QByteArrayView data) {
+    static const auto table = makeCrcTable<quint32, 0xEDB88320u, true>();
+    quint32 crc = 0xFFFFFFFFu;
+    for (char c : data) crc = (crc >> 8) ^ table[(crc ^ uchar(c)) & 0xFF];
+    return crc ^ 0xFFFFFFFFu;
+}
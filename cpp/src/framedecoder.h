@@ -0,0 +1,280 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+
+#include <cstring>
+#include <variant>
+
+// Settings for splitting a binary stream into frames. Only the fields of the
+// selected kind are used.
+struct FrameOptions {
+    enum class Kind { None, Slip, Cobs, LengthPrefixed, FixedSize };
+    enum class Crc { None, Crc16Ccitt, Crc16Modbus, Crc32 };
+
+    Kind kind = Kind::None;
+    Crc crc = Crc::None;
+    int lengthBytes = 2;
+    bool bigEndian = false;
+    bool lengthIncludesHeader = false;
+    int fixedSize = 16;
+    int maxFrame = 65536;
+
+    QString describe() const;
+};
+
+namespace Framing {
+
+// Frames are handed to the sink as (view, valid). A view points into the
+// caller's read buffer whenever the frame lies entirely inside it; only a
+// frame that straddles two reads is assembled in a carry buffer. Views are
+// valid until the next feed().
+
+// Frames that end at a delimiter byte. Decode is applied in place, which is
+// safe because SLIP and COBS never decode to more bytes than they read.
+template <typename Codec>
+class DelimitedDecoder {
+public:
+    explicit DelimitedDecoder(int maxFrame) : m_maxFrame(maxFrame) {}
+
+    template <typename Sink>
+    void feed(char* data, qsizetype size, Sink&& sink) {
+        char* p = data;
+        char* end = data + size;
+        while (p < end) {
+            char* delim = static_cast<char*>(std::memchr(p, Codec::kDelimiter, std::size_t(end - p)));
+            if (!delim) {
+                carry(p, end - p);
+                return;
+            }
+            char* frame = p;
+            qsizetype length = delim - p;
+            if (!m_carry.isEmpty() || m_overrun) {
+                carry(p, length);
+                frame = m_carry.data();
+                length = m_carry.size();
+            }
+            if (m_overrun) {
+                sink(QByteArrayView(), false);
+            } else if (length > 0) {
+                const qsizetype decoded = Codec::decode(frame, length);
+                sink(QByteArrayView(frame, qMax<qsizetype>(0, decoded)), decoded >= 0);
+            }
+            m_carry.resize(0);
+            m_overrun = false;
+            p = delim + 1;
+        }
+    }
+
+    void reset() {
+        m_carry.clear();
+        m_overrun = false;
+    }
+
+private:
+    void carry(const char* p, qsizetype n) {
+        if (m_overrun) return;
+        if (m_carry.size() + n > m_maxFrame) {
+            m_carry.resize(0);
+            m_overrun = true;
+            return;
+        }
+        m_carry.append(p, n);
+    }
+
+    int m_maxFrame;
+    QByteArray m_carry;
+    bool m_overrun = false;
+};
+
+// RFC 1055: END terminates a frame, ESC END / ESC ESC stand for the data bytes.
+struct SlipCodec {
+    static const char kDelimiter = char(0xC0);
+
+    static qsizetype decode(char* p, qsizetype n) {
+        qsizetype w = 0;
+        for (qsizetype r = 0; r < n; ++r) {
+            char c = p[r];
+            if (c == char(0xDB)) {
+                if (++r == n) return -1;
+                if (p[r] == char(0xDC)) c = char(0xC0);
+                else if (p[r] == char(0xDD)) c = char(0xDB);
+                else return -1;
+            }
+            p[w++] = c;
+        }
+        return w;
+    }
+};
+
+// Consistent Overhead Byte Stuffing with 0x00 as the frame delimiter.
+struct CobsCodec {
+    static const char kDelimiter = 0;
+
+    static qsizetype decode(char* p, qsizetype n) {
+        qsizetype r = 0;
+        qsizetype w = 0;
+        while (r < n) {
+            const int code = uchar(p[r++]);
+            if (code == 0 || r + code - 1 > n) return -1;
+            std::memmove(p + w, p + r, std::size_t(code - 1));
+            w += code - 1;
+            r += code - 1;
+            if (code < 0xFF && r < n) p[w++] = 0;
+        }
+        return w;
+    }
+};
+
+using SlipDecoder = DelimitedDecoder<SlipCodec>;
+using CobsDecoder = DelimitedDecoder<CobsCodec>;
+
+// A 1, 2 or 4 byte length header followed by the payload. A length beyond
+// maxFrame is reported once as an invalid frame, then the decoder slides
+// forward a byte at a time until a plausible header turns up.
+class LengthPrefixedDecoder {
+public:
+    explicit LengthPrefixedDecoder(const FrameOptions& options)
+        : m_headerBytes(options.lengthBytes), m_bigEndian(options.bigEndian),
+          m_includesHeader(options.lengthIncludesHeader), m_maxFrame(options.maxFrame) {}
+
+    template <typename Sink>
+    void feed(char* data, qsizetype size, Sink&& sink) {
+        const char* p = data;
+        const char* end = data + size;
+        while (!m_carry.isEmpty()) {
+            if (m_carry.size() < m_headerBytes) {
+                const qsizetype take = qMin<qsizetype>(m_headerBytes - m_carry.size(), end - p);
+                m_carry.append(p, take);
+                p += take;
+                if (m_carry.size() < m_headerBytes) return;
+                if (!startFrame(m_carry.constData(), sink)) {
+                    m_carry.remove(0, 1);
+                    continue;
+                }
+            }
+            const qsizetype take = qMin<qsizetype>(m_headerBytes + m_payload - m_carry.size(), end - p);
+            m_carry.append(p, take);
+            p += take;
+            if (m_carry.size() < m_headerBytes + m_payload) return;
+            sink(QByteArrayView(m_carry).sliced(m_headerBytes), true);
+            m_carry.clear();
+        }
+        while (end - p >= m_headerBytes) {
+            if (!startFrame(p, sink)) {
+                ++p;
+                continue;
+            }
+            if (end - p < m_headerBytes + m_payload) break;
+            sink(QByteArrayView(p + m_headerBytes, m_payload), true);
+            p += m_headerBytes + m_payload;
+        }
+        if (p < end) m_carry.append(p, end - p);
+    }
+
+    void reset() {
+        m_carry.clear();
+        m_synced = true;
+    }
+
+private:
+    template <typename Sink>
+    bool startFrame(const char* header, Sink&& sink) {
+        quint32 length = 0;
+        for (int i = 0; i < m_headerBytes; ++i) {
+            length = (length << 8) | uchar(header[m_bigEndian ? i : m_headerBytes - 1 - i]);
+        }
+        const qint64 payload = qint64(length) - (m_includesHeader ? m_headerBytes : 0);
+        if (payload < 0 || payload > m_maxFrame) {
+            if (m_synced) sink(QByteArrayView(), false);
+            m_synced = false;
+            return false;
+        }
+        m_synced = true;
+        m_payload = qsizetype(payload);
+        return true;
+    }
+
+    int m_headerBytes;
+    bool m_bigEndian;
+    bool m_includesHeader;
+    int m_maxFrame;
+    qsizetype m_payload = 0;
+    bool m_synced = true;
+    QByteArray m_carry;
+};
+
+// Every frame is exactly `size` bytes.
+class FixedSizeDecoder {
+public:
+    explicit FixedSizeDecoder(int size) : m_size(qMax(1, size)) {}
+
+    template <typename Sink>
+    void feed(char* data, qsizetype size, Sink&& sink) {
+        const char* p = data;
+        const char* end = data + size;
+        if (!m_carry.isEmpty()) {
+            const qsizetype take = qMin<qsizetype>(m_size - m_carry.size(), end - p);
+            m_carry.append(p, take);
+            p += take;
+            if (m_carry.size() < m_size) return;
+            sink(QByteArrayView(m_carry), true);
+            m_carry.clear();
+        }
+        for (; end - p >= m_size; p += m_size) sink(QByteArrayView(p, m_size), true);
+        if (p < end) m_carry.append(p, end - p);
+    }
+
+    void reset() { m_carry.clear(); }
+
+private:
+    qsizetype m_size;
+    QByteArray m_carry;
+};
+
+} // namespace Framing
+
+// Runs the selected framing over a byte stream and checks each frame's
+// trailing CRC. The decoder type is chosen once; feed() dispatches per read,
+// and the per-byte loops are specialized for each framing at compile time.
+class FrameDecoder {
+public:
+    enum class Check { None, Ok, Bad };
+
+    struct Frame {
+        QByteArrayView data;
+        bool valid = true;
+        Check crc = Check::None;
+    };
+
+    explicit FrameDecoder(const FrameOptions& options);
+
+    const FrameOptions& options() const { return m_options; }
+
+    // `data` may be modified in place.
+    template <typename Sink>
+    void feed(char* data, qsizetype size, Sink&& sink) {
+        std::visit([&](auto& decoder) {
+            decoder.feed(data, size, [&](QByteArrayView frame, bool valid) {
+                sink(Frame{frame, valid, valid ? checkCrc(frame) : Check::None});
+            });
+        }, m_decoder);
+    }
+
+    void reset();
+
+    static quint16 crc16Ccitt(QByteArrayView data);
+    static quint16 crc16Modbus(QByteArrayView data);
+    static quint32 crc32(QByteArrayView data);
+
+private:
+    using Decoder = std::variant<Framing::SlipDecoder, Framing::CobsDecoder,
+                                 Framing::LengthPrefixedDecoder, Framing::FixedSizeDecoder>;
+
+    static Decoder makeDecoder(const FrameOptions& options);
+    Check checkCrc(QByteArrayView frame) const;
+
+    FrameOptions m_options;
+    Decoder m_decoder;
+};
@@ -0,0 +1,100 @@
+#include "framingdialog.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QPushButton>
+
+FramingDialog::FramingDialog(const FrameOptions& current, QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Framing");
+
+    m_kindCombo = new QComboBox(this);
+    m_kindCombo->addItem("None (text lines)", int(FrameOptions::Kind::None));
+    m_kindCombo->addItem("SLIP", int(FrameOptions::Kind::Slip));
+    m_kindCombo->addItem("COBS (0x00 delimited)", int(FrameOptions::Kind::Cobs));
+    m_kindCombo->addItem("Length prefixed", int(FrameOptions::Kind::LengthPrefixed));
+    m_kindCombo->addItem("Fixed size", int(FrameOptions::Kind::FixedSize));
+    m_kindCombo->setCurrentIndex(m_kindCombo->findData(int(current.kind)));
+
+    m_lengthBytesCombo = new QComboBox(this);
+    m_lengthBytesCombo->addItem("1 byte", 1);
+    m_lengthBytesCombo->addItem("2 bytes", 2);
+    m_lengthBytesCombo->addItem("4 bytes", 4);
+    m_lengthBytesCombo->setCurrentIndex(m_lengthBytesCombo->findData(current.lengthBytes));
+
+    m_byteOrderCombo = new QComboBox(this);
+    m_byteOrderCombo->addItem("Little endian", false);
+    m_byteOrderCombo->addItem("Big endian", true);
+    m_byteOrderCombo->setCurrentIndex(current.bigEndian ? 1 : 0);
+
+    m_includesHeaderCheck = new QCheckBox("Length counts the header", this);
+    m_includesHeaderCheck->setChecked(current.lengthIncludesHeader);
+
+    m_fixedSizeSpin = new QSpinBox(this);
+    m_fixedSizeSpin->setRange(1, 65536);
+    m_fixedSizeSpin->setSuffix(" B");
+    m_fixedSizeSpin->setValue(current.fixedSize);
+
+    m_maxFrameSpin = new QSpinBox(this);
+    m_maxFrameSpin->setRange(16, 16 * 1024 * 1024);
+    m_maxFrameSpin->setSuffix(" B");
+    m_maxFrameSpin->setValue(current.maxFrame);
+
+    m_crcCombo = new QComboBox(this);
+    m_crcCombo->addItem("None", int(FrameOptions::Crc::None));
+    m_crcCombo->addItem("CRC-16/CCITT (big endian)", int(FrameOptions::Crc::Crc16Ccitt));
+    m_crcCombo->addItem("CRC-16/Modbus (little endian)", int(FrameOptions::Crc::Crc16Modbus));
+    m_crcCombo->addItem("CRC-32 (little endian)", int(FrameOptions::Crc::Crc32));
+    m_crcCombo->setCurrentIndex(m_crcCombo->findData(int(current.crc)));
+
+    connect(m_kindCombo, &QComboBox::currentIndexChanged, this, &FramingDialog::updateEnabled);
+
+    auto form = new QFormLayout();
+    form->addRow("Framing:", m_kindCombo);
+    form->addRow("Length field:", m_lengthBytesCombo);
+    form->addRow("Byte order:", m_byteOrderCombo);
+    form->addRow(QString(), m_includesHeaderCheck);
+    form->addRow("Frame size:", m_fixedSizeSpin);
+    form->addRow("Max frame:", m_maxFrameSpin);
+    form->addRow("Trailing CRC:", m_crcCombo);
+
+    auto okBtn = new QPushButton("Set", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+
+    updateEnabled();
+}
+
+void FramingDialog::updateEnabled() {
+    const auto kind = FrameOptions::Kind(m_kindCombo->currentData().toInt());
+    const bool length = kind == FrameOptions::Kind::LengthPrefixed;
+    m_lengthBytesCombo->setEnabled(length);
+    m_byteOrderCombo->setEnabled(length);
+    m_includesHeaderCheck->setEnabled(length);
+    m_fixedSizeSpin->setEnabled(kind == FrameOptions::Kind::FixedSize);
+    m_maxFrameSpin->setEnabled(kind != FrameOptions::Kind::None && kind != FrameOptions::Kind::FixedSize);
+    m_crcCombo->setEnabled(kind != FrameOptions::Kind::None);
+}
+
+FrameOptions FramingDialog::selectedOptions() const {
+    FrameOptions options;
+    options.kind = FrameOptions::Kind(m_kindCombo->currentData().toInt());
+    options.crc = FrameOptions::Crc(m_crcCombo->currentData().toInt());
+    options.lengthBytes = m_lengthBytesCombo->currentData().toInt();
+    options.bigEndian = m_byteOrderCombo->currentData().toBool();
+    options.lengthIncludesHeader = m_includesHeaderCheck->isChecked();
+    options.fixedSize = m_fixedSizeSpin->value();
+    options.maxFrame = m_maxFrameSpin->value();
+    return options;
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QDialog>
+#include <QCheckBox>
+#include <QComboBox>
+#include <QSpinBox>
+
+#include "framedecoder.h"
+
+class FramingDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit FramingDialog(const FrameOptions& current, QWidget* parent = nullptr);
+
+    FrameOptions selectedOptions() const;
+
+private:
+    void updateEnabled();
+
+    QComboBox* m_kindCombo;
+    QComboBox* m_lengthBytesCombo;
+    QComboBox* m_byteOrderCombo;
+    QCheckBox* m_includesHeaderCheck;
+    QSpinBox* m_fixedSizeSpin;
+    QSpinBox* m_maxFrameSpin;
+    QComboBox* m_crcCombo;
+};
@@ -0,0 +1,226 @@
+#include "headlessdaemon.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include "compressedlog.h"
+#include "serialioservice.h"
+#include "serialreader.h"
+
+static bool parseTimestampMode(const QString& text, bool* enabled, TimestampFormatter::Mode* mode) {
+    *enabled = true;
+    if (text == "off") {
+        *enabled = false;
+    } else if (text == "absolute") {
+        *mode = TimestampFormatter::Mode::Absolute;
+    } else if (text == "micro") {
+        *mode = TimestampFormatter::Mode::AbsoluteMicro;
+    } else if (text == "relative") {
+        *mode = TimestampFormatter::Mode::Relative;
+    } else if (text == "delta") {
+        *mode = TimestampFormatter::Mode::Delta;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+static bool parseFlushPolicy(const QString& text, LogWriter::FlushPolicy* policy) {
+    if (text == "interval") {
+        *policy = LogWriter::FlushPolicy::Interval;
+    } else if (text == "size") {
+        *policy = LogWriter::FlushPolicy::Size;
+    } else if (text == "sync") {
+        *policy = LogWriter::FlushPolicy::SyncEachLine;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// The config is a JSON object: top-level "threads", "reconnectMs",
+// "timestamps" and "log" settings, and a "ports" array whose entries give
+// "port", "baud", "output" and optionally their own "timestamps".
+bool HeadlessDaemon::loadConfig(const QString& path, Config* config, QString* error) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        *error = file.errorString();
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument doc = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (!doc.isObject()) {
+        *error = parseError.error != QJsonParseError::NoError ? parseError.errorString()
+                                                               : QString("expected a JSON object");
+        return false;
+    }
+    const QJsonObject root = doc.object();
+
+    Config result;
+    result.threads = root.value("threads").toInt(0);
+    result.reconnectMs = root.value("reconnectMs").toInt(result.reconnectMs);
+
+    const QJsonObject log = root.value("log").toObject();
+    if (log.contains("flush") && !parseFlushPolicy(log.value("flush").toString(), &result.log.flush)) {
+        *error = QString("unknown flush policy \"%1\"").arg(log.value("flush").toString());
+        return false;
+    }
+    result.log.flushIntervalMs = log.value("flushIntervalMs").toInt(result.log.flushIntervalMs);
+    result.log.flushKb = log.value("flushKb").toInt(result.log.flushKb);
+    result.log.rotateBytes = qint64(log.value("rotateMb").toInt(0)) * 1024 * 1024;
+    result.log.rotateMinutes = log.value("rotateMinutes").toInt(0);
+
+    PortConfig defaults;
+    const QString defaultStamps = root.value("timestamps").toString("absolute");
+    if (!parseTimestampMode(defaultStamps, &defaults.timestamps, &defaults.timestampMode)) {
+        *error = QString("unknown timestamp mode \"%1\"").arg(defaultStamps);
+        return false;
+    }
+
+    const QJsonArray ports = root.value("ports").toArray();
+    for (const QJsonValue& value : ports) {
+        const QJsonObject entry = value.toObject();
+        PortConfig port = defaults;
+        port.port = entry.value("port").toString();
+        port.baud = entry.value("baud").toInt(port.baud);
+        port.output = entry.value("output").toString();
+        if (port.port.isEmpty() || port.output.isEmpty()) {
+            *error = "every port needs \"port\" and \"output\"";
+            return false;
+        }
+        if (entry.contains("timestamps")) {
+            const QString stamps = entry.value("timestamps").toString();
+            if (!parseTimestampMode(stamps, &port.timestamps, &port.timestampMode)) {
+                *error = QString("%1: unknown timestamp mode \"%2\"").arg(port.port, stamps);
+                return false;
+            }
+        }
+        result.ports.append(port);
+    }
+    if (result.ports.isEmpty()) {
+        *error = "no ports configured";
+        return false;
+    }
+
+    *config = result;
+    return true;
+}
+
+HeadlessDaemon::HeadlessDaemon(const Config& config, QObject* parent)
+    : QObject(parent), m_config(config) {}
+
+HeadlessDaemon::~HeadlessDaemon() {
+    stop();
+}
+
+bool HeadlessDaemon::start(QString* error) {
+    SerialIoService* io = SerialIoService::instance();
+    if (m_config.threads > 0) io->setMaxThreads(m_config.threads);
+
+    for (qsizetype i = 0; i < m_config.ports.size(); ++i) {
+        auto port = new Port;
+        port->config = m_config.ports[i];
+        m_ports.append(port);
+
+        LogWriter::Options options = m_config.log;
+        options.format = CompressedLog::isCompressedLogPath(port->config.output) ? LogWriter::Format::Compressed
+                                                                                 : LogWriter::Format::PlainText;
+        port->writer = std::make_shared<LogWriter>(port->config.output, options);
+        if (!port->writer->open(error)) {
+            *error = QString("%1: %2").arg(port->config.output, *error);
+            stop();
+            return false;
+        }
+
+        port->reader = new SerialReader(nullptr);
+        port->reader->setLogWriter(port->writer);
+        port->reader->setTimestampEnabled(port->config.timestamps);
+        port->reader->setTimestampMode(port->config.timestampMode);
+        port->thread = io->acquire();
+        port->reader->moveToThread(port->thread);
+        connect(port->reader, &SerialReader::opened, this,
+                [this, port](bool ok, const QString& message) { onOpened(port, ok, message); });
+        connect(port->reader, &SerialReader::portLost, this, [this, port]() { onLost(port); });
+
+        port->retryTimer = new QTimer(this);
+        port->retryTimer->setSingleShot(true);
+        port->retryTimer->setInterval(m_config.reconnectMs);
+        connect(port->retryTimer, &QTimer::timeout, this, [this, port]() { openPort(port); });
+
+        openPort(port);
+    }
+
+    m_logCheckTimer = new QTimer(this);
+    m_logCheckTimer->setInterval(1000);
+    connect(m_logCheckTimer, &QTimer::timeout, this, &HeadlessDaemon::checkLogs);
+    m_logCheckTimer->start();
+    return true;
+}
+
+void HeadlessDaemon::stop() {
+    delete m_logCheckTimer;
+    m_logCheckTimer = nullptr;
+    for (Port* port : m_ports) {
+        delete port->retryTimer;
+        if (SerialReader* reader = port->reader) {
+            QMetaObject::invokeMethod(reader, [reader]() {
+                reader->close();
+                reader->deleteLater();
+            }, Qt::BlockingQueuedConnection);
+            SerialIoService::instance()->release(port->thread);
+        }
+        if (port->writer) port->writer->close();
+    }
+    qDeleteAll(m_ports);
+    m_ports.clear();
+}
+
+void HeadlessDaemon::openPort(Port* port) {
+    SerialReader* reader = port->reader;
+    const QString name = port->config.port;
+    const int baud = port->config.baud;
+    QMetaObject::invokeMethod(reader, [reader, name, baud]() { reader->open(name, baud); });
+}
+
+// Signals queued before stop() can arrive after the port is gone.
+void HeadlessDaemon::onOpened(Port* port, bool ok, const QString& error) {
+    if (!m_ports.contains(port)) return;
+    if (ok) {
+        qInfo("%s: capturing at %d baud to %s", qPrintable(port->config.port), port->config.baud,
+              qPrintable(port->writer->currentPath()));
+        port->failing = false;
+        return;
+    }
+    // Only the first failure of a retry streak is reported.
+    if (!port->failing) {
+        qWarning("%s: %s; retrying every %d ms", qPrintable(port->config.port), qPrintable(error),
+                 m_config.reconnectMs);
+        port->failing = true;
+    }
+    port->retryTimer->start();
+}
+
+void HeadlessDaemon::onLost(Port* port) {
+    if (!m_ports.contains(port)) return;
+    qWarning("%s: port lost; retrying every %d ms", qPrintable(port->config.port), m_config.reconnectMs);
+    port->failing = true;
+    port->retryTimer->start();
+}
+
+// A writer keeps retrying on its own; this only reports when its error
+// changes, with the bytes lost so far.
+void HeadlessDaemon::checkLogs() {
+    for (Port* port : m_ports) {
+        const QString error = port->writer->errorString();
+        if (error == port->logError) continue;
+        if (error.isEmpty()) {
+            qInfo("%s: writing to %s again (%lld bytes lost)", qPrintable(port->config.port),
+                  qPrintable(port->writer->currentPath()), port->writer->droppedBytes());
+        } else {
+            qWarning("%s: %s", qPrintable(port->config.port), qPrintable(error));
+        }
+        port->logError = error;
+    }
+}
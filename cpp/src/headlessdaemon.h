@@ -0,0 +1,65 @@
+#pragma once
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QThread>
+#include <QTimer>
+
+#include <memory>
+
+#include "logwriter.h"
+#include "timestampformatter.h"
+
+class SerialReader;
+
+// Captures many ports to log files without a GUI. Each port gets the same
+// SerialReader/LogWriter pipeline a SerialTab uses, minus the ring to the
+// view. Readers share the SerialIoService threads, and a port that fails or
+// disappears is retried. Log file errors are reported as they start and end.
+class HeadlessDaemon : public QObject {
+    Q_OBJECT
+public:
+    struct PortConfig {
+        QString port;
+        int baud = 115200;
+        QString output;
+        bool timestamps = true;
+        TimestampFormatter::Mode timestampMode = TimestampFormatter::Mode::Absolute;
+    };
+
+    struct Config {
+        QList<PortConfig> ports;
+        LogWriter::Options log;
+        int threads = 0;
+        int reconnectMs = 2000;
+    };
+
+    static bool loadConfig(const QString& path, Config* config, QString* error);
+
+    explicit HeadlessDaemon(const Config& config, QObject* parent = nullptr);
+    ~HeadlessDaemon() override;
+
+    bool start(QString* error);
+    void stop();
+
+private:
+    struct Port {
+        PortConfig config;
+        SerialReader* reader = nullptr;
+        QThread* thread = nullptr;
+        std::shared_ptr<LogWriter> writer;
+        QTimer* retryTimer = nullptr;
+        bool failing = false;
+        QString logError;
+    };
+
+    void openPort(Port* port);
+    void onOpened(Port* port, bool ok, const QString& error);
+    void onLost(Port* port);
+    void checkLogs();
+
+    Config m_config;
+    QList<Port*> m_ports;
+    QTimer* m_logCheckTimer = nullptr;
+};
@@ -0,0 +1,113 @@
+#include "hexdumpsource.h"
+
+#include "linestore.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define HEXDUMP_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+// Each byte maps to "xx " so a row is expanded with one 4-byte copy per byte;
+// the fourth byte is overwritten by the next copy.
+static const std::array<std::array<char, 4>, 256> kHexTriples = []() {
+    static const char digits[] = "0123456789abcdef";
+    std::array<std::array<char, 4>, 256> table{};
+    for (int i = 0; i < 256; ++i) table[i] = {digits[i >> 4], digits[i & 15], ' ', ' '};
+    return table;
+}();
+
+static char* writeHex(char* out, const uchar* bytes, int count) {
+    for (int i = 0; i < count; ++i) {
+        std::memcpy(out, kHexTriples[bytes[i]].data(), 4);
+        out += 3;
+        if (i == 7) *out++ = ' ';
+    }
+    return out;
+}
+
+// Printable ASCII passes through, everything else becomes '.'.
+static void writeAscii(char* out, const uchar* bytes, int count) {
+#ifdef HEXDUMP_HAVE_SSE2
+    if (count == HexDumpSource::kBytesPerRow) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes));
+        // Signed compares: bytes >= 0x80 are negative and fail the first test.
+        const __m128i printable = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(0x1f)),
+                                                _mm_cmplt_epi8(v, _mm_set1_epi8(0x7f)));
+        const __m128i dots = _mm_set1_epi8('.');
+        const __m128i result = _mm_or_si128(_mm_and_si128(printable, v), _mm_andnot_si128(printable, dots));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), result);
+        return;
+    }
+#endif
+    for (int i = 0; i < count; ++i) out[i] = bytes[i] >= 0x20 && bytes[i] < 0x7f ? char(bytes[i]) : '.';
+}
+
+HexDumpSource::~HexDumpSource() {
+    LineStore::accountExternal(-m_accounted);
+}
+
+qsizetype HexDumpSource::append(QByteArrayView data) {
+    m_data.append(data.data(), data.size());
+    qsizetype droppedRows = 0;
+    if (m_data.size() > kMaxBytes) {
+        // Whole rows only, so row boundaries stay on multiples of 16.
+        const qint64 excess = m_data.size() - (kMaxBytes - kTrimBytes);
+        droppedRows = qsizetype((excess + kBytesPerRow - 1) / kBytesPerRow);
+        const qsizetype drop = droppedRows * kBytesPerRow;
+        m_data.remove(0, drop);
+        m_dropped += drop;
+    }
+    while (m_offsetDigits < 16 && (endOffset() >> (4 * m_offsetDigits)) != 0) m_offsetDigits += 4;
+    account();
+    return droppedRows;
+}
+
+void HexDumpSource::account() {
+    const qint64 held = m_data.capacity();
+    if (held == m_accounted) return;
+    LineStore::accountExternal(held - m_accounted);
+    m_accounted = held;
+}
+
+qsizetype HexDumpSource::lineCount() const {
+    return (m_data.size() + kBytesPerRow - 1) / kBytesPerRow;
+}
+
+qsizetype HexDumpSource::longestLine() const {
+    const qsizetype hex = kBytesPerRow * 3 + 1;
+    return m_offsetDigits + 2 + (m_showAscii ? hex + 2 + kBytesPerRow + 1 : hex - 1);
+}
+
+qsizetype HexDumpSource::columnForOffset(qint64 offset) const {
+    const int byte = int(offset % kBytesPerRow);
+    return m_offsetDigits + 2 + byte * 3 + (byte >= 8 ? 1 : 0);
+}
+
+QByteArrayView HexDumpSource::line(qsizetype index) const {
+    if (index < 0 || index >= lineCount()) return {};
+    const qint64 start = qint64(index) * kBytesPerRow;
+    const int count = int(qMin<qint64>(kBytesPerRow, m_data.size() - start));
+    const uchar* bytes = reinterpret_cast<const uchar*>(m_data.constData() + start);
+    const qint64 offset = m_dropped + start;
+
+    static const char digits[] = "0123456789abcdef";
+    char* out = m_row;
+    for (int shift = 4 * (m_offsetDigits - 1); shift >= 0; shift -= 4) *out++ = digits[(offset >> shift) & 15];
+    *out++ = ' ';
+    *out++ = ' ';
+    out = writeHex(out, bytes, count);
+    if (!m_showAscii) return QByteArrayView(m_row, out - m_row - 1);
+
+    // Pad a short last row so its ASCII column lines up with the others.
+    const char* asciiStart = m_row + m_offsetDigits + 2 + kBytesPerRow * 3 + 1;
+    while (out < asciiStart) *out++ = ' ';
+    *out++ = ' ';
+    *out++ = '|';
+    writeAscii(out, bytes, count);
+    out += count;
+    *out++ = '|';
+    return QByteArrayView(m_row, out - m_row);
+}
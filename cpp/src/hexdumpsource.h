@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+#include "linesource.h"
+
+// Presents raw received bytes as a hex dump, 16 bytes per row. Rows are
+// formatted on demand into a scratch buffer, so only the rows a view
+// actually paints are ever converted. Only the newest kMaxBytes are kept:
+// older rows are dropped from the front in kTrimBytes steps, and offsets
+// still count from the first byte ever received.
+class HexDumpSource : public LineSource {
+public:
+    static const int kBytesPerRow = 16;
+    static const qint64 kMaxBytes = 64 * 1024 * 1024;
+    static const qint64 kTrimBytes = 16 * 1024 * 1024;
+
+    HexDumpSource() = default;
+    ~HexDumpSource() override;
+    HexDumpSource(const HexDumpSource&) = delete;
+    HexDumpSource& operator=(const HexDumpSource&) = delete;
+
+    // Returns the number of rows dropped from the front to stay under
+    // kMaxBytes, usually 0.
+    qsizetype append(QByteArrayView data);
+
+    // Mixed mode adds an ASCII column after the hex bytes.
+    void setShowAscii(bool show) { m_showAscii = show; }
+    bool showAscii() const { return m_showAscii; }
+
+    // Offset of the first byte still held and one past the last received.
+    qint64 firstOffset() const { return m_dropped; }
+    qint64 endOffset() const { return m_dropped + m_data.size(); }
+    // The held bytes; bytes()[0] is at firstOffset().
+    QByteArrayView bytes() const { return m_data; }
+    // Heap bytes held, counted against the scrollback memory budget.
+    qint64 residentBytes() const { return m_accounted; }
+
+    // Text column at which the byte at `offset` is drawn in its row.
+    qsizetype columnForOffset(qint64 offset) const;
+
+    qsizetype lineCount() const override;
+    qsizetype completeLineCount() const override { return m_data.size() / kBytesPerRow; }
+    QByteArrayView line(qsizetype index) const override;
+    qsizetype longestLine() const override;
+
+private:
+    void account();
+
+    QByteArray m_data;
+    qint64 m_dropped = 0;
+    qint64 m_accounted = 0;
+    bool m_showAscii = true;
+    int m_offsetDigits = 8;
+    mutable char m_row[128];
+};
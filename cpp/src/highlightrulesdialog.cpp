@@ -0,0 +1,57 @@
+#include "highlightrulesdialog.h"
+
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QMessageBox>
+#include <QPushButton>
+
+HighlightRulesDialog::HighlightRulesDialog(const QList<LineHighlighter::Rule>& current, QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Highlight Rules");
+
+    QStringList lines;
+    for (const auto& rule : current) lines.append(rule.color.name() + ' ' + rule.pattern);
+
+    m_edit = new QPlainTextEdit(this);
+    m_edit->setPlainText(lines.join('\n'));
+    m_edit->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    auto okBtn = new QPushButton("Set", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel("One rule per line: a colour, a space, then the text to look for.\n"
+                                 "Lines containing the text are drawn in that colour; the first rule wins.\n"
+                                 "Start the text with ^ to match only at the start of a line, after any timestamp.",
+                                 this));
+    layout->addWidget(m_edit);
+    layout->addLayout(buttons);
+    resize(420, 300);
+}
+
+void HighlightRulesDialog::accept() {
+    QList<LineHighlighter::Rule> rules;
+    const QStringList lines = m_edit->toPlainText().split('\n');
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        const QString line = lines[i].trimmed();
+        if (line.isEmpty()) continue;
+        const qsizetype space = line.indexOf(' ');
+        const QColor color(space > 0 ? line.left(space) : line);
+        const QString pattern = space > 0 ? line.mid(space + 1).trimmed() : QString();
+        if (!color.isValid() || pattern.isEmpty()) {
+            QMessageBox::warning(this, "UART Log Viewer", QString("Line %1 is not \"<colour> <text>\".").arg(i + 1));
+            return;
+        }
+        rules.append({pattern, color});
+    }
+    m_rules = rules;
+    QDialog::accept();
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <QDialog>
+#include <QPlainTextEdit>
+
+#include "linehighlighter.h"
+
+class HighlightRulesDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit HighlightRulesDialog(const QList<LineHighlighter::Rule>& current, QWidget* parent = nullptr);
+
+    QList<LineHighlighter::Rule> selectedRules() const { return m_rules; }
+
+    void accept() override;
+
+private:
+    QPlainTextEdit* m_edit;
+    QList<LineHighlighter::Rule> m_rules;
+};
@@ -0,0 +1,169 @@
+#include "ingestkernel.h"
+
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define INGEST_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define INGEST_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static inline unsigned countTrailingZeros(std::uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+static std::size_t findSpecialScalar(const char* p, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        const char c = p[i];
+        if (c == '\n' || c == '\r' || c == '\0') return i;
+    }
+    return n;
+}
+
+#ifdef INGEST_HAVE_SSE2
+static std::size_t findSpecialSse2(const char* p, std::size_t n) {
+    const __m128i nl = _mm_set1_epi8('\n');
+    const __m128i cr = _mm_set1_epi8('\r');
+    const __m128i nul = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i hit = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, nl), _mm_cmpeq_epi8(v, cr)),
+                                         _mm_cmpeq_epi8(v, nul));
+        const std::uint32_t mask = std::uint32_t(_mm_movemask_epi8(hit));
+        if (mask) return i + countTrailingZeros(mask);
+    }
+    return i + findSpecialScalar(p + i, n - i);
+}
+#endif
+
+#ifdef INGEST_HAVE_AVX2
+__attribute__((target("avx2")))
+static std::size_t findSpecialAvx2(const char* p, std::size_t n) {
+    const __m256i nl = _mm256_set1_epi8('\n');
+    const __m256i cr = _mm256_set1_epi8('\r');
+    const __m256i nul = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 32 <= n; i += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        const __m256i hit = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v, nl), _mm256_cmpeq_epi8(v, cr)),
+                                            _mm256_cmpeq_epi8(v, nul));
+        const std::uint32_t mask = std::uint32_t(_mm256_movemask_epi8(hit));
+        if (mask) return i + countTrailingZeros(mask);
+    }
+    return i + findSpecialScalar(p + i, n - i);
+}
+#endif
+
+IngestKernel::Isa IngestKernel::bestIsa() {
+#ifdef INGEST_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) return Isa::Avx2;
+#endif
+#ifdef INGEST_HAVE_SSE2
+    return Isa::Sse2;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+IngestKernel::IngestKernel(Isa isa)
+    : m_isa(Isa::Scalar), m_findSpecial(findSpecialScalar) {
+#ifdef INGEST_HAVE_SSE2
+    if (isa == Isa::Sse2 || isa == Isa::Avx2) {
+        m_isa = Isa::Sse2;
+        m_findSpecial = findSpecialSse2;
+    }
+#endif
+#ifdef INGEST_HAVE_AVX2
+    if (isa == Isa::Avx2 && __builtin_cpu_supports("avx2")) {
+        m_isa = Isa::Avx2;
+        m_findSpecial = findSpecialAvx2;
+    }
+#endif
+    (void)isa;
+}
+
+void IngestKernel::reset() {
+    m_pendingCr = false;
+    m_carryLen = 0;
+}
+
+// Length of an incomplete UTF-8 sequence at the end of [begin, end), or 0.
+static std::size_t incompleteUtf8Tail(const char* begin, const char* end) {
+    std::size_t back = 0;
+    for (const char* p = end; p > begin && back < IngestKernel::kMaxCarry;) {
+        --p;
+        ++back;
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if ((c & 0xC0) == 0x80) continue;
+        std::size_t need = 1;
+        if ((c & 0xE0) == 0xC0) need = 2;
+        else if ((c & 0xF0) == 0xE0) need = 3;
+        else if ((c & 0xF8) == 0xF0) need = 4;
+        return back < need ? back : 0;
+    }
+    return 0;
+}
+
+std::size_t IngestKernel::process(const char* data, std::size_t size, char* out, std::vector<std::uint32_t>& lineEnds) {
+    char* o = out;
+    const std::size_t firstEnd = lineEnds.size();
+    if (m_carryLen) {
+        std::memcpy(o, m_carry, m_carryLen);
+        o += m_carryLen;
+        m_carryLen = 0;
+    }
+
+    // NULs are stripped before "\r\n" is folded, so any between the two
+    // still leave a single line break.
+    std::size_t i = 0;
+    if (m_pendingCr) {
+        while (i < size && data[i] == '\0') ++i;
+        if (i < size) {
+            if (data[i] == '\n') ++i;
+            m_pendingCr = false;
+        }
+    }
+
+    while (i < size) {
+        const std::size_t next = i + m_findSpecial(data + i, size - i);
+        std::memcpy(o, data + i, next - i);
+        o += next - i;
+        if (next == size) break;
+
+        const char c = data[next];
+        i = next + 1;
+        if (c == '\0') continue;
+
+        *o++ = '\n';
+        lineEnds.push_back(std::uint32_t(o - out));
+        if (c == '\r') {
+            while (i < size && data[i] == '\0') ++i;
+            if (i == size) m_pendingCr = true;
+            else if (data[i] == '\n') ++i;
+        }
+    }
+
+    const char* lineStart = lineEnds.size() > firstEnd ? out + lineEnds.back() : out;
+    const std::size_t tail = incompleteUtf8Tail(lineStart, o);
+    if (tail) {
+        o -= tail;
+        std::memcpy(m_carry, o, tail);
+        m_carryLen = tail;
+    }
+    return std::size_t(o - out);
+}
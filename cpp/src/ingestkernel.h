@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Streaming byte-level normalizer for serial input. In one pass it strips NULs,
+// folds "\r\n" and lone "\r" into "\n" and records where every line ends.
+// A trailing "\r" and an incomplete UTF-8 sequence are carried into the next
+// chunk so pairs and code points split across reads come out intact.
+class IngestKernel {
+public:
+    enum class Isa { Scalar, Sse2, Avx2 };
+    static const std::size_t kMaxCarry = 3;
+
+    explicit IngestKernel(Isa isa = bestIsa());
+
+    static Isa bestIsa();
+    Isa isa() const { return m_isa; }
+
+    // `out` must have room for size + kMaxCarry bytes. Offsets just past each
+    // '\n' written are appended to `lineEnds`. Returns the bytes written.
+    std::size_t process(const char* data, std::size_t size, char* out, std::vector<std::uint32_t>& lineEnds);
+    void reset();
+
+private:
+    using FindFn = std::size_t (*)(const char*, std::size_t);
+
+    Isa m_isa;
+    FindFn m_findSpecial;
+    bool m_pendingCr = false;
+    char m_carry[kMaxCarry] = {};
+    std::size_t m_carryLen = 0;
+};
@@ -0,0 +1,102 @@
+#include "linefilter.h"
+
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <vector>
+
+static const qsizetype kParallelLines = 65536;
+
+bool LineFilter::compile(const Spec& spec, QString* error) {
+    return m_include.compile(spec.include, spec.regex, spec.matchCase, error)
+        && m_exclude.compile(spec.exclude, spec.regex, spec.matchCase, error);
+}
+
+bool LineFilter::accepts(QByteArrayView line) const {
+    if (!m_include.isEmpty() && !m_include.matches(line)) return false;
+    return m_exclude.isEmpty() || !m_exclude.matches(line);
+}
+
+void FilteredLineSource::setFilter(const LineFilter& filter, Mode mode) {
+    m_filter = filter;
+    m_mode = mode;
+    rebuild();
+}
+
+void FilteredLineSource::rebuild() {
+    m_matched.clear();
+    m_checked = m_base->completeLineCount();
+
+    const int threads = qMax(1, QThread::idealThreadCount());
+    if (m_checked < kParallelLines || threads == 1) {
+        for (qsizetype i = 0; i < m_checked; ++i) {
+            if (m_filter.accepts(m_base->line(i))) m_matched.append(i);
+        }
+        return;
+    }
+
+    const qsizetype ranges = qsizetype(threads) * 4;
+    const qsizetype step = (m_checked + ranges - 1) / ranges;
+    std::vector<QVector<qsizetype>> parts(std::size_t(ranges));
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (qsizetype r = 0; r < ranges; ++r) {
+        const qsizetype begin = r * step;
+        const qsizetype end = qMin(m_checked, begin + step);
+        QVector<qsizetype>* out = &parts[std::size_t(r)];
+        pool.start([this, begin, end, out]() {
+            for (qsizetype i = begin; i < end; ++i) {
+                if (m_filter.accepts(m_base->line(i))) out->append(i);
+            }
+        });
+    }
+    pool.waitForDone();
+
+    qsizetype total = 0;
+    for (const auto& part : parts) total += part.size();
+    m_matched.reserve(total);
+    for (const auto& part : parts) m_matched.append(part);
+}
+
+void FilteredLineSource::update() {
+    const qsizetype complete = m_base->completeLineCount();
+    if (complete < m_checked) {
+        rebuild();
+        return;
+    }
+    for (; m_checked < complete; ++m_checked) {
+        if (m_filter.accepts(m_base->line(m_checked))) m_matched.append(m_checked);
+    }
+}
+
+qsizetype FilteredLineSource::lineCount() const {
+    return m_mode == Mode::Hide ? m_matched.size() : m_base->lineCount();
+}
+
+qsizetype FilteredLineSource::completeLineCount() const {
+    return m_mode == Mode::Hide ? m_matched.size() : m_base->completeLineCount();
+}
+
+QByteArrayView FilteredLineSource::line(qsizetype index) const {
+    return m_base->line(baseLine(index));
+}
+
+qsizetype FilteredLineSource::baseLine(qsizetype index) const {
+    if (m_mode == Mode::Dim) return index;
+    return index >= 0 && index < m_matched.size() ? m_matched.at(index) : -1;
+}
+
+// The last visible row at or before the base line for that time.
+qsizetype FilteredLineSource::lineForTime(qint64 ms) const {
+    const qsizetype line = m_base->lineForTime(ms);
+    if (line < 0 || m_mode == Mode::Dim) return line;
+    if (m_matched.isEmpty()) return -1;
+    const auto it = std::upper_bound(m_matched.cbegin(), m_matched.cend(), line);
+    return it == m_matched.cbegin() ? 0 : qsizetype(it - m_matched.cbegin()) - 1;
+}
+
+bool FilteredLineSource::isLineDimmed(qsizetype index) const {
+    if (m_mode == Mode::Hide || index >= m_checked) return false;
+    return !std::binary_search(m_matched.cbegin(), m_matched.cend(), index);
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <QStringList>
+#include <QVector>
+
+#include "linesource.h"
+#include "patternmatcher.h"
+
+// Include/exclude pattern sets: a line passes if it matches any include
+// pattern (or there are none) and no exclude pattern.
+class LineFilter {
+public:
+    struct Spec {
+        QStringList include;
+        QStringList exclude;
+        bool regex = false;
+        bool matchCase = false;
+    };
+
+    bool compile(const Spec& spec, QString* error);
+    bool isActive() const { return !m_include.isEmpty() || !m_exclude.isEmpty(); }
+    bool accepts(QByteArrayView line) const;
+
+private:
+    PatternMatcher m_include;
+    PatternMatcher m_exclude;
+};
+
+// A LineSource seen through a LineFilter. Accepted lines are kept as an index
+// into the base source, so nothing is copied: Hide shows only those lines,
+// Dim shows everything and dims the rest. New lines are indexed as they are
+// completed; a filter change re-indexes the scrollback on a thread pool,
+// which requires the base source to allow concurrent const reads (LineStore
+// does).
+class FilteredLineSource : public LineSource {
+public:
+    enum class Mode { Hide, Dim };
+
+    explicit FilteredLineSource(const LineSource* base) : m_base(base) {}
+
+    void setFilter(const LineFilter& filter, Mode mode);
+    void update();
+
+    qsizetype lineCount() const override;
+    qsizetype completeLineCount() const override;
+    QByteArrayView line(qsizetype index) const override;
+    qsizetype longestLine() const override { return m_base->longestLine(); }
+    bool isLineDimmed(qsizetype index) const override;
+    QVector<StyleRun> styleRuns(qsizetype index) const override { return m_base->styleRuns(baseLine(index)); }
+    QString lineNote(qsizetype index) const override { return m_base->lineNote(baseLine(index)); }
+    bool hasTimeIndex() const override { return m_base->hasTimeIndex(); }
+    qsizetype lineForTime(qint64 ms) const override;
+    qint64 firstTime() const override { return m_base->firstTime(); }
+    qint64 lastTime() const override { return m_base->lastTime(); }
+
+    qsizetype matchedCount() const { return m_matched.size(); }
+    qsizetype checkedCount() const { return m_checked; }
+    qsizetype baseLine(qsizetype index) const;
+
+private:
+    void rebuild();
+
+    const LineSource* m_base;
+    LineFilter m_filter;
+    Mode m_mode = Mode::Hide;
+    QVector<qsizetype> m_matched;
+    qsizetype m_checked = 0;
+};
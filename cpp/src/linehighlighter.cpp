@@ -0,0 +1,73 @@
+#include "linehighlighter.h"
+
+QList<LineHighlighter::Rule> LineHighlighter::defaultRules() {
+    const QColor error("#f14c4c");
+    const QColor warning("#e5a50a");
+    return {
+        {"^E/", error},
+        {"[ERROR]", error},
+        {"[E]", error},
+        {"^W/", warning},
+        {"[WARN]", warning},
+        {"[WARNING]", warning},
+        {"[W]", warning},
+    };
+}
+
+bool LineHighlighter::setRules(const QList<Rule>& rules, QString* error) {
+    QList<QColor> colors;
+    QList<QStringList> patterns;
+    QList<QList<QByteArray>> anchored;
+    for (const Rule& rule : rules) {
+        if (rule.pattern.isEmpty() || !rule.color.isValid()) continue;
+        qsizetype index = colors.indexOf(rule.color);
+        if (index < 0) {
+            index = colors.size();
+            colors.append(rule.color);
+            patterns.append(QStringList());
+            anchored.append(QList<QByteArray>());
+        }
+        if (rule.pattern.size() > 1 && rule.pattern.startsWith('^')) {
+            anchored[index].append(rule.pattern.mid(1).toUtf8());
+        } else {
+            patterns[index].append(rule.pattern);
+        }
+    }
+
+    QVector<Group> groups(colors.size());
+    for (qsizetype i = 0; i < colors.size(); ++i) {
+        groups[i].color = colors[i];
+        groups[i].anchored = anchored[i];
+        if (!groups[i].matcher.compile(patterns[i], false, true, error)) return false;
+    }
+    m_rules = rules;
+    m_groups = groups;
+    return true;
+}
+
+// A leading "[...]" timestamp and the spaces after it are skipped.
+bool LineHighlighter::startsWithAny(QByteArrayView line, const QList<QByteArray>& prefixes) {
+    if (prefixes.isEmpty()) return false;
+    if (line.startsWith('[')) {
+        const qsizetype close = line.indexOf(']');
+        if (close > 0) {
+            qsizetype start = close + 1;
+            while (start < line.size() && line[start] == ' ') ++start;
+            const QByteArrayView rest = line.mid(start);
+            for (const QByteArray& prefix : prefixes) {
+                if (rest.startsWith(prefix)) return true;
+            }
+        }
+    }
+    for (const QByteArray& prefix : prefixes) {
+        if (line.startsWith(prefix)) return true;
+    }
+    return false;
+}
+
+QColor LineHighlighter::colorFor(QByteArrayView line) const {
+    for (const Group& group : m_groups) {
+        if (startsWithAny(line, group.anchored) || group.matcher.matches(line)) return group.color;
+    }
+    return QColor();
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QColor>
+#include <QList>
+#include <QVector>
+
+#include "patternmatcher.h"
+
+// Colours whole lines that contain a marker such as "E/" or "[ERROR]".
+// Rules are literal, case-sensitive substrings compiled once into one
+// PatternMatcher per colour, so a painted row costs an automaton pass per
+// colour. A rule starting with '^' only matches at the start of the line,
+// after a bracketed timestamp if there is one, so "^E/" finds logcat lines
+// without matching paths and URLs. The first rule's colour wins when
+// several match.
+class LineHighlighter {
+public:
+    struct Rule {
+        QString pattern;
+        QColor color;
+    };
+
+    static QList<Rule> defaultRules();
+
+    bool setRules(const QList<Rule>& rules, QString* error);
+    const QList<Rule>& rules() const { return m_rules; }
+    QColor colorFor(QByteArrayView line) const;
+
+private:
+    struct Group {
+        QColor color;
+        PatternMatcher matcher;
+        QList<QByteArray> anchored;
+    };
+
+    static bool startsWithAny(QByteArrayView line, const QList<QByteArray>& prefixes);
+
+    QList<Rule> m_rules;
+    QVector<Group> m_groups;
+};
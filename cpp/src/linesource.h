@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QString>
+#include <QVector>
+
+#include "ansiparser.h"
+
+// Read-only, line-indexed text that LogView can render. Views returned by
+// line() stay valid until the next call on the same source.
+class LineSource {
+public:
+    virtual ~LineSource() = default;
+
+    virtual qsizetype lineCount() const = 0;
+    virtual QByteArrayView line(qsizetype index) const = 0;
+    virtual qsizetype longestLine() const = 0;
+
+    // Lines that can no longer change. Live sources leave their last line
+    // open until it is terminated.
+    virtual qsizetype completeLineCount() const { return lineCount(); }
+
+    // Lines a filtered view keeps visible but de-emphasised.
+    virtual bool isLineDimmed(qsizetype) const { return false; }
+
+    // Style runs of a line, with byte offsets into line(); empty when the
+    // line is plain.
+    virtual QVector<StyleRun> styleRuns(qsizetype) const { return {}; }
+
+    // Drawn after the line without being part of its text, such as a
+    // repeat count.
+    virtual QString lineNote(qsizetype) const { return {}; }
+
+    // Sources that know when their lines arrived can map a wall-clock time
+    // (ms since epoch) to the first line at or before it.
+    virtual bool hasTimeIndex() const { return false; }
+    virtual qsizetype lineForTime(qint64) const { return -1; }
+    virtual qint64 firstTime() const { return 0; }
+    virtual qint64 lastTime() const { return 0; }
+
+    QString lineText(qsizetype index) const { return QString::fromUtf8(line(index)); }
+};
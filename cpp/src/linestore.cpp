@@ -0,0 +1,371 @@
+#include "linestore.h"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+// Chunks are sealed at the first line break past this size, so a chunk only
+// grows beyond it to hold one very long line.
+static const qsizetype kChunkBytes = 1024 * 1024;
+static const qsizetype kBlockTimes = 64 * 1024;
+
+static qint64 s_budget = qint64(512) * 1024 * 1024;
+static qint64 s_resident = 0;
+static std::vector<LineStore*> s_stores;
+
+const quint32* LineStore::Chunk::startData() const {
+    return isSpilled() ? reinterpret_cast<const quint32*>(spilled + SpillFile::aligned(spilledText))
+                       : starts.constData();
+}
+
+const StyleRun* LineStore::Chunk::runData() const {
+    if (!isSpilled()) return runs.constData();
+    const qint64 offset = SpillFile::aligned(spilledText) + SpillFile::aligned(spilledLines * qint64(sizeof(quint32)));
+    return reinterpret_cast<const StyleRun*>(spilled + offset);
+}
+
+LineStore::LineStore() {
+    s_stores.push_back(this);
+    m_chunks.push_back(newChunk(0, TextStyle()));
+}
+
+LineStore::~LineStore() {
+    s_resident -= m_resident;
+    s_stores.erase(std::find(s_stores.begin(), s_stores.end(), this));
+}
+
+void LineStore::setMemoryBudget(qint64 bytes) {
+    s_budget = qMax<qint64>(0, bytes);
+    enforceBudget();
+}
+
+qint64 LineStore::memoryBudget() {
+    return s_budget;
+}
+
+void LineStore::accountExternal(qint64 delta) {
+    s_resident += delta;
+    if (delta > 0) enforceBudget();
+}
+
+LineStore::Chunk LineStore::newChunk(qsizetype firstLine, const TextStyle& startStyle) {
+    Chunk chunk;
+    chunk.firstLine = firstLine;
+    chunk.startStyle = startStyle;
+    chunk.text.reserve(kChunkBytes);
+    chunk.starts.append(0);
+    chunk.accounted = chunk.text.capacity();
+    adjustResident(chunk.accounted);
+    return chunk;
+}
+
+void LineStore::append(QByteArrayView text) {
+    if (text.isEmpty()) return;
+
+    if (m_ansi.isIdle() && !std::memchr(text.data(), '\x1b', std::size_t(text.size()))) {
+        appendLines(text.data(), text.data() + text.size());
+        return;
+    }
+
+    m_stripped.resize(0);
+    m_pendingRuns.resize(0);
+    m_ansi.feed(text, &m_stripped, &m_pendingRuns);
+    appendLines(m_stripped.constData(), m_stripped.constData() + m_stripped.size());
+}
+
+// Newlines are not stored, so run offsets from the stripped batch shift back
+// by one for every '\n' before them.
+void LineStore::appendLines(const char* p, const char* end) {
+    const char* base = p;
+    qsizetype nextRun = 0;
+    while (p < end) {
+        if (m_chunks.back().text.size() >= kChunkBytes && m_chunks.back().starts.last() > 0) sealChunk();
+        Chunk& chunk = m_chunks.back();
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', end - p));
+        const char* segEnd = nl ? nl : end;
+        for (; nextRun < m_pendingRuns.size() && m_pendingRuns[nextRun].offset <= segEnd - base; ++nextRun) {
+            addRun(chunk.text.size() + (m_pendingRuns[nextRun].offset - (p - base)), m_pendingRuns[nextRun].style);
+        }
+        chunk.text.append(p, segEnd - p);
+        m_byteTotal += segEnd - p;
+        const qsizetype open = chunk.text.size() - chunk.starts.last();
+        if (open > m_longest) m_longest = open;
+        if (!nl) break;
+        chunk.starts.append(quint32(chunk.text.size()));
+        ++m_lineTotal;
+        p = nl + 1;
+    }
+    for (; nextRun < m_pendingRuns.size(); ++nextRun) {
+        addRun(m_chunks.back().text.size(), m_pendingRuns[nextRun].style);
+    }
+    m_pendingRuns.resize(0);
+}
+
+void LineStore::addRun(qsizetype pos, const TextStyle& style) {
+    QVector<StyleRun>& runs = m_chunks.back().runs;
+    if (!runs.isEmpty() && runs.last().offset == pos) {
+        runs.last().style = style;
+    } else {
+        runs.append({pos, style});
+    }
+}
+
+// Closes the last chunk and moves its open line, with the runs that fall in
+// it, to a fresh one.
+void LineStore::sealChunk() {
+    Chunk& full = m_chunks.back();
+    const qsizetype openStart = full.starts.last();
+    const auto split = std::lower_bound(full.runs.cbegin(), full.runs.cend(), openStart,
+                                        [](const StyleRun& run, qsizetype pos) { return run.offset < pos; });
+    const TextStyle style = split == full.runs.cbegin() ? full.startStyle : (split - 1)->style;
+
+    Chunk next = newChunk(full.firstLine + full.starts.size() - 1, style);
+    next.text.append(full.text.constData() + openStart, full.text.size() - openStart);
+    for (auto it = split; it != full.runs.cend(); ++it) next.runs.append({it->offset - openStart, it->style});
+
+    full.runs.resize(split - full.runs.cbegin());
+    full.text.resize(openStart);
+    full.starts.removeLast();
+    const qint64 bytes = full.text.capacity() + full.starts.capacity() * qint64(sizeof(quint32))
+                         + full.runs.capacity() * qint64(sizeof(StyleRun));
+    adjustResident(bytes - full.accounted);
+    full.accounted = bytes;
+    m_spillable += bytes;
+
+    m_chunks.push_back(std::move(next));
+    enforceBudget();
+}
+
+// Not cached: filters read lines from several threads at once.
+const LineStore::Chunk& LineStore::chunkFor(qsizetype line) const {
+    const auto it = std::upper_bound(m_chunks.cbegin(), m_chunks.cend(), line,
+                                     [](qsizetype l, const Chunk& chunk) { return l < chunk.firstLine; });
+    return *(it - 1);
+}
+
+void LineStore::appendTimes(const qint64* times, qsizetype count) {
+    qint64 last = m_timeCount > 0 ? lineTime(m_timeCount - 1) : std::numeric_limits<qint64>::min();
+    for (qsizetype i = 0; i < count; ++i) {
+        last = qMax(last, times[i]);
+        appendTime(last);
+    }
+}
+
+void LineStore::appendTime(qint64 ns) {
+    if (m_timeCount % kBlockTimes == 0) {
+        TimeBlock block;
+        block.times.reserve(kBlockTimes);
+        block.first = ns;
+        adjustResident(kBlockTimes * qint64(sizeof(qint64)));
+        m_timeBlocks.push_back(std::move(block));
+    }
+    m_timeBlocks.back().times.append(ns);
+    ++m_timeCount;
+    if (m_timeCount % kBlockTimes == 0) {
+        m_spillable += kBlockTimes * qint64(sizeof(qint64));
+        enforceBudget();
+    }
+}
+
+qint64 LineStore::lineTime(qsizetype line) const {
+    return m_timeBlocks[std::size_t(line / kBlockTimes)].data()[line % kBlockTimes];
+}
+
+template <typename InPrefix>
+qsizetype LineStore::partitionTimes(qsizetype from, qsizetype to, InPrefix inPrefix) const {
+    while (from < to) {
+        const qsizetype mid = from + (to - from) / 2;
+        if (inPrefix(lineTime(mid))) {
+            from = mid + 1;
+        } else {
+            to = mid;
+        }
+    }
+    return from;
+}
+
+qsizetype LineStore::upperBoundTime(qint64 ns, qsizetype from, qsizetype to) const {
+    return partitionTimes(from, to, [ns](qint64 t) { return t <= ns; });
+}
+
+qsizetype LineStore::lowerBoundTime(qint64 ns, qsizetype from, qsizetype to) const {
+    return partitionTimes(from, to, [ns](qint64 t) { return t < ns; });
+}
+
+// The last line that started at or before `ms`, or the first line when they
+// all started later. Blocks past the text (times that ran ahead) are ignored.
+qsizetype LineStore::lineForTime(qint64 ms) const {
+    const qsizetype count = qMin(m_timeCount, lineCount());
+    if (count == 0) return -1;
+    const qint64 ns = ms * 1000000;
+
+    const auto blocksEnd = m_timeBlocks.cbegin() + (count + kBlockTimes - 1) / kBlockTimes;
+    const auto block = std::upper_bound(m_timeBlocks.cbegin(), blocksEnd, ns,
+                                        [](qint64 t, const TimeBlock& b) { return t < b.first; });
+    if (block == m_timeBlocks.cbegin()) return 0;
+    const qsizetype from = (block - m_timeBlocks.cbegin() - 1) * kBlockTimes;
+    const qsizetype to = qMin(count, from + kBlockTimes);
+    return upperBoundTime(ns, from, to) - 1;
+}
+
+qint64 LineStore::firstTime() const {
+    return hasTimeIndex() ? m_timeBlocks.front().first / 1000000 : 0;
+}
+
+qint64 LineStore::openLineTime() const {
+    const qsizetype open = completeLineCount();
+    if (lineCount() == open || m_timeCount <= open) return -1;
+    return lineTime(open);
+}
+
+qint64 LineStore::lastTime() const {
+    const qsizetype count = qMin(m_timeCount, lineCount());
+    return count > 0 ? lineTime(count - 1) / 1000000 : 0;
+}
+
+qsizetype LineStore::lineCount() const {
+    // A trailing empty open line is just the position after the last '\n'.
+    const Chunk& last = m_chunks.back();
+    return last.starts.last() == last.text.size() ? m_lineTotal - 1 : m_lineTotal;
+}
+
+QByteArrayView LineStore::line(qsizetype index) const {
+    if (index < 0 || index >= m_lineTotal) return {};
+    const Chunk& chunk = chunkFor(index);
+    const qsizetype local = index - chunk.firstLine;
+    const quint32* starts = chunk.startData();
+    const qsizetype start = starts[local];
+    const qsizetype end = local + 1 < chunk.lineCount() ? starts[local + 1] : chunk.textSize();
+    return QByteArrayView(chunk.textData() + start, end - start);
+}
+
+QVector<StyleRun> LineStore::styleRuns(qsizetype index) const {
+    QVector<StyleRun> runs;
+    if (index < 0 || index >= m_lineTotal) return runs;
+    const Chunk& chunk = chunkFor(index);
+    const StyleRun* first = chunk.runData();
+    const StyleRun* last = first + chunk.runCount();
+    if (first == last && chunk.startStyle.isPlain()) return runs;
+
+    const qsizetype local = index - chunk.firstLine;
+    const quint32* starts = chunk.startData();
+    const qsizetype start = starts[local];
+    const qsizetype end = local + 1 < chunk.lineCount() ? starts[local + 1] : chunk.textSize();
+
+    const StyleRun* it = std::upper_bound(first, last, start,
+                                          [](qsizetype pos, const StyleRun& run) { return pos < run.offset; });
+    const TextStyle current = it != first ? (it - 1)->style : chunk.startStyle;
+    if (!current.isPlain()) runs.append({0, current});
+    for (; it != last && it->offset < end; ++it) runs.append({it->offset - start, it->style});
+    if (runs.size() == 1 && runs.first().style.isPlain()) runs.clear();
+    return runs;
+}
+
+// Updates nearly always name the newest repeated line, so the list stays
+// sorted by appending.
+void LineStore::setRepeats(qsizetype line, quint64 repeats, qint64 lastNs) {
+    if (line < 0 || line >= completeLineCount()) return;
+    if (m_repeats.isEmpty() || m_repeats.last().line < line) {
+        m_repeats.append({line, repeats, lastNs});
+        return;
+    }
+    const auto it = std::lower_bound(m_repeats.begin(), m_repeats.end(), line,
+                                     [](const Repeat& r, qsizetype l) { return r.line < l; });
+    if (it->line == line) {
+        it->repeats = repeats;
+        it->lastNs = lastNs;
+    } else {
+        m_repeats.insert(it, {line, repeats, lastNs});
+    }
+}
+
+const LineStore::Repeat* LineStore::findRepeat(qsizetype line) const {
+    const auto it = std::lower_bound(m_repeats.cbegin(), m_repeats.cend(), line,
+                                     [](const Repeat& r, qsizetype l) { return r.line < l; });
+    return it != m_repeats.cend() && it->line == line ? &*it : nullptr;
+}
+
+QString LineStore::lineNote(qsizetype index) const {
+    const Repeat* repeat = findRepeat(index);
+    if (!repeat) return {};
+    auto time = [this](qint64 ns) {
+        return QDateTime::fromMSecsSinceEpoch(ns / 1000000, m_timeZone).toString("HH:mm:ss.zzz");
+    };
+    QString note = QString("×%1").arg(repeat->repeats + 1);
+    if (index < timedLineCount()) note += QString("  %1 – %2").arg(time(lineTime(index)), time(repeat->lastNs));
+    return note;
+}
+
+qint64 LineStore::residentBytes() const {
+    return m_resident;
+}
+
+void LineStore::adjustResident(qint64 delta) {
+    m_resident += delta;
+    s_resident += delta;
+}
+
+qint64 LineStore::spillableBytes() const {
+    return m_spillError.isEmpty() ? m_spillable : 0;
+}
+
+// Moves the oldest sealed chunk, or failing that the oldest full time block,
+// into the spill file. Text goes first: it is most of the bytes, and a time
+// lookup touches only a few entries of a block.
+bool LineStore::spillOldest() {
+    if (!m_spill) m_spill = std::make_unique<SpillFile>();
+
+    if (m_spilledChunks + 1 < qsizetype(m_chunks.size())) {
+        Chunk& chunk = m_chunks[std::size_t(m_spilledChunks)];
+        const char* data = m_spill->append({{chunk.text.constData(), chunk.text.size()},
+                                            {chunk.starts.constData(), chunk.starts.size() * qsizetype(sizeof(quint32))},
+                                            {chunk.runs.constData(), chunk.runs.size() * qsizetype(sizeof(StyleRun))}},
+                                           &m_spillError);
+        if (!data) return false;
+        chunk.spilledText = chunk.text.size();
+        chunk.spilledLines = chunk.starts.size();
+        chunk.spilledRuns = chunk.runs.size();
+        chunk.spilled = data;
+        chunk.text = QByteArray();
+        chunk.starts = QVector<quint32>();
+        chunk.runs = QVector<StyleRun>();
+        adjustResident(-chunk.accounted);
+        m_spillable -= chunk.accounted;
+        ++m_spilledChunks;
+        return true;
+    }
+
+    if (m_spilledBlocks < m_timeCount / kBlockTimes) {
+        TimeBlock& block = m_timeBlocks[std::size_t(m_spilledBlocks)];
+        const qint64 bytes = kBlockTimes * qint64(sizeof(qint64));
+        const char* data = m_spill->append({{block.times.constData(), bytes}}, &m_spillError);
+        if (!data) return false;
+        block.spilled = reinterpret_cast<const qint64*>(data);
+        block.times = QVector<qint64>();
+        adjustResident(-bytes);
+        m_spillable -= bytes;
+        ++m_spilledBlocks;
+        return true;
+    }
+    return false;
+}
+
+// Spills from whichever store has the most to give until all of them fit.
+// A store whose spill file failed stops offering anything.
+void LineStore::enforceBudget() {
+    if (s_budget <= 0) return;
+    while (s_resident > s_budget) {
+        LineStore* victim = nullptr;
+        qint64 most = 0;
+        for (LineStore* store : s_stores) {
+            const qint64 bytes = store->spillableBytes();
+            if (bytes > most) {
+                most = bytes;
+                victim = store;
+            }
+        }
+        if (!victim || !victim->spillOldest()) return;
+    }
+}
@@ -0,0 +1,153 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QTimeZone>
+#include <QVector>
+
+#include <memory>
+
+#include "ansiparser.h"
+#include "linesource.h"
+#include "spillfile.h"
+
+// Append-only scrollback kept as raw UTF-8. Text lives in arena chunks of
+// about 1 MB, each with a packed table of 32-bit line offsets and its own
+// style runs; a line never straddles chunks. The last line stays open until
+// a '\n' arrives, so partial reads render live. ANSI escapes are stripped
+// on append; SGR state changes are kept as (offset, style) runs.
+// Live tabs also feed each line's arrival time, stored in fixed blocks whose
+// first times double as a sparse index; times can run ahead of the text
+// they belong to. Once every store together holds more than the memory
+// budget, the oldest sealed chunks and time blocks are moved into a
+// SpillFile and read back through its mapping. Writes are GUI thread only;
+// const reads may run concurrently.
+class LineStore : public LineSource {
+public:
+    LineStore();
+    ~LineStore() override;
+    LineStore(const LineStore&) = delete;
+    LineStore& operator=(const LineStore&) = delete;
+
+    void append(QByteArrayView text);
+
+    qsizetype lineCount() const override;
+    qsizetype completeLineCount() const override { return m_lineTotal - 1; }
+    QByteArrayView line(qsizetype index) const override;
+    qsizetype longestLine() const override { return m_longest; }
+    QVector<StyleRun> styleRuns(qsizetype index) const override;
+    // "×N  first – last" for a line that was repeated.
+    QString lineNote(qsizetype index) const override;
+
+    qsizetype byteSize() const { return m_byteTotal; }
+
+    // Wall-clock start times (ns) of lines in order, kept non-decreasing.
+    void appendTimes(const qint64* times, qsizetype count);
+    qsizetype timedLineCount() const { return qMin(m_timeCount, completeLineCount()); }
+    // Start time of the line still waiting for its '\n', or -1 when there is
+    // none or its time has not arrived yet.
+    qint64 openLineTime() const;
+    qint64 lineTime(qsizetype line) const;
+    // First line in [from, to) that started after `ns` (upper) or at or
+    // after it (lower); `to` when there is none.
+    qsizetype upperBoundTime(qint64 ns, qsizetype from, qsizetype to) const;
+    qsizetype lowerBoundTime(qint64 ns, qsizetype from, qsizetype to) const;
+
+    bool hasTimeIndex() const override { return timedLineCount() > 0; }
+    qsizetype lineForTime(qint64 ms) const override;
+    qint64 firstTime() const override;
+    qint64 lastTime() const override;
+
+    // Sets how many times `line` was repeated after it, the last at `lastNs`
+    // (wall clock). Repeats are counted before they reach the store, so a
+    // flood of them costs one line.
+    void setRepeats(qsizetype line, quint64 repeats, qint64 lastNs);
+    void setTimeZone(const QTimeZone& tz) { m_timeZone = tz; }
+
+    // Heap bytes held by this store, and bytes it has moved to disk.
+    qint64 residentBytes() const;
+    qint64 spilledBytes() const { return m_spill ? m_spill->bytes() : 0; }
+    QString spillError() const { return m_spillError; }
+
+    // Shared by every store; 0 keeps everything in memory.
+    static void setMemoryBudget(qint64 bytes);
+    static qint64 memoryBudget();
+    // Memory held outside any store, such as the hex dump copies, that
+    // counts against the budget; scrollback is spilled to make room for it.
+    static void accountExternal(qint64 delta);
+
+private:
+    struct Chunk {
+        qsizetype firstLine = 0;
+        TextStyle startStyle;
+        qint64 accounted = 0;
+        // Resident chunks own their data; spilled ones point into m_spill.
+        QByteArray text;
+        QVector<quint32> starts;
+        QVector<StyleRun> runs;
+        const char* spilled = nullptr;
+        qsizetype spilledText = 0;
+        qsizetype spilledLines = 0;
+        qsizetype spilledRuns = 0;
+
+        bool isSpilled() const { return spilled != nullptr; }
+        qsizetype textSize() const { return isSpilled() ? spilledText : text.size(); }
+        const char* textData() const { return isSpilled() ? spilled : text.constData(); }
+        qsizetype lineCount() const { return isSpilled() ? spilledLines : starts.size(); }
+        const quint32* startData() const;
+        qsizetype runCount() const { return isSpilled() ? spilledRuns : runs.size(); }
+        const StyleRun* runData() const;
+    };
+
+    struct Repeat {
+        qsizetype line;
+        quint64 repeats;
+        qint64 lastNs;
+    };
+
+    struct TimeBlock {
+        QVector<qint64> times;
+        const qint64* spilled = nullptr;
+        qint64 first = 0;
+
+        const qint64* data() const { return spilled ? spilled : times.constData(); }
+    };
+
+    void appendLines(const char* p, const char* end);
+    void addRun(qsizetype pos, const TextStyle& style);
+    Chunk newChunk(qsizetype firstLine, const TextStyle& startStyle);
+    void sealChunk();
+    const Chunk& chunkFor(qsizetype line) const;
+    const Repeat* findRepeat(qsizetype line) const;
+    void appendTime(qint64 ns);
+    template <typename InPrefix>
+    qsizetype partitionTimes(qsizetype from, qsizetype to, InPrefix inPrefix) const;
+
+    void adjustResident(qint64 delta);
+    bool spillOldest();
+    qint64 spillableBytes() const;
+    static void enforceBudget();
+
+    std::vector<Chunk> m_chunks;
+    qsizetype m_lineTotal = 1;
+    qsizetype m_byteTotal = 0;
+    qsizetype m_longest = 0;
+
+    AnsiParser m_ansi;
+    QByteArray m_stripped;
+    QVector<StyleRun> m_pendingRuns;
+
+    std::vector<TimeBlock> m_timeBlocks;
+    qsizetype m_timeCount = 0;
+
+    QVector<Repeat> m_repeats;
+    QTimeZone m_timeZone = QTimeZone::systemTimeZone();
+
+    qint64 m_resident = 0;
+    qint64 m_spillable = 0;
+    qsizetype m_spilledChunks = 0;
+    qsizetype m_spilledBlocks = 0;
+    std::unique_ptr<SpillFile> m_spill;
+    QString m_spillError;
+};
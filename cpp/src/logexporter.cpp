@@ -0,0 +1,93 @@
+#include "logexporter.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QLocale>
+
+static const qsizetype kSliceBytes = 4 * 1024 * 1024;
+// Well under the writer's own 16 MB queue cap, so one more slice on top
+// never overflows it.
+static const qint64 kMaxQueuedBytes = 8 * 1024 * 1024;
+static const qint64 kSliceBudgetMs = 8;
+static const int kBackoffMs = 5;
+
+LogExporter::LogExporter(const LineSource* source, qsizetype first, qsizetype last, QObject* parent)
+    : QObject(parent), m_source(source), m_first(first), m_last(qMax(first, last)), m_next(first) {
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    connect(m_timer, &QTimer::timeout, this, &LogExporter::step);
+}
+
+LogExporter::~LogExporter() {
+    if (m_writer) m_writer->close();
+}
+
+bool LogExporter::start(const QString& path, QString* error) {
+    LogWriter::Options options;
+    options.flush = LogWriter::FlushPolicy::Size;
+    options.flushKb = 1024;
+    options.truncate = true;
+    m_path = path;
+    m_writer = std::make_unique<LogWriter>(path, options);
+    if (!m_writer->open(error)) {
+        m_writer.reset();
+        return false;
+    }
+    m_timer->start(0);
+    return true;
+}
+
+void LogExporter::cancel() {
+    if (!m_writer) return;
+    m_timer->stop();
+    m_writer->close();
+    m_writer.reset();
+    QFile::remove(m_path);
+    emit finished(false, "Export cancelled.");
+}
+
+void LogExporter::step() {
+    if (!m_writer) return;
+    if (m_writer->queuedBytes() > kMaxQueuedBytes) {
+        m_timer->start(kBackoffMs);
+        return;
+    }
+
+    QElapsedTimer budget;
+    budget.start();
+    QByteArray chunk;
+    chunk.reserve(kSliceBytes + 4096);
+    while (m_next < m_last && budget.elapsed() < kSliceBudgetMs) {
+        chunk.append(m_source->line(m_next++));
+        chunk.append('\n');
+        if (chunk.size() >= kSliceBytes) {
+            m_writer->append(chunk);
+            m_bytes += chunk.size();
+            chunk.clear();
+            if (m_writer->queuedBytes() > kMaxQueuedBytes) break;
+        }
+    }
+    if (!chunk.isEmpty()) {
+        m_writer->append(chunk);
+        m_bytes += chunk.size();
+    }
+    emit progress(m_next - m_first, m_last - m_first);
+
+    if (m_next < m_last) {
+        m_timer->start(0);
+        return;
+    }
+    m_writer->close();
+    const QString error = m_writer->errorString();
+    const qint64 lost = m_writer->droppedBytes();
+    m_writer.reset();
+    if (!error.isEmpty() || lost > 0) {
+        emit finished(false, QString("Export to %1 is incomplete: %2 were not written. %3")
+                                 .arg(m_path, QLocale().formattedDataSize(lost),
+                                      error.isEmpty() ? QString("A write to the file failed.") : error));
+        return;
+    }
+    emit finished(true, QString("Saved %1 lines (%2).")
+                            .arg(QLocale().toString(qlonglong(m_last - m_first)))
+                            .arg(QLocale().formattedDataSize(m_bytes)));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+
+#include <memory>
+
+#include "linesource.h"
+#include "logwriter.h"
+
+// Streams a line range of a LineSource to a text file. Lines are copied out
+// in bounded slices between event-loop turns (sources are GUI-thread only
+// and live ones keep growing), and written by a LogWriter thread whose queue
+// is capped, so memory stays flat however large the range is.
+class LogExporter : public QObject {
+    Q_OBJECT
+public:
+    LogExporter(const LineSource* source, qsizetype first, qsizetype last, QObject* parent = nullptr);
+    ~LogExporter() override;
+
+    bool start(const QString& path, QString* error);
+    void cancel();
+
+    qsizetype totalLines() const { return m_last - m_first; }
+
+signals:
+    void progress(qsizetype linesWritten, qsizetype totalLines);
+    void finished(bool ok, const QString& message);
+
+private:
+    void step();
+
+    const LineSource* m_source;
+    qsizetype m_first;
+    qsizetype m_last;
+    qsizetype m_next;
+    qint64 m_bytes = 0;
+    QString m_path;
+    std::unique_ptr<LogWriter> m_writer;
+    QTimer* m_timer;
+};
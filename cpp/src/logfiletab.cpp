@@ -0,0 +1,87 @@
+#include "logfiletab.h"
+
+#include <QFileInfo>
+#include <QHBoxLayout>
+#include <QLocale>
+#include <QScrollBar>
+#include <QVBoxLayout>
+
+LogFileTab::LogFileTab(std::unique_ptr<LineSource> source, const QString& path, QWidget* parent)
+    : QWidget(parent), m_source(std::move(source)), m_path(path) {
+
+    m_logView = new LogView(m_source.get(), this);
+
+    m_lineEdit = new QLineEdit(this);
+    m_lineEdit->setPlaceholderText("Line");
+    m_lineEdit->setMaximumWidth(120);
+    auto lineBtn = new QPushButton("Go", this);
+    connect(lineBtn, &QPushButton::clicked, this, &LogFileTab::goToLine);
+    connect(m_lineEdit, &QLineEdit::returnPressed, this, &LogFileTab::goToLine);
+
+    m_timeEdit = new QDateTimeEdit(this);
+    m_timeEdit->setDisplayFormat("dd-MM-yyyy HH:mm:ss");
+    auto timeBtn = new QPushButton("Go", this);
+    connect(timeBtn, &QPushButton::clicked, this, &LogFileTab::goToTime);
+
+    auto closeBtn = new QPushButton("Close", this);
+    connect(closeBtn, &QPushButton::clicked, this, &LogFileTab::closeRequested);
+
+    m_statusLabel = new QLabel(this);
+
+    auto topRow = new QHBoxLayout();
+    topRow->addWidget(new QLabel(QString("File: %1").arg(QFileInfo(m_path).fileName()), this));
+    topRow->addStretch();
+    topRow->addWidget(new QLabel("Line:", this));
+    topRow->addWidget(m_lineEdit);
+    topRow->addWidget(lineBtn);
+    if (m_source->hasTimeIndex()) {
+        topRow->addWidget(new QLabel("Time:", this));
+        topRow->addWidget(m_timeEdit);
+        topRow->addWidget(timeBtn);
+        m_timeEdit->setDateTimeRange(QDateTime::fromMSecsSinceEpoch(m_source->firstTime()),
+                                     QDateTime::fromMSecsSinceEpoch(m_source->lastTime()));
+        m_timeEdit->setDateTime(QDateTime::fromMSecsSinceEpoch(m_source->firstTime()));
+    } else {
+        m_timeEdit->hide();
+        timeBtn->hide();
+    }
+    topRow->addWidget(closeBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(topRow);
+    layout->addWidget(m_logView);
+    layout->addWidget(m_statusLabel);
+
+    m_statusLabel->setText(QString("%1 lines").arg(QLocale().toString(qlonglong(m_source->lineCount()))));
+    m_logView->linesAppended();
+    m_logView->scrollToLine(0);
+}
+
+void LogFileTab::sourceExtended(qint64 indexedBytes, qint64 totalBytes) {
+    const int value = m_logView->verticalScrollBar()->value();
+    m_logView->linesAppended();
+    m_logView->verticalScrollBar()->setValue(value);
+
+    const QString lines = QLocale().toString(qlonglong(m_source->lineCount()));
+    if (indexedBytes < totalBytes) {
+        m_statusLabel->setText(QString("Indexing... %1 lines (%2%)").arg(lines).arg(indexedBytes * 100 / totalBytes));
+    } else {
+        m_statusLabel->setText(QString("%1 lines").arg(lines));
+    }
+}
+
+void LogFileTab::goToLine() {
+    bool ok = false;
+    const qsizetype line = m_lineEdit->text().toLongLong(&ok) - 1;
+    if (!ok || line < 0 || line >= m_source->lineCount()) {
+        m_statusLabel->setText("Line out of range");
+        return;
+    }
+    m_logView->setHighlight(line, 0, m_source->lineText(line).size());
+}
+
+void LogFileTab::goToTime() {
+    const qsizetype line = m_source->lineForTime(m_timeEdit->dateTime().toMSecsSinceEpoch());
+    if (line < 0) return;
+    m_logView->setHighlight(line, 0, m_source->lineText(line).size());
+}
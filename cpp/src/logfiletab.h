@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QWidget>
+#include <QDateTimeEdit>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+
+#include <memory>
+
+#include "linesource.h"
+#include "logview.h"
+
+// Read-only tab that shows a log file through a LineSource.
+class LogFileTab : public QWidget {
+    Q_OBJECT
+public:
+    LogFileTab(std::unique_ptr<LineSource> source, const QString& path, QWidget* parent = nullptr);
+
+    QString path() const { return m_path; }
+    LogView* logView() const { return m_logView; }
+    const LineSource& source() const { return *m_source; }
+
+public slots:
+    void sourceExtended(qint64 indexedBytes, qint64 totalBytes);
+
+signals:
+    void closeRequested();
+
+private slots:
+    void goToLine();
+    void goToTime();
+
+private:
+    std::unique_ptr<LineSource> m_source;
+    QString m_path;
+    LogView* m_logView;
+    QLineEdit* m_lineEdit;
+    QDateTimeEdit* m_timeEdit;
+    QLabel* m_statusLabel;
+};
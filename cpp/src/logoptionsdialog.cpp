@@ -0,0 +1,80 @@
+#include "logoptionsdialog.h"
+
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QVBoxLayout>
+#include <QPushButton>
+
+LogOptionsDialog::LogOptionsDialog(const LogWriter::Options& current, QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Log Options");
+
+    m_flushCombo = new QComboBox(this);
+    m_flushCombo->addItem("Every N ms", int(LogWriter::FlushPolicy::Interval));
+    m_flushCombo->addItem("Every N KB", int(LogWriter::FlushPolicy::Size));
+    m_flushCombo->addItem("Sync each line (fsync)", int(LogWriter::FlushPolicy::SyncEachLine));
+    m_flushCombo->setCurrentIndex(m_flushCombo->findData(int(current.flush)));
+
+    m_intervalSpin = new QSpinBox(this);
+    m_intervalSpin->setRange(10, 60000);
+    m_intervalSpin->setSuffix(" ms");
+    m_intervalSpin->setValue(current.flushIntervalMs);
+
+    m_sizeSpin = new QSpinBox(this);
+    m_sizeSpin->setRange(1, 65536);
+    m_sizeSpin->setSuffix(" KB");
+    m_sizeSpin->setValue(current.flushKb);
+
+    m_rotateSizeSpin = new QSpinBox(this);
+    m_rotateSizeSpin->setRange(0, 1024 * 1024);
+    m_rotateSizeSpin->setSuffix(" MB");
+    m_rotateSizeSpin->setSpecialValueText("Off");
+    m_rotateSizeSpin->setValue(int(current.rotateBytes / (1024 * 1024)));
+
+    m_rotateMinutesSpin = new QSpinBox(this);
+    m_rotateMinutesSpin->setRange(0, 7 * 24 * 60);
+    m_rotateMinutesSpin->setSuffix(" min");
+    m_rotateMinutesSpin->setSpecialValueText("Off");
+    m_rotateMinutesSpin->setValue(current.rotateMinutes);
+
+    connect(m_flushCombo, &QComboBox::currentIndexChanged, this, &LogOptionsDialog::updateEnabled);
+
+    auto form = new QFormLayout();
+    form->addRow("Flush:", m_flushCombo);
+    form->addRow("Flush interval:", m_intervalSpin);
+    form->addRow("Flush size:", m_sizeSpin);
+    form->addRow("Rotate at size:", m_rotateSizeSpin);
+    form->addRow("Rotate every:", m_rotateMinutesSpin);
+
+    auto okBtn = new QPushButton("Set", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+
+    updateEnabled();
+}
+
+void LogOptionsDialog::updateEnabled() {
+    const auto policy = LogWriter::FlushPolicy(m_flushCombo->currentData().toInt());
+    m_intervalSpin->setEnabled(policy == LogWriter::FlushPolicy::Interval);
+    m_sizeSpin->setEnabled(policy == LogWriter::FlushPolicy::Size);
+}
+
+LogWriter::Options LogOptionsDialog::selectedOptions() const {
+    LogWriter::Options options;
+    options.flush = LogWriter::FlushPolicy(m_flushCombo->currentData().toInt());
+    options.flushIntervalMs = m_intervalSpin->value();
+    options.flushKb = m_sizeSpin->value();
+    options.rotateBytes = qint64(m_rotateSizeSpin->value()) * 1024 * 1024;
+    options.rotateMinutes = m_rotateMinutesSpin->value();
+    return options;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <QDialog>
+#include <QComboBox>
+#include <QSpinBox>
+
+#include "logwriter.h"
+
+class LogOptionsDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit LogOptionsDialog(const LogWriter::Options& current, QWidget* parent = nullptr);
+
+    LogWriter::Options selectedOptions() const;
+
+private:
+    void updateEnabled();
+
+    QComboBox* m_flushCombo;
+    QSpinBox* m_intervalSpin;
+    QSpinBox* m_sizeSpin;
+    QSpinBox* m_rotateSizeSpin;
+    QSpinBox* m_rotateMinutesSpin;
+};
@@ -0,0 +1,338 @@
+#include "logview.h"
+#include "linehighlighter.h"
+#include "linesource.h"
+
+#include <QApplication>
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+
+#include <algorithm>
+#include <climits>
+#include <utility>
+
+static const int kMargin = 4;
+
+static bool positionBefore(const LogView::Position& a, const LogView::Position& b) {
+    return a.line < b.line || (a.line == b.line && a.column < b.column);
+}
+
+LogView::LogView(const LineSource* source, QWidget* parent)
+    : QAbstractScrollArea(parent), m_source(source) {
+    setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    setFocusPolicy(Qt::StrongFocus);
+    viewport()->setCursor(Qt::IBeamCursor);
+    m_charWidth = qMax(1, fontMetrics().horizontalAdvance(QLatin1Char('M')));
+    updateScrollBars();
+}
+
+int LogView::rowHeight() const {
+    return qMax(1, fontMetrics().lineSpacing());
+}
+
+int LogView::visibleRows() const {
+    return qMax(1, viewport()->height() / rowHeight());
+}
+
+bool LogView::atBottom() const {
+    return verticalScrollBar()->value() >= verticalScrollBar()->maximum();
+}
+
+void LogView::updateScrollBars() {
+    const int rows = visibleRows();
+    const qsizetype count = m_source->lineCount();
+    verticalScrollBar()->setPageStep(rows);
+    verticalScrollBar()->setSingleStep(1);
+    verticalScrollBar()->setRange(0, int(qMax<qsizetype>(0, count - rows)));
+
+    const int contentWidth = int(qMin<qsizetype>(m_source->longestLine() * m_charWidth, INT_MAX / 2)) + 2 * kMargin;
+    horizontalScrollBar()->setPageStep(viewport()->width());
+    horizontalScrollBar()->setSingleStep(m_charWidth);
+    horizontalScrollBar()->setRange(0, qMax(0, contentWidth - viewport()->width()));
+}
+
+void LogView::linesAppended() {
+    const bool follow = atBottom();
+    updateScrollBars();
+    if (follow) verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+    viewport()->update();
+}
+
+void LogView::setSource(const LineSource* source) {
+    m_source = source;
+    m_matches = nullptr;
+    reset();
+    emit sourceChanged();
+}
+
+void LogView::reset() {
+    m_anchor = Position();
+    m_cursor = Position();
+    clearHighlight();
+    updateScrollBars();
+    viewport()->update();
+}
+
+void LogView::scrollToLine(qsizetype line) {
+    const qsizetype first = verticalScrollBar()->value();
+    const int rows = visibleRows();
+    if (line < first || line >= first + rows) {
+        verticalScrollBar()->setValue(int(qMax<qsizetype>(0, line - rows / 2)));
+    }
+}
+
+void LogView::setHighlight(qsizetype line, qsizetype column, qsizetype length) {
+    m_highlight = {line, column};
+    m_highlightLength = length;
+    m_anchor = {line, column};
+    m_cursor = {line, column + length};
+
+    const int x = kMargin + int(column) * m_charWidth;
+    QScrollBar* h = horizontalScrollBar();
+    if (x < h->value() || x + int(length) * m_charWidth > h->value() + viewport()->width()) {
+        h->setValue(qMax(0, x - viewport()->width() / 3));
+    }
+    scrollToLine(line);
+    viewport()->update();
+}
+
+void LogView::setMatches(const QVector<SearchMatch>* matches) {
+    m_matches = matches;
+    viewport()->update();
+}
+
+void LogView::matchesChanged() {
+    if (m_matches) viewport()->update();
+}
+
+void LogView::setHighlighter(const LineHighlighter* highlighter) {
+    m_highlighter = highlighter;
+    viewport()->update();
+}
+
+void LogView::clearHighlight() {
+    m_highlight = Position();
+    m_highlightLength = 0;
+    viewport()->update();
+}
+
+void LogView::selectLines(qsizetype first, qsizetype last) {
+    m_anchor = {first, 0};
+    m_cursor = {last, m_source->lineText(last).size()};
+    scrollToLine(first);
+    viewport()->update();
+}
+
+bool LogView::hasSelection() const {
+    return m_anchor.line >= 0 && (m_anchor.line != m_cursor.line || m_anchor.column != m_cursor.column);
+}
+
+bool LogView::selectedLines(qsizetype* first, qsizetype* last) const {
+    if (!hasSelection()) return false;
+    *first = qMin(m_anchor.line, m_cursor.line);
+    *last = qMax(m_anchor.line, m_cursor.line);
+    return true;
+}
+
+QString LogView::selectedText() const {
+    if (!hasSelection()) return QString();
+    Position start = m_anchor;
+    Position end = m_cursor;
+    if (positionBefore(end, start)) std::swap(start, end);
+
+    QString out;
+    for (qsizetype line = start.line; line <= end.line && line < m_source->lineCount(); ++line) {
+        const QString text = m_source->lineText(line);
+        const qsizetype from = line == start.line ? qMin(start.column, text.size()) : 0;
+        const qsizetype to = line == end.line ? qMin(end.column, text.size()) : text.size();
+        out += text.mid(from, to - from);
+        if (line != end.line) out += '\n';
+    }
+    return out;
+}
+
+void LogView::copySelection() const {
+    if (hasSelection()) QApplication::clipboard()->setText(selectedText());
+}
+
+LogView::Position LogView::positionAt(const QPoint& pos) const {
+    const qsizetype count = m_source->lineCount();
+    if (count == 0) return {0, 0};
+    qsizetype line = verticalScrollBar()->value() + pos.y() / rowHeight();
+    line = qBound<qsizetype>(0, line, count - 1);
+    const int x = pos.x() + horizontalScrollBar()->value() - kMargin;
+    const qsizetype column = qMax(0, (x + m_charWidth / 2) / m_charWidth);
+    return {line, qMin(column, m_source->lineText(line).size())};
+}
+
+void LogView::paintEvent(QPaintEvent*) {
+    QPainter painter(viewport());
+    const QPalette& pal = palette();
+    painter.fillRect(viewport()->rect(), pal.color(QPalette::Base));
+    painter.setFont(font());
+
+    const int h = rowHeight();
+    const int ascent = fontMetrics().ascent();
+    const int x0 = kMargin - horizontalScrollBar()->value();
+    const qsizetype first = verticalScrollBar()->value();
+    const qsizetype count = m_source->lineCount();
+    const int rows = viewport()->height() / h + 1;
+
+    Position selStart = m_anchor;
+    Position selEnd = m_cursor;
+    if (positionBefore(selEnd, selStart)) std::swap(selStart, selEnd);
+    const bool selecting = hasSelection();
+
+    const SearchMatch* match = nullptr;
+    const SearchMatch* matchEnd = nullptr;
+    if (m_matches) {
+        matchEnd = m_matches->constData() + m_matches->size();
+        match = std::lower_bound(m_matches->constData(), matchEnd, first,
+                                 [](const SearchMatch& m, qsizetype line) { return m.line < line; });
+    }
+
+    for (int r = 0; r < rows && first + r < count; ++r) {
+        const qsizetype line = first + r;
+        const int y = r * h;
+        const QString text = m_source->lineText(line);
+        const QVector<StyleRun> runs = m_source->styleRuns(line);
+
+        // Run backgrounds go under the selection and match highlights.
+        for (qsizetype i = 0; i < runs.size(); ++i) {
+            const TextStyle& style = runs[i].style;
+            const quint32 bg = style.flags & TextStyle::Inverse ? (style.fg ? style.fg : pal.color(QPalette::Text).rgb())
+                                                             : style.bg;
+            if (!bg) continue;
+            const QByteArrayView bytes = m_source->line(line);
+            const qsizetype from = QString::fromUtf8(bytes.first(runs[i].offset)).size();
+            const qsizetype to = i + 1 < runs.size() ? QString::fromUtf8(bytes.first(runs[i + 1].offset)).size()
+                                                     : text.size();
+            painter.fillRect(x0 + int(from) * m_charWidth, y, int(to - from) * m_charWidth, h, QColor(bg));
+        }
+
+        if (selecting && line >= selStart.line && line <= selEnd.line) {
+            const qsizetype from = line == selStart.line ? selStart.column : 0;
+            const qsizetype to = line == selEnd.line ? selEnd.column : text.size() + 1;
+            painter.fillRect(x0 + int(from) * m_charWidth, y, int(to - from) * m_charWidth, h,
+                             pal.color(QPalette::Highlight));
+        }
+        for (; match != matchEnd && match->line == line; ++match) {
+            painter.fillRect(x0 + int(match->column) * m_charWidth, y,
+                             int(match->length) * m_charWidth, h, QColor(255, 217, 102, 110));
+        }
+        if (line == m_highlight.line && m_highlightLength > 0) {
+            painter.fillRect(x0 + int(m_highlight.column) * m_charWidth, y,
+                             int(m_highlightLength) * m_charWidth, h, QColor("#ffd966"));
+        }
+
+        QColor color = pal.color(QPalette::Text);
+        if (m_source->isLineDimmed(line)) {
+            color = pal.color(QPalette::PlaceholderText);
+        } else if (m_highlighter) {
+            const QColor level = m_highlighter->colorFor(m_source->line(line));
+            if (level.isValid()) color = level;
+        }
+        if (runs.isEmpty()) {
+            painter.setPen(color);
+            painter.drawText(x0, y + ascent, text);
+        } else {
+            drawStyledLine(painter, x0, y, ascent, m_source->line(line), text, runs, color);
+        }
+
+        const QString note = m_source->lineNote(line);
+        if (!note.isEmpty()) {
+            painter.setPen(pal.color(QPalette::PlaceholderText));
+            painter.drawText(x0 + int(text.size() + 2) * m_charWidth, y + ascent, note);
+        }
+    }
+}
+
+// Each run is drawn at its own column so bold or italic glyphs cannot push
+// the rest of the line off the character grid.
+void LogView::drawStyledLine(QPainter& painter, int x0, int y, int ascent, QByteArrayView bytes, const QString& text,
+                             const QVector<StyleRun>& runs, const QColor& defaultColor) {
+    const bool ascii = bytes.size() == text.size();
+    auto column = [&](qsizetype offset) {
+        return ascii ? offset : QString::fromUtf8(bytes.first(offset)).size();
+    };
+
+    qsizetype from = 0;
+    TextStyle style;
+    for (qsizetype i = 0; i <= runs.size(); ++i) {
+        const qsizetype to = i < runs.size() ? column(runs[i].offset) : text.size();
+        if (to > from) {
+            QColor fg = style.fg ? QColor(style.fg) : defaultColor;
+            if (style.flags & TextStyle::Inverse) fg = style.bg ? QColor(style.bg) : palette().color(QPalette::Base);
+            if (style.flags & TextStyle::Dim) fg.setAlpha(160);
+
+            QFont font = this->font();
+            font.setBold(style.flags & TextStyle::Bold);
+            font.setItalic(style.flags & TextStyle::Italic);
+            font.setUnderline(style.flags & TextStyle::Underline);
+            painter.setFont(font);
+            painter.setPen(fg);
+            painter.drawText(x0 + int(from) * m_charWidth, y + ascent, text.mid(from, to - from));
+        }
+        if (i < runs.size()) style = runs[i].style;
+        from = qMax(from, to);
+    }
+    painter.setFont(font());
+}
+
+void LogView::resizeEvent(QResizeEvent* event) {
+    const bool follow = atBottom();
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollBars();
+    if (follow) verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+}
+
+void LogView::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) return;
+    m_anchor = positionAt(event->position().toPoint());
+    m_cursor = m_anchor;
+    viewport()->update();
+}
+
+void LogView::mouseMoveEvent(QMouseEvent* event) {
+    if (!(event->buttons() & Qt::LeftButton) || m_anchor.line < 0) return;
+    const QPoint pos = event->position().toPoint();
+    if (pos.y() < 0) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepSub);
+    } else if (pos.y() > viewport()->height()) {
+        verticalScrollBar()->triggerAction(QAbstractSlider::SliderSingleStepAdd);
+    }
+    m_cursor = positionAt(pos);
+    viewport()->update();
+}
+
+void LogView::keyPressEvent(QKeyEvent* event) {
+    if (event->matches(QKeySequence::Copy)) {
+        copySelection();
+        return;
+    }
+    if (event->matches(QKeySequence::SelectAll)) {
+        const qsizetype count = m_source->lineCount();
+        if (count > 0) {
+            m_anchor = {0, 0};
+            m_cursor = {count - 1, m_source->lineText(count - 1).size()};
+            viewport()->update();
+        }
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToStartOfDocument)) {
+        verticalScrollBar()->setValue(0);
+        return;
+    }
+    if (event->matches(QKeySequence::MoveToEndOfDocument)) {
+        verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
+
+void LogView::scrollContentsBy(int, int) {
+    viewport()->update();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QAbstractScrollArea>
+#include <QString>
+
+#include "searchengine.h"
+
+class LineHighlighter;
+class LineSource;
+class QPainter;
+
+// Virtualized read-only view over a LineSource: only the rows that intersect
+// the viewport are converted and painted, so cost is independent of history.
+class LogView : public QAbstractScrollArea {
+    Q_OBJECT
+public:
+    struct Position {
+        qsizetype line = -1;
+        qsizetype column = 0;
+    };
+
+    explicit LogView(const LineSource* source, QWidget* parent = nullptr);
+
+    const LineSource* source() const { return m_source; }
+    void setSource(const LineSource* source);
+
+    void linesAppended();
+    void reset();
+
+    void scrollToLine(qsizetype line);
+    void setHighlight(qsizetype line, qsizetype column, qsizetype length);
+    void clearHighlight();
+    Position highlightPosition() const { return m_highlight; }
+    qsizetype highlightLength() const { return m_highlightLength; }
+
+    // Highlights every match in a list sorted by line; the list is owned by
+    // the caller and must outlive the view or be cleared with nullptr.
+    void setMatches(const QVector<SearchMatch>* matches);
+    void matchesChanged();
+
+    // Colours plain text of lines matching a rule; owned by the caller.
+    void setHighlighter(const LineHighlighter* highlighter);
+
+    // Selects whole lines [first, last] and scrolls to the first.
+    void selectLines(qsizetype first, qsizetype last);
+    bool hasSelection() const;
+    bool selectedLines(qsizetype* first, qsizetype* last) const;
+    QString selectedText() const;
+    void copySelection() const;
+
+signals:
+    void sourceChanged();
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+
+private:
+    int rowHeight() const;
+    int visibleRows() const;
+    bool atBottom() const;
+    void updateScrollBars();
+    Position positionAt(const QPoint& pos) const;
+    void drawStyledLine(QPainter& painter, int x0, int y, int ascent, QByteArrayView bytes, const QString& text,
+                        const QVector<StyleRun>& runs, const QColor& defaultColor);
+
+    const LineSource* m_source;
+    int m_charWidth = 8;
+    Position m_anchor;
+    Position m_cursor;
+    Position m_highlight;
+    qsizetype m_highlightLength = 0;
+    const QVector<SearchMatch>* m_matches = nullptr;
+    const LineHighlighter* m_highlighter = nullptr;
+};
@@ -0,0 +1,270 @@
+#include "logwriter.h"
+
+#include <QDateTime>
+#include <QDeadlineTimer>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+LogWriter::LogWriter(const QString& path, const Options& options, QObject* parent)
+    : QThread(parent), m_basePath(path), m_options(options),
+      m_maxQueued(qMax<qsizetype>(16 * 1024 * 1024, qsizetype(options.flushKb) * 1024 * 4)) {}
+
+LogWriter::~LogWriter() {
+    close();
+}
+
+QString LogWriter::pathForIndex(int index) const {
+    if (index == 0) return m_basePath;
+    const QFileInfo info(m_basePath);
+    const QString suffix = info.completeSuffix();
+    const QString stem = info.dir().filePath(info.baseName());
+    return suffix.isEmpty() ? QString("%1.%2").arg(stem).arg(index)
+                            : QString("%1.%2.%3").arg(stem).arg(index).arg(suffix);
+}
+
+void LogWriter::closeFile() {
+    if (!m_file.isOpen()) return;
+    if (m_options.format == Format::Compressed) m_encoder.finish();
+    m_file.flush();
+    m_file.close();
+}
+
+bool LogWriter::openIndex(int index) {
+    closeFile();
+    const QString path = pathForIndex(index);
+    m_file.setFileName(path);
+    if (m_options.format == Format::Compressed) {
+        if (!m_file.open(QIODevice::ReadWrite)) return false;
+        if (!m_encoder.begin(&m_file)) {
+            m_file.close();
+            m_file.setErrorString("Existing file is not a compressed UART log.");
+            return false;
+        }
+    } else if (m_options.format == Format::Binary) {
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    } else if (!m_file.open(QIODevice::WriteOnly | QIODevice::Text
+                            | (m_options.truncate ? QIODevice::Truncate : QIODevice::Append))) {
+        return false;
+    }
+    m_fileIndex = index;
+    m_fileBytes = m_file.size();
+    m_fileAge.start();
+    QMutexLocker lock(&m_mutex);
+    m_currentPath = path;
+    return true;
+}
+
+bool LogWriter::open(QString* error) {
+    if (!openIndex(0)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    start();
+    return true;
+}
+
+void LogWriter::append(QByteArrayView data) {
+    if (data.isEmpty()) return;
+    QMutexLocker lock(&m_mutex);
+    if (m_front.size() + data.size() > m_maxQueued) {
+        m_droppedBytes.fetch_add(data.size(), std::memory_order_relaxed);
+        m_overflowing = true;
+        m_wake.wakeOne();
+        return;
+    }
+    if (m_options.format == Format::Compressed) {
+        m_frontMarks.append({m_front.size(), QDateTime::currentMSecsSinceEpoch()});
+    }
+    m_front.append(data);
+    m_queuedBytes.fetch_add(data.size(), std::memory_order_relaxed);
+    const bool wake = m_options.flush == FlushPolicy::SyncEachLine
+                      || (m_options.flush == FlushPolicy::Size && m_front.size() >= qsizetype(m_options.flushKb) * 1024);
+    if (wake) m_wake.wakeOne();
+}
+
+void LogWriter::close() {
+    {
+        QMutexLocker lock(&m_mutex);
+        m_stopping = true;
+        m_wake.wakeOne();
+    }
+    wait();
+    closeFile();
+}
+
+QString LogWriter::currentPath() const {
+    QMutexLocker lock(&m_mutex);
+    return m_currentPath;
+}
+
+QString LogWriter::errorString() const {
+    QMutexLocker lock(&m_mutex);
+    if (m_error.isEmpty() && m_overflowing) return "Log queue is full; the disk is not keeping up";
+    return m_error;
+}
+
+// Called on the writer thread; the lock is only taken when the state changes.
+void LogWriter::setError(const QString& error) {
+    if (error.isEmpty() && !m_failed) return;
+    m_failed = !error.isEmpty();
+    QMutexLocker lock(&m_mutex);
+    m_error = error;
+}
+
+void LogWriter::run() {
+    const bool compressed = m_options.format == Format::Compressed;
+    // Under the Size policy a quiet port still reaches disk: a batch that
+    // has waited this long is written however small it is.
+    const int maxBatchAgeMs = compressed ? CompressedLogEncoder::kMaxBlockAgeMs : kMaxBatchAgeMs;
+
+    QMutexLocker lock(&m_mutex);
+    for (;;) {
+        bool timedOut = false;
+        switch (m_options.flush) {
+        case FlushPolicy::Interval:
+            if (!m_stopping) m_wake.wait(&m_mutex, QDeadlineTimer(m_options.flushIntervalMs));
+            break;
+        case FlushPolicy::Size:
+            while (!timedOut && !m_stopping && m_front.size() < qsizetype(m_options.flushKb) * 1024) {
+                timedOut = !m_wake.wait(&m_mutex, QDeadlineTimer(maxBatchAgeMs));
+            }
+            break;
+        case FlushPolicy::SyncEachLine:
+            while (!m_stopping && m_front.isEmpty()) m_wake.wait(&m_mutex);
+            break;
+        }
+
+        if (m_front.isEmpty()) {
+            if (m_stopping) return;
+            if (compressed) {
+                lock.unlock();
+                m_encoder.flushIfStale();
+                m_file.flush();
+                lock.relock();
+            }
+            continue;
+        }
+
+        m_back.swap(m_front);
+        m_backMarks.swap(m_frontMarks);
+        lock.unlock();
+        if (compressed) {
+            writeCompressed(m_back);
+        } else {
+            writeBatch(m_back);
+        }
+        m_queuedBytes.fetch_sub(m_back.size(), std::memory_order_relaxed);
+        m_back.resize(0);
+        m_backMarks.resize(0);
+        lock.relock();
+        if (m_overflowing && m_front.size() < m_maxQueued / 2) m_overflowing = false;
+    }
+}
+
+// Returns false when no file is open to write to. After a failed rotation
+// the next index is tried again on every call.
+bool LogWriter::rotateIfNeeded(qsizetype incoming) {
+    if (m_file.isOpen()) {
+        const bool bySize = m_options.rotateBytes > 0 && m_fileBytes > 0
+                            && m_fileBytes + incoming > m_options.rotateBytes;
+        const bool byAge = m_options.rotateMinutes > 0
+                           && m_fileAge.elapsed() >= qint64(m_options.rotateMinutes) * 60000;
+        if (!bySize && !byAge) return true;
+    }
+    if (!openIndex(m_fileIndex + 1)) {
+        setError(QString("Cannot open %1: %2").arg(m_file.fileName(), m_file.errorString()));
+        m_droppedBytes.fetch_add(incoming, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void LogWriter::writeBatch(const QByteArray& batch) {
+    QElapsedTimer timer;
+    timer.start();
+
+    if (m_options.flush == FlushPolicy::SyncEachLine) {
+        qsizetype start = 0;
+        while (start < batch.size()) {
+            qsizetype end = batch.indexOf('\n', start);
+            end = end < 0 ? batch.size() : end + 1;
+            if (!rotateIfNeeded(end - start)) {
+                m_droppedBytes.fetch_add(batch.size() - end, std::memory_order_relaxed);
+                break;
+            }
+            const bool ok = m_file.write(batch.constData() + start, end - start) == end - start && m_file.flush();
+            syncToDisk();
+            if (!ok) {
+                setError(QString("Cannot write %1: %2").arg(m_file.fileName(), m_file.errorString()));
+                m_droppedBytes.fetch_add(end - start, std::memory_order_relaxed);
+            } else {
+                setError(QString());
+            }
+            m_fileBytes += end - start;
+            start = end;
+        }
+    } else if (rotateIfNeeded(batch.size())) {
+        if (m_file.write(batch) == batch.size() && m_file.flush()) {
+            setError(QString());
+        } else {
+            setError(QString("Cannot write %1: %2").arg(m_file.fileName(), m_file.errorString()));
+            m_droppedBytes.fetch_add(batch.size(), std::memory_order_relaxed);
+        }
+        m_fileBytes += batch.size();
+    }
+
+    const qint64 us = timer.nsecsElapsed() / 1000;
+    m_lastWriteUs.store(us, std::memory_order_relaxed);
+    if (us > m_maxWriteUs.load(std::memory_order_relaxed)) m_maxWriteUs.store(us, std::memory_order_relaxed);
+}
+
+void LogWriter::writeCompressed(const QByteArray& batch) {
+    QElapsedTimer timer;
+    timer.start();
+
+    if (rotateIfNeeded(batch.size())) {
+        for (qsizetype i = 0; i < m_backMarks.size(); ++i) {
+            const qsizetype start = m_backMarks.at(i).first;
+            const qsizetype end = i + 1 < m_backMarks.size() ? m_backMarks.at(i + 1).first : batch.size();
+            m_encoder.append(QByteArrayView(batch.constData() + start, end - start), m_backMarks.at(i).second);
+        }
+        bool ok;
+        if (m_options.flush == FlushPolicy::SyncEachLine) {
+            m_encoder.flushBlock();
+            ok = m_file.flush();
+            syncToDisk();
+        } else {
+            m_encoder.flushIfStale();
+            ok = m_file.flush();
+        }
+        // The encoder writes on its own; a failed write shows up as a
+        // device error by the time of the flush.
+        if (ok && m_file.error() == QFileDevice::NoError) {
+            setError(QString());
+        } else {
+            setError(QString("Cannot write %1: %2").arg(m_file.fileName(), m_file.errorString()));
+            m_droppedBytes.fetch_add(batch.size(), std::memory_order_relaxed);
+            m_file.unsetError();
+        }
+        m_fileBytes = m_file.size();
+    }
+
+    const qint64 us = timer.nsecsElapsed() / 1000;
+    m_lastWriteUs.store(us, std::memory_order_relaxed);
+    if (us > m_maxWriteUs.load(std::memory_order_relaxed)) m_maxWriteUs.store(us, std::memory_order_relaxed);
+}
+
+void LogWriter::syncToDisk() {
+#ifdef Q_OS_WIN
+    _commit(m_file.handle());
+#else
+    ::fsync(m_file.handle());
+#endif
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QPair>
+#include <QThread>
+#include <QVector>
+#include <QWaitCondition>
+
+#include <atomic>
+
+#include "compressedlog.h"
+
+// Background log file writer. Producers append into a front buffer under a
+// short lock; the writer thread swaps it with the back buffer and writes the
+// whole batch, flushing and rotating according to Options. Compressed logs
+// are encoded on the writer thread as well. A file that fails to open on
+// rotation is retried with every batch; until one opens, batches are counted
+// as dropped and errorString() says why. The queue is capped, so a disk that
+// cannot keep up costs dropped data rather than memory and a long close().
+class LogWriter : public QThread {
+public:
+    enum class FlushPolicy { Interval, Size, SyncEachLine };
+    enum class Format { PlainText, Compressed, Binary };
+    static const int kMaxBatchAgeMs = 1000;
+
+    struct Options {
+        Format format = Format::PlainText;
+        FlushPolicy flush = FlushPolicy::Interval;
+        int flushIntervalMs = 200;
+        int flushKb = 64;
+        qint64 rotateBytes = 0;
+        int rotateMinutes = 0;
+        bool truncate = false;
+    };
+
+    LogWriter(const QString& path, const Options& options, QObject* parent = nullptr);
+    ~LogWriter() override;
+
+    bool open(QString* error);
+    void append(QByteArrayView data);
+    void close();
+
+    QString currentPath() const;
+    qint64 queuedBytes() const { return m_queuedBytes.load(std::memory_order_relaxed); }
+    qint64 lastWriteUs() const { return m_lastWriteUs.load(std::memory_order_relaxed); }
+    qint64 maxWriteUs() const { return m_maxWriteUs.load(std::memory_order_relaxed); }
+    // Last open or write failure, or a full queue; empty once writes succeed
+    // again and the queue has room.
+    QString errorString() const;
+    qint64 droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+
+protected:
+    void run() override;
+
+private:
+    QString pathForIndex(int index) const;
+    bool openIndex(int index);
+    bool rotateIfNeeded(qsizetype incoming);
+    void setError(const QString& error);
+    void writeBatch(const QByteArray& batch);
+    void writeCompressed(const QByteArray& batch);
+    void closeFile();
+    void syncToDisk();
+
+    const QString m_basePath;
+    const Options m_options;
+    const qsizetype m_maxQueued;
+
+    mutable QMutex m_mutex;
+    QWaitCondition m_wake;
+    QByteArray m_front;
+    QByteArray m_back;
+    QVector<QPair<qsizetype, qint64>> m_frontMarks;
+    QVector<QPair<qsizetype, qint64>> m_backMarks;
+    bool m_stopping = false;
+    QString m_error;
+    bool m_overflowing = false;
+
+    QFile m_file;
+    CompressedLogEncoder m_encoder;
+    int m_fileIndex = 0;
+    qint64 m_fileBytes = 0;
+    QElapsedTimer m_fileAge;
+    QString m_currentPath;
+    bool m_failed = false;
+
+    std::atomic<qint64> m_queuedBytes{0};
+    std::atomic<qint64> m_lastWriteUs{0};
+    std::atomic<qint64> m_maxWriteUs{0};
+    std::atomic<qint64> m_droppedBytes{0};
+};
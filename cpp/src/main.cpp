@@ -1,7 +1,74 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTimer>
+
+#include <atomic>
+#include <csignal>
+#include <cstring>
+
+#include "headlessdaemon.h"
 #include "mainwindow.h"
 
+static std::atomic<bool> g_quitRequested{false};
+
+static void requestQuit(int) {
+    g_quitRequested = true;
+}
+
+static bool wantsHeadless(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--headless") == 0) return true;
+    }
+    return false;
+}
+
+// Runs without creating a QApplication, so no display is needed. SIGINT and
+// SIGTERM stop the ports and flush the logs before exiting.
+static int runHeadless(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("uart-log-viewer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Captures serial ports to log files without a GUI.");
+    parser.addHelpOption();
+    parser.addOption({"headless", "Run without a GUI."});
+    parser.addOption({"config", "JSON file listing the ports to capture.", "file"});
+    parser.process(app);
+
+    if (!parser.isSet("config")) {
+        qCritical("--headless needs --config <file>");
+        return 2;
+    }
+    HeadlessDaemon::Config config;
+    QString error;
+    if (!HeadlessDaemon::loadConfig(parser.value("config"), &config, &error)) {
+        qCritical("%s: %s", qPrintable(parser.value("config")), qPrintable(error));
+        return 2;
+    }
+
+    HeadlessDaemon daemon(config);
+    if (!daemon.start(&error)) {
+        qCritical("%s", qPrintable(error));
+        return 1;
+    }
+
+    std::signal(SIGINT, requestQuit);
+    std::signal(SIGTERM, requestQuit);
+    QTimer quitPoll;
+    QObject::connect(&quitPoll, &QTimer::timeout, &app, [&]() {
+        if (g_quitRequested) app.quit();
+    });
+    quitPoll.start(200);
+
+    const int status = app.exec();
+    daemon.stop();
+    return status;
+}
+
 int main(int argc, char *argv[]) {
+    if (wantsHeadless(argc, argv)) return runHeadless(argc, argv);
+
     QApplication app(argc, argv);
     MainWindow w;
     w.show();
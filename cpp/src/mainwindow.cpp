@@ -1,37 +1,27 @@
 #include "mainwindow.h"
 #include "timezonedialog.h"
+#include "logoptionsdialog.h"
+#include "compressedlog.h"
+#include "mappedlogsource.h"
+#include "exportdialog.h"
+#include "highlightrulesdialog.h"
+#include "timelinedialog.h"
+#include "portmonitor.h"
 
 #include <QMenuBar>
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QInputDialog>
-#include <QSerialPortInfo>
-#include <QTextDocument>
-#include <QTextCursor>
+#include <QLineEdit>
 #include <QRegularExpression>
 #include <QPalette>
 #include <QFile>
 #include <QApplication>
 #include <QTabBar>
+#include <QFileInfo>
+#include <QProgressDialog>
 
-static QStringList filterPorts(const QList<QSerialPortInfo>& infos) {
-    QStringList ports;
-#ifdef Q_OS_WIN
-    for (const auto& info : infos) ports << info.portName();
-#elif defined(Q_OS_MAC)
-    for (const auto& info : infos) {
-        const QString name = info.portName();
-        if (name.startsWith("cu.") || name.startsWith("tty.")) ports << name;
-    }
-#else
-    for (const auto& info : infos) {
-        const QString name = info.portName();
-        if (name.startsWith("ttyUSB") || name.startsWith("ttyACM")) ports << name;
-    }
-#endif
-    ports.sort();
-    return ports;
-}
+#include <algorithm>
 
 MainWindow::MainWindow(QWidget* parent)
     : QMainWindow(parent) {
@@ -43,11 +33,22 @@ MainWindow::MainWindow(QWidget* parent)
     m_tabs->tabBar()->setMovable(false);
 
     m_timeZone = QTimeZone::systemTimeZone();
+    // Start enumerating in the background while the window comes up.
+    PortMonitor::instance();
+
+    m_metricsExporter = new MetricsExporter(m_tabs, this);
+    m_highlighter.setRules(LineHighlighter::defaultRules(), nullptr);
+
+    m_search = new SearchEngine(this);
+    connect(m_search, &SearchEngine::matchesAdded, this, &MainWindow::searchUpdated);
+    connect(m_search, &SearchEngine::progress, this, &MainWindow::searchUpdated);
 
     auto fileMenu = menuBar()->addMenu("File");
     auto toolsMenu = menuBar()->addMenu("Tools");
 
     fileMenu->addAction("New Tab...", this, &MainWindow::newTab);
+    fileMenu->addAction("Open Log...", this, &MainWindow::openLog);
+    fileMenu->addAction("Merged Timeline...", this, &MainWindow::openTimeline);
     fileMenu->addAction("Refresh Ports", this, &MainWindow::refreshPorts);
     fileMenu->addAction("Save Logs...", this, &MainWindow::saveLogs);
     fileMenu->addSeparator();
@@ -57,7 +58,32 @@ MainWindow::MainWindow(QWidget* parent)
     m_timestampAction->setCheckable(true);
     connect(m_timestampAction, &QAction::toggled, this, &MainWindow::toggleTimestamp);
 
+    auto formatMenu = toolsMenu->addMenu("Timestamp Format");
+    auto formatGroup = new QActionGroup(this);
+    const QList<QPair<QString, TimestampFormatter::Mode>> formats = {
+        {"Date/Time (ms)", TimestampFormatter::Mode::Absolute},
+        {"Date/Time (\u00B5s)", TimestampFormatter::Mode::AbsoluteMicro},
+        {"Relative to Connect", TimestampFormatter::Mode::Relative},
+        {"Delta from Previous Line", TimestampFormatter::Mode::Delta},
+    };
+    for (const auto& format : formats) {
+        auto action = formatMenu->addAction(format.first);
+        action->setCheckable(true);
+        action->setChecked(format.second == m_timestampMode);
+        formatGroup->addAction(action);
+        const TimestampFormatter::Mode mode = format.second;
+        connect(action, &QAction::triggered, this, [this, mode]() { setTimestampMode(mode); });
+    }
+
     toolsMenu->addAction("Timezone...", this, &MainWindow::selectTimezone);
+    toolsMenu->addAction("Log Options...", this, &MainWindow::selectLogOptions);
+    toolsMenu->addAction("Scrollback Memory...", this, &MainWindow::selectMemoryBudget);
+    toolsMenu->addAction("Highlight Rules...", this, &MainWindow::selectHighlightRules);
+
+    auto metricsMenu = toolsMenu->addMenu("Metrics Export");
+    metricsMenu->addAction("To File...", this, &MainWindow::exportMetricsToFile);
+    metricsMenu->addAction("To Local Socket...", this, &MainWindow::exportMetricsToSocket);
+    metricsMenu->addAction("Stop", this, [this]() { m_metricsExporter->stop(); });
 
     auto findAction = toolsMenu->addAction("Find...");
     findAction->setShortcut(QKeySequence::Find);
@@ -75,6 +101,7 @@ MainWindow::MainWindow(QWidget* parent)
 }
 
 void MainWindow::refreshPorts() {
+    PortMonitor::instance()->refresh();
     const QStringList ports = availablePorts();
     if (ports.isEmpty()) {
         QMessageBox::information(this, "UART Log Viewer", "No serial ports detected.");
@@ -82,7 +109,7 @@ void MainWindow::refreshPorts() {
 }
 
 QStringList MainWindow::availablePorts() const {
-    return filterPorts(QSerialPortInfo::availablePorts());
+    return PortMonitor::instance()->ports();
 }
 
 void MainWindow::newTab() {
@@ -112,26 +139,137 @@ void MainWindow::newTab() {
     auto tab = new SerialTab(port, this);
     tab->setTimestampEnabled(m_timestampAction->isChecked());
     tab->setTimeZone(m_timeZone);
+    tab->setTimestampMode(m_timestampMode);
+    tab->setLogOptions(m_logOptions);
+    insertTab(tab, port);
+}
+
+void MainWindow::openLog() {
+    const QString path = QFileDialog::getOpenFileName(this, "Open Log", QString(),
+                                                      "Log Files (*.txt *.log *.ulz);;Compressed Logs (*.ulz);;All Files (*)");
+    if (path.isEmpty()) return;
+
+    std::unique_ptr<LineSource> source;
+    MappedLogSource* mapped = nullptr;
+    QString error;
+    if (CompressedLog::isCompressedLogPath(path)) {
+        auto reader = std::make_unique<CompressedLogReader>();
+        if (reader->open(path, &error)) source = std::move(reader);
+    } else {
+        auto reader = std::make_unique<MappedLogSource>();
+        if (reader->open(path, &error)) {
+            mapped = reader.get();
+            source = std::move(reader);
+        }
+    }
+    if (!source) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Failed to open %1: %2").arg(path, error));
+        return;
+    }
+
+    auto tab = new LogFileTab(std::move(source), path, this);
+    if (mapped) connect(mapped, &MappedLogSource::indexProgress, tab, &LogFileTab::sourceExtended);
+    connect(tab, &LogFileTab::closeRequested, this, [this, tab]() {
+        m_tabs->removeTab(m_tabs->indexOf(tab));
+        tab->deleteLater();
+    });
+    insertTab(tab, QFileInfo(path).fileName());
+}
+
+void MainWindow::openTimeline() {
+    QList<SerialTab*> tabs;
+    QStringList ports;
+    for (int i = 0; i < m_tabs->count(); ++i) {
+        if (auto tab = qobject_cast<SerialTab*>(m_tabs->widget(i))) {
+            tabs << tab;
+            ports << tab->portName();
+        }
+    }
+    if (tabs.isEmpty()) {
+        QMessageBox::information(this, "UART Log Viewer", "Open a port tab first.");
+        return;
+    }
+
+    TimelineDialog dlg(ports, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    QList<SerialTab*> selected;
+    for (int index : dlg.selectedIndexes()) selected << tabs[index];
+    if (selected.isEmpty()) return;
+
+    auto tab = new TimelineTab(selected, this);
+    connect(tab, &TimelineTab::closeRequested, this, [this, tab]() {
+        m_tabs->removeTab(m_tabs->indexOf(tab));
+        tab->deleteLater();
+    });
+    insertTab(tab, "Timeline");
+}
+
+void MainWindow::insertTab(QWidget* tab, const QString& label) {
+    if (auto serialTab = qobject_cast<SerialTab*>(tab)) serialTab->logView()->setHighlighter(&m_highlighter);
+    if (auto fileTab = qobject_cast<LogFileTab*>(tab)) fileTab->logView()->setHighlighter(&m_highlighter);
+    if (auto timelineTab = qobject_cast<TimelineTab*>(tab)) timelineTab->logView()->setHighlighter(&m_highlighter);
     int insertAt = m_tabs->count();
     if (m_plusTab) insertAt = m_tabs->indexOf(m_plusTab);
-    m_tabs->insertTab(insertAt, tab, port);
+    m_tabs->insertTab(insertAt, tab, label);
     m_tabs->setCurrentWidget(tab);
 }
 
 void MainWindow::saveLogs() {
-    auto tab = currentTab();
-    if (!tab) return;
+    LogView* view = currentLogView();
+    if (!view) return;
+    if (m_exporter) {
+        QMessageBox::information(this, "UART Log Viewer", "An export is already running.");
+        return;
+    }
+
+    qsizetype selectionFirst = -1;
+    qsizetype selectionLast = -1;
+    view->selectedLines(&selectionFirst, &selectionLast);
+    ExportDialog rangeDialog(view->source(), selectionFirst, selectionLast, this);
+    if (rangeDialog.exec() != QDialog::Accepted) return;
+    const qsizetype first = rangeDialog.firstLine();
+    const qsizetype last = rangeDialog.lastLine();
+    if (last <= first) {
+        QMessageBox::information(this, "UART Log Viewer", "The selected range is empty.");
+        return;
+    }
 
-    const QString defaultName = QString("uart_log_%1.txt").arg(tab->portName().replace("/", "_"));
+    auto tab = currentTab();
+    const QString baseName = tab ? tab->portName().replace("/", "_") : m_tabs->tabText(m_tabs->currentIndex());
+    const QString defaultName = QString("uart_log_%1.txt").arg(baseName);
     const QString path = QFileDialog::getSaveFileName(this, "Save Logs", defaultName, "Text Files (*.txt);;All Files (*)");
     if (path.isEmpty()) return;
 
-    QFile file(path);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-        QMessageBox::warning(this, "UART Log Viewer", "Failed to write file.");
+    m_exporter = new LogExporter(view->source(), first, last, this);
+    QString error;
+    if (!m_exporter->start(path, &error)) {
+        delete m_exporter;
+        m_exporter = nullptr;
+        QMessageBox::warning(this, "UART Log Viewer", QString("Failed to write file: %1").arg(error));
         return;
     }
-    file.write(tab->textEdit()->toPlainText().toUtf8());
+
+    // Window-modal so the exported tab cannot be closed underneath the
+    // export; the event loop keeps running and live ports keep updating.
+    auto progress = new QProgressDialog("Saving logs...", "Cancel", 0, 1000, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setAutoClose(false);
+    progress->setAutoReset(false);
+    connect(progress, &QProgressDialog::canceled, m_exporter, &LogExporter::cancel);
+    connect(m_exporter, &LogExporter::progress, progress, [progress](qsizetype done, qsizetype total) {
+        progress->setValue(int(done * 1000 / qMax<qsizetype>(total, 1)));
+    });
+    connect(m_exporter, &LogExporter::finished, this, [this, progress](bool ok, const QString& message) {
+        const bool cancelled = progress->wasCanceled();
+        progress->close();
+        progress->deleteLater();
+        m_exporter->deleteLater();
+        m_exporter = nullptr;
+        // A cancel was the user's own doing and needs no report.
+        if (ok) QMessageBox::information(this, "UART Log Viewer", message);
+        else if (!cancelled) QMessageBox::warning(this, "UART Log Viewer", message);
+    });
 }
 
 void MainWindow::toggleTimestamp(bool enabled) {
@@ -151,51 +289,172 @@ void MainWindow::selectTimezone() {
     }
 }
 
+void MainWindow::exportMetricsToFile() {
+    const QString path = QFileDialog::getSaveFileName(this, "Export Metrics", "uart_metrics.jsonl",
+                                                      "JSON Lines (*.jsonl);;All Files (*)");
+    if (path.isEmpty()) return;
+    QString error;
+    if (!m_metricsExporter->startFile(path, &error)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Failed to open %1: %2").arg(path, error));
+    }
+}
+
+void MainWindow::exportMetricsToSocket() {
+    bool ok = false;
+    const QString name = QInputDialog::getText(this, "Export Metrics", "Local socket name or path:",
+                                               QLineEdit::Normal, "uart-log-viewer-metrics", &ok);
+    if (!ok || name.isEmpty()) return;
+    m_metricsExporter->startSocket(name);
+}
+
+void MainWindow::selectLogOptions() {
+    LogOptionsDialog dlg(m_logOptions, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    m_logOptions = dlg.selectedOptions();
+    for (int i = 0; i < m_tabs->count(); ++i) {
+        auto tab = qobject_cast<SerialTab*>(m_tabs->widget(i));
+        if (tab) tab->setLogOptions(m_logOptions);
+    }
+}
+
+// The budget is shared by every tab; older scrollback beyond it is moved to
+// temporary files.
+void MainWindow::selectMemoryBudget() {
+    bool ok = false;
+    const int mb = QInputDialog::getInt(this, "UART Log Viewer",
+                                        "Scrollback kept in memory, all tabs (MB, 0 = no limit):",
+                                        int(LineStore::memoryBudget() / (1024 * 1024)), 0, 1024 * 1024, 64, &ok);
+    if (!ok) return;
+    LineStore::setMemoryBudget(qint64(mb) * 1024 * 1024);
+}
+
+void MainWindow::selectHighlightRules() {
+    HighlightRulesDialog dlg(m_highlighter.rules(), this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    QString error;
+    if (!m_highlighter.setRules(dlg.selectedRules(), &error)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Invalid highlight rules: %1").arg(error));
+        return;
+    }
+    if (LogView* view = currentLogView()) view->viewport()->update();
+}
+
+void MainWindow::setTimestampMode(TimestampFormatter::Mode mode) {
+    m_timestampMode = mode;
+    for (int i = 0; i < m_tabs->count(); ++i) {
+        auto tab = qobject_cast<SerialTab*>(m_tabs->widget(i));
+        if (tab) tab->setTimestampMode(mode);
+    }
+}
+
 void MainWindow::openFind() {
     if (!m_findDialog) {
         m_findDialog = new FindDialog(this);
+        m_findDialog->setEngine(m_search);
         connect(m_findDialog, &FindDialog::findNextRequested, this, &MainWindow::findNext);
+        connect(m_findDialog, &FindDialog::findAllRequested, this, &MainWindow::findAll);
+        connect(m_findDialog, &FindDialog::matchActivated, this, &MainWindow::showMatch);
     }
     m_findDialog->show();
     m_findDialog->raise();
     m_findDialog->activateWindow();
 }
 
-void MainWindow::findNext() {
-    auto tab = currentTab();
-    if (!tab || !m_findDialog) return;
+bool MainWindow::ensureSearch(LogView* view) {
+    const SearchEngine::Query query = m_findDialog->searchQuery();
+    if (view == m_searchView && m_search->isActive() && m_search->query() == query) return true;
 
-    QTextDocument::FindFlags flags;
-    if (m_findDialog->matchCase()) flags |= QTextDocument::FindCaseSensitively;
-    if (!m_findDialog->directionDown()) flags |= QTextDocument::FindBackward;
+    if (m_searchView) {
+        m_searchView->setMatches(nullptr);
+        disconnect(m_searchViewConnection);
+        disconnect(m_searchSourceConnection);
+        m_searchView = nullptr;
+    }
+    m_findPending = false;
 
-    QTextEdit* edit = tab->textEdit();
-    QTextCursor cursor = edit->textCursor();
-    cursor = edit->document()->find(m_findDialog->query(), cursor, flags);
-    if (cursor.isNull()) {
-        cursor = edit->document()->find(m_findDialog->query(), flags);
+    QString error;
+    if (!m_search->start(view->source(), query, &error)) {
+        m_search->cancel();
+        QMessageBox::warning(this, "UART Log Viewer", QString("Invalid regular expression: %1").arg(error));
+        return false;
     }
-    if (cursor.isNull()) {
-        QMessageBox::information(this, "UART Log Viewer", "Text not found.");
+    m_searchView = view;
+    m_searchViewConnection = connect(view, &QObject::destroyed, this, [this]() {
+        m_searchView = nullptr;
+        m_search->cancel();
+    });
+    m_searchSourceConnection = connect(view, &LogView::sourceChanged, m_search, &SearchEngine::cancel);
+    view->setMatches(&m_search->matches());
+    return true;
+}
+
+void MainWindow::findAll() {
+    LogView* view = currentLogView();
+    if (!view || !m_findDialog || m_findDialog->query().isEmpty()) return;
+    ensureSearch(view);
+}
+
+void MainWindow::findNext() {
+    LogView* view = currentLogView();
+    if (!view || !m_findDialog) return;
+    if (m_findDialog->query().isEmpty()) return;
+    if (!ensureSearch(view)) return;
+
+    const QVector<SearchMatch>& matches = m_search->matches();
+    const SearchMatch* begin = matches.constData();
+    const SearchMatch* end = begin + matches.size();
+    const LogView::Position pos = view->highlightPosition();
+
+    qsizetype index = -1;
+    if (m_findDialog->directionDown()) {
+        const SearchMatch* it = std::upper_bound(begin, end, pos, [](const LogView::Position& p, const SearchMatch& m) {
+            return p.line < m.line || (p.line == m.line && p.column < m.column);
+        });
+        if (it != end) index = it - begin;
+        else if (m_search->isCaughtUp() && !matches.isEmpty()) index = 0;
+    } else {
+        const SearchMatch* it = std::lower_bound(begin, end, pos, [](const SearchMatch& m, const LogView::Position& p) {
+            return m.line < p.line || (m.line == p.line && m.column < p.column);
+        });
+        if (pos.line >= 0 && it != begin) index = (it - begin) - 1;
+        else if (m_search->isCaughtUp() && !matches.isEmpty()) index = matches.size() - 1;
+    }
+
+    if (index >= 0) {
+        const SearchMatch& match = matches.at(index);
+        view->setHighlight(match.line, match.column, match.length);
+        return;
+    }
+    if (!m_search->isCaughtUp()) {
+        m_findPending = true;
+        m_findDialog->setStatus("Searching...");
         return;
     }
 
-    edit->setTextCursor(cursor);
-    highlightMatch(edit, cursor);
+    QMessageBox::information(this, "UART Log Viewer", "Text not found.");
 }
 
-void MainWindow::highlightMatch(QTextEdit* textEdit, const QTextCursor& cursor) {
-    QTextEdit::ExtraSelection sel;
-    sel.cursor = cursor;
-    sel.format.setBackground(QColor("#ffd966"));
+void MainWindow::showMatch(qsizetype index) {
+    if (!m_searchView || index < 0 || index >= m_search->matches().size()) return;
+    m_tabs->setCurrentWidget(m_searchView->parentWidget());
+    const SearchMatch& match = m_search->matches().at(index);
+    m_searchView->setHighlight(match.line, match.column, match.length);
+}
 
-    QList<QTextEdit::ExtraSelection> selections;
-    selections << sel;
-    textEdit->setExtraSelections(selections);
+void MainWindow::searchUpdated() {
+    if (m_searchView) m_searchView->matchesChanged();
+    if (!m_findPending) return;
+    if (!m_search->matches().isEmpty() || m_search->isCaughtUp()) {
+        m_findPending = false;
+        findNext();
+    }
 }
 
-SerialTab* MainWindow::currentTab() const {
-    return qobject_cast<SerialTab*>(m_tabs->currentWidget());
+LogView* MainWindow::currentLogView() const {
+    if (auto tab = currentTab()) return tab->logView();
+    if (auto fileTab = qobject_cast<LogFileTab*>(m_tabs->currentWidget())) return fileTab->logView();
+    if (auto timelineTab = qobject_cast<TimelineTab*>(m_tabs->currentWidget())) return timelineTab->logView();
+    return nullptr;
 }
 
 void MainWindow::setThemeDark() {
@@ -4,9 +4,15 @@
 #include <QTabWidget>
 #include <QTimeZone>
 #include <QAction>
+#include <QActionGroup>
 
 #include "serialtab.h"
 #include "finddialog.h"
+#include "logfiletab.h"
+#include "timelinetab.h"
+#include "linehighlighter.h"
+#include "logexporter.h"
+#include "metricsexporter.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -15,20 +21,33 @@ public:
 
 private slots:
     void newTab();
+    void openLog();
+    void openTimeline();
     void refreshPorts();
     void saveLogs();
     void toggleTimestamp(bool enabled);
     void selectTimezone();
+    void selectLogOptions();
+    void selectMemoryBudget();
+    void selectHighlightRules();
+    void exportMetricsToFile();
+    void exportMetricsToSocket();
     void openFind();
     void findNext();
+    void findAll();
+    void showMatch(qsizetype index);
+    void searchUpdated();
     void setThemeDark();
     void setThemeLight();
 
 private:
     QStringList availablePorts() const;
     SerialTab* currentTab() const;
+    LogView* currentLogView() const;
+    void insertTab(QWidget* tab, const QString& label);
+    bool ensureSearch(LogView* view);
+    void setTimestampMode(TimestampFormatter::Mode mode);
     void applyTheme(bool dark);
-    void highlightMatch(QTextEdit* textEdit, const QTextCursor& cursor);
     void ensurePlusTab();
     bool isPlusTabIndex(int index) const;
 
@@ -37,6 +56,16 @@ private:
     QAction* m_themeDark;
     QAction* m_themeLight;
     QTimeZone m_timeZone;
+    TimestampFormatter::Mode m_timestampMode = TimestampFormatter::Mode::Absolute;
+    LogWriter::Options m_logOptions;
+    LineHighlighter m_highlighter;
     FindDialog* m_findDialog = nullptr;
+    LogExporter* m_exporter = nullptr;
+    MetricsExporter* m_metricsExporter;
+    SearchEngine* m_search;
+    LogView* m_searchView = nullptr;
+    QMetaObject::Connection m_searchViewConnection;
+    QMetaObject::Connection m_searchSourceConnection;
+    bool m_findPending = false;
     QWidget* m_plusTab = nullptr;
 };
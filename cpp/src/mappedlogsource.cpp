@@ -0,0 +1,145 @@
+#include "mappedlogsource.h"
+
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+static const qint64 kRangeBytes = 32 * 1024 * 1024;
+static const qint64 kReadBytes = 1024 * 1024;
+static const qint64 kCheckpointLines = 64;
+
+MappedLogSource::MappedLogSource(QObject* parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+
+MappedLogSource::~MappedLogSource() {
+    m_cancelled = true;
+    m_pool.waitForDone();
+}
+
+bool MappedLogSource::open(const QString& path, QString* error) {
+    m_path = path;
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    m_size = m_file.size();
+    if (m_size > 0) {
+        m_map = m_file.map(0, m_size);
+        if (!m_map) {
+            if (error) *error = m_file.errorString();
+            return false;
+        }
+    }
+
+    m_checkpoints.append({0, 0});
+    m_rangeCount = int((m_size + kRangeBytes - 1) / kRangeBytes);
+    for (int range = 0; range < m_rangeCount; ++range) {
+        m_pool.start([this, range]() { scanRange(range); });
+    }
+    return true;
+}
+
+// Scans with ordinary reads rather than through the map so that indexing
+// does not leave the whole file resident in this process.
+void MappedLogSource::scanRange(int range) {
+    if (m_cancelled) return;
+
+    const qint64 begin = range * kRangeBytes;
+    const qint64 end = qMin(m_size, begin + kRangeBytes);
+    RangeResult result;
+
+    QFile file(m_path);
+    if (file.open(QIODevice::ReadOnly) && file.seek(begin)) {
+        QByteArray buffer(kReadBytes, Qt::Uninitialized);
+        qint64 pos = begin;
+        while (pos < end && !m_cancelled) {
+            const qint64 got = file.read(buffer.data(), qMin(kReadBytes, end - pos));
+            if (got <= 0) break;
+            const char* data = buffer.constData();
+            const char* p = data;
+            const char* stop = data + got;
+            while (const char* nl = static_cast<const char*>(std::memchr(p, '\n', std::size_t(stop - p)))) {
+                const qint64 offset = pos + (nl - data);
+                if (result.lastNewline >= 0) {
+                    result.longest = qMax(result.longest, offset - result.lastNewline - 1);
+                } else {
+                    result.firstNewline = offset;
+                }
+                if (result.newlines % kCheckpointLines == 0) result.checkpoints.append(offset + 1);
+                result.lastNewline = offset;
+                ++result.newlines;
+                p = nl + 1;
+            }
+            pos += got;
+        }
+    }
+    if (m_cancelled) return;
+
+    QMetaObject::invokeMethod(this, [this, range, result]() { rangeFinished(range, result); }, Qt::QueuedConnection);
+}
+
+// Ranges finish out of order; they are published strictly in file order so
+// that line numbers stay stable while the index grows.
+void MappedLogSource::rangeFinished(int range, const RangeResult& result) {
+    m_pending.insert(range, result);
+
+    bool published = false;
+    while (!m_pending.isEmpty() && m_pending.firstKey() == m_nextRange) {
+        const RangeResult next = m_pending.take(m_nextRange);
+        if (next.firstNewline >= 0) {
+            m_longest = qMax(m_longest, next.firstNewline - m_openLineStart);
+            m_longest = qMax(m_longest, next.longest);
+            for (qsizetype i = 0; i < next.checkpoints.size(); ++i) {
+                m_checkpoints.append({m_newlines + i * kCheckpointLines + 1, next.checkpoints[i]});
+            }
+            m_newlines += next.newlines;
+            m_openLineStart = next.lastNewline + 1;
+        }
+        ++m_nextRange;
+        m_indexedBytes = qMin(m_size, m_nextRange * kRangeBytes);
+        published = true;
+    }
+    if (!published) return;
+
+    if (indexComplete()) m_longest = qMax(m_longest, m_size - m_openLineStart);
+    emit indexProgress(m_indexedBytes, m_size);
+}
+
+qsizetype MappedLogSource::lineCount() const {
+    const bool trailing = indexComplete() && m_openLineStart < m_size;
+    return qsizetype(m_newlines + (trailing ? 1 : 0));
+}
+
+qint64 MappedLogSource::lineStart(qsizetype index) const {
+    auto it = std::upper_bound(m_checkpoints.cbegin(), m_checkpoints.cend(), qint64(index),
+                               [](qint64 line, const Checkpoint& cp) { return line < cp.line; });
+    --it;
+    qint64 line = it->line;
+    qint64 offset = it->offset;
+    if (m_cursorLine >= line && m_cursorLine <= index) {
+        line = m_cursorLine;
+        offset = m_cursorOffset;
+    }
+
+    while (line < index) {
+        const void* nl = std::memchr(m_map + offset, '\n', std::size_t(m_size - offset));
+        if (!nl) break;
+        offset = static_cast<const uchar*>(nl) - m_map + 1;
+        ++line;
+    }
+    m_cursorLine = line;
+    m_cursorOffset = offset;
+    return offset;
+}
+
+QByteArrayView MappedLogSource::line(qsizetype index) const {
+    if (index < 0 || index >= lineCount()) return {};
+    const qint64 start = lineStart(index);
+    const void* nl = std::memchr(m_map + start, '\n', std::size_t(m_size - start));
+    qint64 end = nl ? static_cast<const uchar*>(nl) - m_map : m_size;
+    if (end > start && m_map[end - 1] == '\r') --end;
+    return QByteArrayView(reinterpret_cast<const char*>(m_map + start), end - start);
+}
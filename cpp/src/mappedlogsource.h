@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QFile>
+#include <QMap>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector>
+
+#include <atomic>
+
+#include "linesource.h"
+
+// Plain-text log file shown straight from a read-only memory map. The line
+// index is built in the background: the file is cut into fixed ranges that
+// are scanned in parallel and stitched together in order as they finish.
+// Only every kCheckpointLines-th line start is kept; rows on screen are found
+// by scanning forward from the nearest checkpoint.
+class MappedLogSource : public QObject, public LineSource {
+    Q_OBJECT
+public:
+    explicit MappedLogSource(QObject* parent = nullptr);
+    ~MappedLogSource() override;
+
+    bool open(const QString& path, QString* error);
+
+    qsizetype lineCount() const override;
+    QByteArrayView line(qsizetype index) const override;
+    qsizetype longestLine() const override { return qsizetype(m_longest); }
+
+    qint64 fileSize() const { return m_size; }
+    qint64 indexedBytes() const { return m_indexedBytes; }
+    bool indexComplete() const { return m_indexedBytes == m_size; }
+
+signals:
+    void indexProgress(qint64 indexedBytes, qint64 totalBytes);
+
+private:
+    struct Checkpoint {
+        qint64 line;
+        qint64 offset;
+    };
+
+    struct RangeResult {
+        qint64 newlines = 0;
+        qint64 firstNewline = -1;
+        qint64 lastNewline = -1;
+        qint64 longest = 0;
+        QVector<qint64> checkpoints;
+    };
+
+    void scanRange(int range);
+    void rangeFinished(int range, const RangeResult& result);
+    qint64 lineStart(qsizetype index) const;
+
+    QString m_path;
+    QFile m_file;
+    const uchar* m_map = nullptr;
+    qint64 m_size = 0;
+
+    QThreadPool m_pool;
+    std::atomic<bool> m_cancelled{false};
+    int m_rangeCount = 0;
+    int m_nextRange = 0;
+    QMap<int, RangeResult> m_pending;
+
+    QVector<Checkpoint> m_checkpoints;
+    qint64 m_newlines = 0;
+    qint64 m_openLineStart = 0;
+    qint64 m_indexedBytes = 0;
+    qint64 m_longest = 0;
+
+    mutable qint64 m_cursorLine = 0;
+    mutable qint64 m_cursorOffset = 0;
+};
@@ -0,0 +1,127 @@
+#include "metrics.h"
+
+#include <QMetaEnum>
+#include <QSerialPort>
+
+#include "timestampformatter.h"
+
+static int bucketFor(quint64 value) {
+    int bucket = 0;
+    while (value && bucket < Histogram::kBuckets - 1) {
+        value >>= 1;
+        ++bucket;
+    }
+    return bucket;
+}
+
+void Histogram::record(quint64 value) {
+    m_buckets[std::size_t(bucketFor(value))].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    quint64 max = m_max.load(std::memory_order_relaxed);
+    while (value > max && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    Snapshot s;
+    for (int i = 0; i < kBuckets; ++i) s.buckets[std::size_t(i)] = m_buckets[std::size_t(i)].load(std::memory_order_relaxed);
+    s.count = m_count.load(std::memory_order_relaxed);
+    s.sum = m_sum.load(std::memory_order_relaxed);
+    s.max = m_max.load(std::memory_order_relaxed);
+    s.lifetimeMax = s.max;
+    return s;
+}
+
+Histogram::Snapshot Histogram::Snapshot::since(const Snapshot& earlier) const {
+    Snapshot d;
+    for (int i = 0; i < kBuckets; ++i) d.buckets[std::size_t(i)] = buckets[std::size_t(i)] - earlier.buckets[std::size_t(i)];
+    d.count = count - earlier.count;
+    d.sum = sum - earlier.sum;
+    d.lifetimeMax = lifetimeMax;
+    for (int i = kBuckets - 1; i > 0; --i) {
+        if (d.buckets[std::size_t(i)]) {
+            d.max = qMin(lifetimeMax, (quint64(1) << i) - 1);
+            break;
+        }
+    }
+    return d;
+}
+
+// Reports the upper bound of the bucket holding the p-th percentile.
+quint64 Histogram::Snapshot::percentile(double p) const {
+    if (!count) return 0;
+    const quint64 rank = quint64(p / 100.0 * double(count - 1)) + 1;
+    quint64 seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += buckets[std::size_t(i)];
+        if (seen >= rank) return i == 0 ? 0 : qMin(max, (quint64(1) << i) - 1);
+    }
+    return max;
+}
+
+void TabMetrics::recordRead(quint64 bytes, quint64 lines, quint64 ingestNs) {
+    m_bytes.fetch_add(bytes, std::memory_order_relaxed);
+    m_lines.fetch_add(lines, std::memory_order_relaxed);
+    m_readBytes.record(bytes);
+    m_ingestNs.record(ingestNs);
+}
+
+void TabMetrics::recordSerialError(int error) {
+    m_serialErrors[std::size_t(qBound(0, error, kErrorKinds - 1))].fetch_add(1, std::memory_order_relaxed);
+}
+
+TabMetrics::Snapshot TabMetrics::snapshot() const {
+    Snapshot s;
+    s.takenNs = TimestampFormatter::monotonicNs();
+    s.bytes = m_bytes.load(std::memory_order_relaxed);
+    s.lines = m_lines.load(std::memory_order_relaxed);
+    s.readBytes = m_readBytes.snapshot();
+    s.ingestNs = m_ingestNs.snapshot();
+    s.appendNs = m_appendNs.snapshot();
+    for (int i = 0; i < kErrorKinds; ++i) {
+        s.serialErrors[std::size_t(i)] = m_serialErrors[std::size_t(i)].load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+static QJsonObject histogramJson(const Histogram::Snapshot& h, double scale) {
+    QJsonObject o;
+    o["count"] = qint64(h.count);
+    o["mean"] = h.mean() / scale;
+    o["p50"] = double(h.percentile(50)) / scale;
+    o["p99"] = double(h.percentile(99)) / scale;
+    o["max"] = double(h.max) / scale;
+    o["max_lifetime"] = double(h.lifetimeMax) / scale;
+    return o;
+}
+
+QJsonObject TabMetrics::toJson(const Snapshot& now, const Snapshot& previous) {
+    const double seconds = qMax(1e-3, double(now.takenNs - previous.takenNs) / 1e9);
+    const Histogram::Snapshot reads = now.readBytes.since(previous.readBytes);
+
+    QJsonObject o;
+    o["interval_s"] = seconds;
+    o["bytes_per_s"] = double(now.bytes - previous.bytes) / seconds;
+    o["lines_per_s"] = double(now.lines - previous.lines) / seconds;
+    o["reads_per_s"] = double(reads.count) / seconds;
+    o["read_bytes"] = histogramJson(reads, 1.0);
+    o["ingest_us"] = histogramJson(now.ingestNs.since(previous.ingestNs), 1000.0);
+    o["append_us"] = histogramJson(now.appendNs.since(previous.appendNs), 1000.0);
+    o["dropped_bytes"] = qint64(now.droppedBytes);
+    if (now.logQueuedBytes >= 0) {
+        o["log_queue_bytes"] = now.logQueuedBytes;
+        o["log_write_last_us"] = now.logLastWriteUs;
+        o["log_write_max_us"] = now.logMaxWriteUs;
+    }
+
+    const QMetaEnum errorEnum = QMetaEnum::fromType<QSerialPort::SerialPortError>();
+    QJsonObject errors;
+    for (int i = 1; i < kErrorKinds; ++i) {
+        if (!now.serialErrors[std::size_t(i)]) continue;
+        const char* name = errorEnum.valueToKey(i);
+        errors[name ? QString::fromLatin1(name) : QString::number(i)] = qint64(now.serialErrors[std::size_t(i)]);
+    }
+    o["serial_errors"] = errors;
+    return o;
+}
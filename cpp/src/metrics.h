@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QJsonObject>
+
+#include <array>
+#include <atomic>
+
+// Power-of-two bucketed histogram. One thread records, any thread can take a
+// snapshot; all counters are relaxed atomics, so recording never locks.
+class Histogram {
+public:
+    static const int kBuckets = 40;
+
+    struct Snapshot {
+        std::array<quint64, kBuckets> buckets{};
+        quint64 count = 0;
+        quint64 sum = 0;
+        // Largest value recorded. In an interval from since() it is bounded
+        // by the highest bucket the interval hit, as the recorder keeps no
+        // per-interval maximum; lifetimeMax stays the all-time figure.
+        quint64 max = 0;
+        quint64 lifetimeMax = 0;
+
+        Snapshot since(const Snapshot& earlier) const;
+        quint64 percentile(double p) const;
+        double mean() const { return count ? double(sum) / double(count) : 0.0; }
+    };
+
+    void record(quint64 value);
+    Snapshot snapshot() const;
+
+private:
+    std::array<std::atomic<quint64>, kBuckets> m_buckets{};
+    std::atomic<quint64> m_count{0};
+    std::atomic<quint64> m_sum{0};
+    std::atomic<quint64> m_max{0};
+};
+
+// Hot-path counters for one serial tab. Read-side counters are recorded by
+// the reader thread, append timing by the GUI thread. Recording sites check
+// enabled() first, so a tab nobody is watching pays one relaxed load per
+// batch. Serial errors are always counted; they are rare.
+class TabMetrics {
+public:
+    static const int kErrorKinds = 16;
+
+    struct Snapshot {
+        qint64 takenNs = 0;
+        quint64 bytes = 0;
+        quint64 lines = 0;
+        Histogram::Snapshot readBytes;
+        Histogram::Snapshot ingestNs;
+        Histogram::Snapshot appendNs;
+        std::array<quint64, kErrorKinds> serialErrors{};
+        quint64 droppedBytes = 0;
+        qint64 logQueuedBytes = -1;
+        qint64 logLastWriteUs = 0;
+        qint64 logMaxWriteUs = 0;
+    };
+
+    void setEnabled(bool enabled) { m_enabled.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void recordRead(quint64 bytes, quint64 lines, quint64 ingestNs);
+    void recordAppend(quint64 ns) { m_appendNs.record(ns); }
+    void recordSerialError(int error);
+
+    Snapshot snapshot() const;
+
+    // One metrics record covering the interval between two snapshots.
+    static QJsonObject toJson(const Snapshot& now, const Snapshot& previous);
+
+private:
+    std::atomic<bool> m_enabled{false};
+    std::atomic<quint64> m_bytes{0};
+    std::atomic<quint64> m_lines{0};
+    Histogram m_readBytes;
+    Histogram m_ingestNs;
+    Histogram m_appendNs;
+    std::array<std::atomic<quint64>, kErrorKinds> m_serialErrors{};
+};
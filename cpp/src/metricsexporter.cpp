@@ -0,0 +1,98 @@
+#include "metricsexporter.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+
+#include "serialtab.h"
+
+static const int kExportIntervalMs = 1000;
+static const qint64 kMaxSocketBacklog = 1024 * 1024;
+
+MetricsExporter::MetricsExporter(QTabWidget* tabs, QObject* parent)
+    : QObject(parent), m_tabs(tabs) {
+    m_timer = new QTimer(this);
+    m_timer->setInterval(kExportIntervalMs);
+    connect(m_timer, &QTimer::timeout, this, &MetricsExporter::tick);
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::startFile(const QString& path, QString* error) {
+    stop();
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    m_timer->start();
+    return true;
+}
+
+void MetricsExporter::startSocket(const QString& serverName) {
+    stop();
+    m_serverName = serverName;
+    m_socket = new QLocalSocket(this);
+    m_socket->connectToServer(serverName, QIODevice::WriteOnly);
+    m_timer->start();
+}
+
+void MetricsExporter::stop() {
+    m_timer->stop();
+    if (m_file.isOpen()) m_file.close();
+    if (m_socket) {
+        m_socket->abort();
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+    for (const QPointer<SerialTab>& tab : m_exported) {
+        if (tab) tab->setMetricsExported(false);
+    }
+    m_exported.clear();
+    m_previous.clear();
+}
+
+void MetricsExporter::tick() {
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QHash<SerialTab*, TabMetrics::Snapshot> current;
+    for (int i = 0; i < m_tabs->count(); ++i) {
+        auto tab = qobject_cast<SerialTab*>(m_tabs->widget(i));
+        if (!tab) continue;
+
+        const TabMetrics::Snapshot snapshot = tab->metricsSnapshot();
+        current.insert(tab, snapshot);
+        auto previous = m_previous.constFind(tab);
+        if (previous == m_previous.constEnd()) {
+            // First sighting: start collecting and report from the next tick.
+            tab->setMetricsExported(true);
+            m_exported.append(tab);
+            continue;
+        }
+
+        QJsonObject record = TabMetrics::toJson(snapshot, previous.value());
+        record["ts"] = now;
+        record["port"] = tab->portName();
+        record["connected"] = tab->isConnected();
+        write(QJsonDocument(record).toJson(QJsonDocument::Compact) + '\n');
+    }
+    m_previous = current;
+}
+
+// Records are dropped while the socket is down rather than buffered, so a
+// missing collector never grows memory; the connection is retried each tick.
+void MetricsExporter::write(const QByteArray& line) {
+    if (m_file.isOpen()) {
+        m_file.write(line);
+        m_file.flush();
+        return;
+    }
+    if (!m_socket) return;
+    if (m_socket->state() == QLocalSocket::UnconnectedState) {
+        m_socket->connectToServer(m_serverName, QIODevice::WriteOnly);
+        return;
+    }
+    if (m_socket->state() == QLocalSocket::ConnectedState && m_socket->bytesToWrite() < kMaxSocketBacklog) {
+        m_socket->write(line);
+    }
+}
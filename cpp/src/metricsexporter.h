@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QFile>
+#include <QHash>
+#include <QLocalSocket>
+#include <QObject>
+#include <QPointer>
+#include <QTabWidget>
+#include <QTimer>
+
+#include "metrics.h"
+
+class SerialTab;
+
+// Periodically writes one JSON object per serial tab, one per line, to a
+// file or a local socket (a Unix domain socket or a Windows named pipe).
+// Tabs only collect metrics while an export or their stats panel is active.
+class MetricsExporter : public QObject {
+    Q_OBJECT
+public:
+    explicit MetricsExporter(QTabWidget* tabs, QObject* parent = nullptr);
+    ~MetricsExporter() override;
+
+    bool startFile(const QString& path, QString* error);
+    void startSocket(const QString& serverName);
+    void stop();
+    bool isActive() const { return m_timer->isActive(); }
+
+private:
+    void tick();
+    void write(const QByteArray& line);
+
+    QTabWidget* m_tabs;
+    QTimer* m_timer;
+    QFile m_file;
+    QLocalSocket* m_socket = nullptr;
+    QString m_serverName;
+    QHash<SerialTab*, TabMetrics::Snapshot> m_previous;
+    QList<QPointer<SerialTab>> m_exported;
+};
@@ -0,0 +1,127 @@
+#include "patternmatcher.h"
+
+#include <deque>
+
+static bool isAscii(const QString& text) {
+    for (QChar c : text) {
+        if (c.unicode() >= 0x80) return false;
+    }
+    return true;
+}
+
+bool PatternMatcher::compile(const QStringList& patterns, bool regex, bool matchCase, QString* error) {
+    m_mode = Mode::Empty;
+    m_next.clear();
+    m_accept.clear();
+    m_regex = QRegularExpression();
+
+    QStringList active;
+    for (const QString& pattern : patterns) {
+        if (!pattern.isEmpty()) active.append(pattern);
+    }
+    if (active.isEmpty()) return true;
+
+    bool literal = !regex;
+    if (literal && !matchCase) {
+        for (const QString& pattern : active) {
+            if (!isAscii(pattern)) literal = false;
+        }
+    }
+
+    if (literal) {
+        QList<QByteArray> bytes;
+        for (const QString& pattern : active) bytes.append(matchCase ? pattern.toUtf8() : pattern.toLower().toUtf8());
+        buildAutomaton(bytes, !matchCase);
+        m_mode = Mode::Automaton;
+        return true;
+    }
+
+    QStringList parts;
+    for (const QString& pattern : active) {
+        parts.append(QString("(?:%1)").arg(regex ? pattern : QRegularExpression::escape(pattern)));
+    }
+    m_regex.setPattern(parts.join('|'));
+    if (!matchCase) m_regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+    if (!m_regex.isValid()) {
+        if (error) *error = m_regex.errorString();
+        m_regex = QRegularExpression();
+        return false;
+    }
+    m_regex.optimize();
+    m_mode = Mode::Regex;
+    return true;
+}
+
+// Builds the full DFA: every state has all 256 transitions filled in from
+// its failure link, so matching is one table lookup per byte.
+void PatternMatcher::buildAutomaton(const QList<QByteArray>& patterns, bool foldCase) {
+    m_next.assign(256, -1);
+    m_accept.assign(1, 0);
+
+    for (const QByteArray& pattern : patterns) {
+        qint32 state = 0;
+        for (char c : pattern) {
+            const std::size_t slot = std::size_t(state) * 256 + uchar(c);
+            if (m_next[slot] < 0) {
+                m_next[slot] = qint32(m_accept.size());
+                m_next.resize(m_next.size() + 256, -1);
+                m_accept.push_back(0);
+            }
+            state = m_next[slot];
+        }
+        m_accept[std::size_t(state)] = 1;
+    }
+
+    std::vector<qint32> fail(m_accept.size(), 0);
+    std::deque<qint32> queue;
+    for (int c = 0; c < 256; ++c) {
+        qint32& target = m_next[std::size_t(c)];
+        if (target < 0) {
+            target = 0;
+        } else {
+            queue.push_back(target);
+        }
+    }
+    while (!queue.empty()) {
+        const qint32 state = queue.front();
+        queue.pop_front();
+        for (int c = 0; c < 256; ++c) {
+            qint32& target = m_next[std::size_t(state) * 256 + std::size_t(c)];
+            const qint32 fallback = m_next[std::size_t(fail[std::size_t(state)]) * 256 + std::size_t(c)];
+            if (target < 0) {
+                target = fallback;
+            } else {
+                fail[std::size_t(target)] = fallback;
+                m_accept[std::size_t(target)] |= m_accept[std::size_t(fallback)];
+                queue.push_back(target);
+            }
+        }
+    }
+
+    if (foldCase) {
+        for (std::size_t state = 0; state < m_accept.size(); ++state) {
+            qint32* row = m_next.data() + state * 256;
+            for (int c = 'A'; c <= 'Z'; ++c) row[c] = row[c + ('a' - 'A')];
+        }
+    }
+}
+
+bool PatternMatcher::matches(QByteArrayView line) const {
+    switch (m_mode) {
+    case Mode::Empty:
+        return false;
+    case Mode::Automaton: {
+        const qint32* next = m_next.data();
+        const quint8* accept = m_accept.data();
+        qint32 state = 0;
+        for (char c : line) {
+            state = next[std::size_t(state) * 256 + uchar(c)];
+            if (accept[std::size_t(state)]) return true;
+        }
+        return false;
+    }
+    case Mode::Regex:
+        return m_regex.match(QString::fromUtf8(line)).hasMatch();
+    }
+    return false;
+}
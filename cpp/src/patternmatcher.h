@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include <vector>
+
+// Tests a line against a set of patterns in a single pass. Literal sets are
+// compiled to an Aho-Corasick automaton over bytes (ASCII case folding is
+// baked into the transition table); regex sets, and case-insensitive sets
+// with non-ASCII text, become one alternation regex. Matching is const and
+// safe to share between threads.
+class PatternMatcher {
+public:
+    bool compile(const QStringList& patterns, bool regex, bool matchCase, QString* error);
+
+    bool isEmpty() const { return m_mode == Mode::Empty; }
+    bool matches(QByteArrayView line) const;
+
+private:
+    enum class Mode { Empty, Automaton, Regex };
+
+    void buildAutomaton(const QList<QByteArray>& patterns, bool foldCase);
+
+    Mode m_mode = Mode::Empty;
+    std::vector<qint32> m_next;
+    std::vector<quint8> m_accept;
+    QRegularExpression m_regex;
+};
@@ -0,0 +1,201 @@
+#include "portmonitor.h"
+
+#include <QCoreApplication>
+#include <QSerialPortInfo>
+#include <QSocketNotifier>
+#include <QTimer>
+
+#ifdef Q_OS_LINUX
+#include <linux/netlink.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+#include "timestampformatter.h"
+
+static const int kPollIntervalMs = 1000;
+// Several tty events arrive for one plug; they are folded into one scan.
+static const int kRescanDelayMs = 50;
+
+static bool isOffered(const QString& name) {
+#ifdef Q_OS_WIN
+    Q_UNUSED(name);
+    return true;
+#elif defined(Q_OS_MAC)
+    return name.startsWith("cu.") || name.startsWith("tty.");
+#else
+    return name.startsWith("ttyUSB") || name.startsWith("ttyACM");
+#endif
+}
+
+// Lives as long as the application object, like SerialIoService.
+PortMonitor* PortMonitor::instance() {
+    static PortMonitor* monitor = new PortMonitor(QCoreApplication::instance());
+    return monitor;
+}
+
+PortMonitor::PortMonitor(QObject* parent) : QObject(parent) {
+#ifdef Q_OS_LINUX
+    m_fd = ::socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC | SOCK_NONBLOCK, NETLINK_KOBJECT_UEVENT);
+    if (m_fd >= 0) {
+        sockaddr_nl addr{};
+        addr.nl_family = AF_NETLINK;
+        addr.nl_groups = 1; // kernel uevents, before udev has processed them
+        const int bufferSize = 1024 * 1024;
+        ::setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &bufferSize, sizeof(bufferSize));
+        if (::bind(m_fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(m_fd);
+            m_fd = -1;
+        }
+    }
+#endif
+    m_hotplug = m_fd >= 0;
+
+    m_context = new QObject;
+    m_context->moveToThread(&m_thread);
+    m_thread.setObjectName("port-monitor");
+    m_thread.start();
+    QMetaObject::invokeMethod(m_context, [this]() { startWatching(); });
+}
+
+PortMonitor::~PortMonitor() {
+    QMetaObject::invokeMethod(m_context, [this]() { stopWatching(); }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+    delete m_context;
+}
+
+QStringList PortMonitor::ports() const {
+    QMutexLocker lock(&m_mutex);
+    while (!m_hasScanned) m_scanned.wait(&m_mutex);
+    return m_ports;
+}
+
+void PortMonitor::refresh() {
+    QMetaObject::invokeMethod(m_context, [this]() { rescan(TimestampFormatter::monotonicNs()); });
+}
+
+void PortMonitor::startWatching() {
+    m_rescanTimer = new QTimer(m_context);
+    m_rescanTimer->setSingleShot(true);
+    m_rescanTimer->setInterval(kRescanDelayMs);
+    connect(m_rescanTimer, &QTimer::timeout, m_context, [this]() { rescan(m_eventNs); });
+
+    if (m_hotplug) {
+        m_notifier = new QSocketNotifier(qintptr(m_fd), QSocketNotifier::Read, m_context);
+        connect(m_notifier, &QSocketNotifier::activated, m_context, [this]() { readEvents(); });
+    } else {
+        m_pollTimer = new QTimer(m_context);
+        m_pollTimer->setInterval(kPollIntervalMs);
+        connect(m_pollTimer, &QTimer::timeout, m_context, [this]() { rescan(TimestampFormatter::monotonicNs()); });
+        m_pollTimer->start();
+    }
+    rescan(TimestampFormatter::monotonicNs());
+}
+
+void PortMonitor::stopWatching() {
+    delete m_notifier;
+    delete m_pollTimer;
+    delete m_rescanTimer;
+    m_notifier = nullptr;
+    m_pollTimer = nullptr;
+    m_rescanTimer = nullptr;
+#ifdef Q_OS_LINUX
+    if (m_fd >= 0) ::close(m_fd);
+    m_fd = -1;
+#endif
+}
+
+// A kernel uevent is "action@devpath" followed by KEY=value fields, all NUL
+// separated. A tty add or remove is announced straight away, so a reader
+// waiting to reconnect does not wait for the enumeration that follows.
+void PortMonitor::readEvents() {
+#ifdef Q_OS_LINUX
+    char buffer[8192];
+    bool rescanNeeded = false;
+    for (;;) {
+        sockaddr_nl from{};
+        iovec iov{buffer, sizeof(buffer)};
+        msghdr msg{};
+        msg.msg_name = &from;
+        msg.msg_namelen = sizeof(from);
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        const ssize_t n = ::recvmsg(m_fd, &msg, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            // Events were dropped; the scan catches up with them.
+            if (errno == ENOBUFS) {
+                rescanNeeded = true;
+                continue;
+            }
+            break;
+        }
+        if (from.nl_pid != 0) continue;
+
+        const qint64 eventNs = TimestampFormatter::monotonicNs();
+        QByteArrayView action;
+        QByteArrayView subsystem;
+        QByteArrayView devName;
+        const QByteArrayView event(buffer, qsizetype(n));
+        for (qsizetype start = 0; start < event.size();) {
+            qsizetype end = event.indexOf('\0', start);
+            if (end < 0) end = event.size();
+            const QByteArrayView field = event.sliced(start, end - start);
+            if (field.startsWith("ACTION=")) action = field.sliced(7);
+            else if (field.startsWith("SUBSYSTEM=")) subsystem = field.sliced(10);
+            else if (field.startsWith("DEVNAME=")) devName = field.sliced(8);
+            start = end + 1;
+        }
+        if (subsystem != "tty" || devName.isEmpty()) continue;
+
+        const QString name = QString::fromUtf8(devName.sliced(devName.lastIndexOf('/') + 1));
+        if (!isOffered(name)) continue;
+        if (action == "add" && !m_known.contains(name)) {
+            m_known.insert(name);
+            emit portAppeared(name, eventNs);
+        } else if (action == "remove" && m_known.remove(name)) {
+            emit portRemoved(name);
+        }
+        if (!m_rescanTimer->isActive()) m_eventNs = eventNs;
+        rescanNeeded = true;
+    }
+    if (rescanNeeded && !m_rescanTimer->isActive()) m_rescanTimer->start();
+#endif
+}
+
+void PortMonitor::rescan(qint64 eventNs) {
+    QStringList ports;
+    for (const QSerialPortInfo& info : QSerialPortInfo::availablePorts()) {
+        if (isOffered(info.portName())) ports << info.portName();
+    }
+    ports.sort();
+
+    bool first = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        first = !m_hasScanned;
+    }
+    const QSet<QString> found(ports.cbegin(), ports.cend());
+    if (!first) {
+        for (const QString& name : ports) {
+            if (!m_known.contains(name)) emit portAppeared(name, eventNs);
+        }
+        for (const QString& name : std::as_const(m_known)) {
+            if (!found.contains(name)) emit portRemoved(name);
+        }
+    }
+    m_known = found;
+
+    bool changed = false;
+    {
+        QMutexLocker lock(&m_mutex);
+        changed = first || ports != m_ports;
+        m_ports = ports;
+        m_hasScanned = true;
+    }
+    m_scanned.wakeAll();
+    if (changed) emit portsChanged(ports);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QThread>
+#include <QWaitCondition>
+
+class QSocketNotifier;
+class QTimer;
+
+// Keeps the list of serial ports current from a background thread, so
+// nothing on the GUI thread has to enumerate them. On Linux it listens for
+// kernel tty uevents on a netlink socket and re-enumerates when one arrives;
+// elsewhere, or when the socket cannot be opened, it polls. Signals are
+// emitted on the monitor thread, so a reader on an I/O thread hears about a
+// port without the GUI thread in the way. ports() is safe from any thread.
+class PortMonitor : public QObject {
+    Q_OBJECT
+public:
+    static PortMonitor* instance();
+
+    // The cached list, filtered to the ports worth offering and sorted.
+    // Waits for the first scan if it has not finished yet.
+    QStringList ports() const;
+    bool isHotplug() const { return m_hotplug; }
+    // Queues a re-enumeration.
+    void refresh();
+
+signals:
+    void portsChanged(const QStringList& ports);
+    // `eventNs` is the monotonic time the port was first seen, for latency.
+    void portAppeared(const QString& name, qint64 eventNs);
+    void portRemoved(const QString& name);
+
+private:
+    explicit PortMonitor(QObject* parent);
+    ~PortMonitor() override;
+
+    void startWatching();
+    void stopWatching();
+    void readEvents();
+    void rescan(qint64 eventNs);
+
+    QThread m_thread;
+    QObject* m_context;
+    QSocketNotifier* m_notifier = nullptr;
+    QTimer* m_pollTimer = nullptr;
+    QTimer* m_rescanTimer = nullptr;
+    int m_fd = -1;
+    bool m_hotplug = false;
+    qint64 m_eventNs = 0;
+    QSet<QString> m_known;
+
+    mutable QMutex m_mutex;
+    mutable QWaitCondition m_scanned;
+    bool m_hasScanned = false;
+    QStringList m_ports;
+};
@@ -0,0 +1,61 @@
+#include "rawcapture.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+static const char kMagic[4] = {'U', 'L', 'V', 'R'};
+static const quint32 kVersion = 1;
+static const qint64 kFileHeaderSize = 24;
+static const qint64 kRecordHeaderSize = 12;
+
+namespace RawCapture {
+
+bool isRawCapturePath(const QString& path) {
+    return path.endsWith(".ulraw", Qt::CaseInsensitive);
+}
+
+QByteArray fileHeader(qint64 startWallNs, qint64 startMonoNs) {
+    QByteArray out(kFileHeaderSize, Qt::Uninitialized);
+    char* p = out.data();
+    std::memcpy(p, kMagic, 4);
+    qToLittleEndian(kVersion, p + 4);
+    qToLittleEndian(startWallNs, p + 8);
+    qToLittleEndian(startMonoNs, p + 16);
+    return out;
+}
+
+QByteArray recordHeader(qint64 monoNs, quint32 size) {
+    QByteArray out(kRecordHeaderSize, Qt::Uninitialized);
+    qToLittleEndian(monoNs, out.data());
+    qToLittleEndian(size, out.data() + 8);
+    return out;
+}
+
+}
+
+bool RawCaptureReader::open(const QString& path, QString* error) {
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        if (error) *error = m_file.errorString();
+        return false;
+    }
+    const QByteArray header = m_file.read(kFileHeaderSize);
+    if (header.size() != kFileHeaderSize || std::memcmp(header.constData(), kMagic, 4) != 0
+        || qFromLittleEndian<quint32>(header.constData() + 4) != kVersion) {
+        if (error) *error = "Not a raw UART capture.";
+        return false;
+    }
+    m_startWallNs = qFromLittleEndian<qint64>(header.constData() + 8);
+    m_startMonoNs = qFromLittleEndian<qint64>(header.constData() + 16);
+    return true;
+}
+
+bool RawCaptureReader::next(RawCapture::Chunk* chunk) {
+    char header[kRecordHeaderSize];
+    if (m_file.read(header, kRecordHeaderSize) != kRecordHeaderSize) return false;
+    chunk->monoNs = qFromLittleEndian<qint64>(header);
+    const quint32 size = qFromLittleEndian<quint32>(header + 8);
+    chunk->data = m_file.read(size);
+    return chunk->data.size() == qsizetype(size);
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+
+// Raw capture format (.ulraw): every readAll() chunk exactly as it came off
+// the port, tagged with its monotonic arrival time in nanoseconds.
+//
+//   "ULVR" u32 version, i64 startWallNs, i64 startMonoNs
+//   { i64 monoNs, u32 size, data[size] } ...
+//
+// Integers are little-endian. Records are only ever appended, so a capture
+// cut short by a crash is readable up to its last complete record.
+namespace RawCapture {
+
+bool isRawCapturePath(const QString& path);
+QByteArray fileHeader(qint64 startWallNs, qint64 startMonoNs);
+QByteArray recordHeader(qint64 monoNs, quint32 size);
+
+struct Chunk {
+    qint64 monoNs = 0;
+    QByteArray data;
+};
+
+}
+
+class RawCaptureReader {
+public:
+    bool open(const QString& path, QString* error);
+    bool next(RawCapture::Chunk* chunk);
+
+    qint64 startWallNs() const { return m_startWallNs; }
+    qint64 startMonoNs() const { return m_startMonoNs; }
+
+private:
+    QFile m_file;
+    qint64 m_startWallNs = 0;
+    qint64 m_startMonoNs = 0;
+};
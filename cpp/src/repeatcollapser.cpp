@@ -0,0 +1,60 @@
+#include "repeatcollapser.h"
+
+#include <array>
+
+static const quint64 kHashBase = 0x100000001b3ULL;
+
+// Byte values as stored and hashed in IgnoreDigits mode.
+static const std::array<uchar, 256> kDigitMask = []() {
+    std::array<uchar, 256> table{};
+    for (int c = 0; c < 256; ++c) table[std::size_t(c)] = c >= '0' && c <= '9' ? uchar('0') : uchar(c);
+    return table;
+}();
+
+void RepeatCollapser::setMode(Mode mode) {
+    if (mode == m_mode) return;
+    m_mode = mode;
+    reset();
+}
+
+void RepeatCollapser::reset() {
+    m_current.clear();
+    m_hash = 0;
+    m_previous.clear();
+    m_prevHash = 0;
+    m_hasPrevious = false;
+    m_repeats = 0;
+}
+
+void RepeatCollapser::feed(QByteArrayView text) {
+    const qsizetype start = m_current.size();
+    m_current.append(text.data(), text.size());
+    uchar* p = reinterpret_cast<uchar*>(m_current.data()) + start;
+    uchar* end = p + text.size();
+    quint64 hash = m_hash;
+    if (m_mode == Mode::IgnoreDigits) {
+        for (; p < end; ++p) {
+            *p = kDigitMask[*p];
+            hash = hash * kHashBase + *p;
+        }
+    } else {
+        for (; p < end; ++p) hash = hash * kHashBase + *p;
+    }
+    m_hash = hash;
+}
+
+bool RepeatCollapser::endLine() {
+    const bool repeat = m_mode != Mode::Off && m_hasPrevious && m_hash == m_prevHash && m_current == m_previous;
+    if (repeat) {
+        ++m_repeats;
+    } else {
+        // The old previous line's buffer is reused for the next line.
+        m_previous.swap(m_current);
+        m_prevHash = m_hash;
+        m_hasPrevious = true;
+        m_repeats = 0;
+    }
+    m_current.clear();
+    m_hash = 0;
+    return repeat;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+
+// Tells whether a line repeats the one before it. The current line and the
+// previous distinct one are kept, with a 64-bit polynomial hash rolled
+// forward as bytes arrive; the hash and length reject almost every new line
+// at once and only a match is confirmed by comparing the bytes. With
+// IgnoreDigits every digit is stored and hashed as '0', so lines that differ
+// only in counters or addresses still repeat.
+class RepeatCollapser {
+public:
+    enum class Mode { Off, Exact, IgnoreDigits };
+
+    void setMode(Mode mode);
+    Mode mode() const { return m_mode; }
+    // Forgets the previous line and the current one.
+    void reset();
+
+    // Adds the next part of the current line.
+    void feed(QByteArrayView text);
+    // Ends the current line; returns true when it repeats the previous one.
+    bool endLine();
+    // Repeats of the last distinct line so far.
+    quint64 repeats() const { return m_repeats; }
+
+private:
+    Mode m_mode = Mode::Off;
+    QByteArray m_current;
+    quint64 m_hash = 0;
+    QByteArray m_previous;
+    quint64 m_prevHash = 0;
+    bool m_hasPrevious = false;
+    quint64 m_repeats = 0;
+};
+
+// The distinct line `line` (counted from the first line the reader wrote to
+// its ring) has been repeated `repeats` times, the last at `lastNs` (wall
+// clock). Counts are totals, so a lost update is fixed by the next one.
+struct RepeatEvent {
+    qint64 line;
+    quint64 repeats;
+    qint64 lastNs;
+};
@@ -0,0 +1,275 @@
+#include "searchengine.h"
+
+#include <QThread>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SEARCH_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+static const qsizetype kBatchBytes = 1024 * 1024;
+static const qsizetype kBatchLines = 16384;
+static const qsizetype kFeedBudgetBytes = 16 * 1024 * 1024;
+static const int kPollIntervalMs = 200;
+
+static inline unsigned countTrailingZeros(std::uint32_t mask) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return unsigned(index);
+#else
+    return unsigned(__builtin_ctz(mask));
+#endif
+}
+
+static const char* findBytesScalar(const char* p, std::size_t n, const char* needle, std::size_t k) {
+    const char* end = p + n;
+    while (std::size_t(end - p) >= k) {
+        const char* hit = static_cast<const char*>(std::memchr(p, needle[0], std::size_t(end - p) - k + 1));
+        if (!hit) return nullptr;
+        if (std::memcmp(hit + 1, needle + 1, k - 1) == 0) return hit;
+        p = hit + 1;
+    }
+    return nullptr;
+}
+
+// Compares the first and last needle bytes against 16 candidate positions at
+// once and only runs memcmp where both agree.
+static const char* findBytes(const char* p, std::size_t n, const char* needle, std::size_t k) {
+    if (k == 0 || n < k) return nullptr;
+    if (k == 1) return static_cast<const char*>(std::memchr(p, needle[0], n));
+#ifdef SEARCH_HAVE_SSE2
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[k - 1]);
+    std::size_t i = 0;
+    for (; i + k - 1 + 16 <= n; i += 16) {
+        const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+        const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + k - 1));
+        std::uint32_t mask = std::uint32_t(_mm_movemask_epi8(
+            _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))));
+        while (mask) {
+            const unsigned bit = countTrailingZeros(mask);
+            if (std::memcmp(p + i + bit + 1, needle + 1, k - 2) == 0) return p + i + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findBytesScalar(p + i, n - i, needle, k);
+#else
+    return findBytesScalar(p, n, needle, k);
+#endif
+}
+
+static bool isAscii(const QByteArray& text) {
+    for (char c : text) {
+        if (uchar(c) >= 0x80) return false;
+    }
+    return true;
+}
+
+static void foldAscii(char* p, qsizetype n) {
+    for (qsizetype i = 0; i < n; ++i) {
+        const char c = p[i];
+        if (c >= 'A' && c <= 'Z') p[i] = char(c + ('a' - 'A'));
+    }
+}
+
+SearchEngine::SearchEngine(QObject* parent) : QObject(parent) {
+    m_pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+    m_maxInFlight = 2 * m_pool.maxThreadCount();
+
+    m_feedTimer = new QTimer(this);
+    m_feedTimer->setSingleShot(true);
+    connect(m_feedTimer, &QTimer::timeout, this, &SearchEngine::feed);
+}
+
+SearchEngine::~SearchEngine() {
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+bool SearchEngine::start(const LineSource* source, const Query& query, QString* error) {
+    Matcher matcher;
+    if (query.regex) {
+        matcher.mode = Matcher::Mode::Regex;
+        matcher.regex.setPattern(query.text);
+        if (!query.matchCase) matcher.regex.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+        if (!matcher.regex.isValid()) {
+            if (error) *error = matcher.regex.errorString();
+            return false;
+        }
+        matcher.regex.optimize();
+    } else {
+        matcher.needle = query.text.toUtf8();
+        matcher.text = query.text;
+        if (query.matchCase) {
+            matcher.mode = Matcher::Mode::Bytes;
+        } else if (isAscii(matcher.needle)) {
+            matcher.mode = Matcher::Mode::Bytes;
+            matcher.foldAscii = true;
+            foldAscii(matcher.needle.data(), matcher.needle.size());
+        } else {
+            matcher.mode = Matcher::Mode::Text;
+        }
+    }
+
+    reset();
+    m_source = source;
+    m_query = query;
+    m_matcher = matcher;
+    emit cleared();
+    m_feedTimer->start(0);
+    return true;
+}
+
+void SearchEngine::cancel() {
+    if (!m_source) return;
+    reset();
+    emit cleared();
+}
+
+void SearchEngine::reset() {
+    ++m_generation;
+    m_pool.clear();
+    m_feedTimer->stop();
+    m_source = nullptr;
+    m_nextSeq = 0;
+    m_publishSeq = 0;
+    m_inFlight = 0;
+    m_nextLine = 0;
+    m_availableLines = 0;
+    m_pending.clear();
+    m_matches.clear();
+    m_total = 0;
+    m_searchedLines = 0;
+}
+
+bool SearchEngine::isCaughtUp() const {
+    return m_source && m_inFlight == 0 && m_searchedLines >= m_availableLines;
+}
+
+void SearchEngine::feed() {
+    if (!m_source) return;
+
+    const qsizetype available = m_source->completeLineCount();
+    if (available < m_nextLine) {
+        start(m_source, m_query, nullptr);
+        return;
+    }
+    m_availableLines = available;
+
+    qsizetype budget = kFeedBudgetBytes;
+    while (m_inFlight < m_maxInFlight && m_nextLine < available && budget > 0) {
+        Batch batch = takeBatch(available);
+        budget -= batch.text.size();
+        ++m_inFlight;
+        const quint64 generation = m_generation;
+        const Matcher matcher = m_matcher;
+        m_pool.start([this, generation, batch = std::move(batch), matcher]() {
+            const Result result = scan(batch, matcher);
+            const int seq = batch.seq;
+            QMetaObject::invokeMethod(this, [this, generation, seq, result]() {
+                batchFinished(generation, seq, result);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    if (m_inFlight < m_maxInFlight) m_feedTimer->start(m_nextLine < available ? 0 : kPollIntervalMs);
+    emit progress(m_searchedLines, m_availableLines);
+}
+
+SearchEngine::Batch SearchEngine::takeBatch(qsizetype available) {
+    Batch batch;
+    batch.seq = m_nextSeq++;
+    batch.firstLine = m_nextLine;
+    batch.text.reserve(kBatchBytes + 4096);
+    while (m_nextLine < available && batch.starts.size() < kBatchLines && batch.text.size() < kBatchBytes) {
+        batch.starts.append(batch.text.size());
+        batch.text.append(m_source->line(m_nextLine));
+        batch.text.append('\n');
+        ++m_nextLine;
+    }
+    return batch;
+}
+
+SearchEngine::Result SearchEngine::scan(const Batch& batch, const Matcher& matcher) {
+    Result result;
+    result.lineCount = batch.starts.size();
+
+    auto record = [&](qsizetype line, qsizetype column, qsizetype length) {
+        ++result.total;
+        result.matches.append({batch.firstLine + line, column, length});
+    };
+
+    if (matcher.mode == Matcher::Mode::Bytes) {
+        if (matcher.needle.isEmpty()) return result;
+        QByteArray folded;
+        const char* text = batch.text.constData();
+        if (matcher.foldAscii) {
+            folded = batch.text;
+            foldAscii(folded.data(), folded.size());
+            text = folded.constData();
+        }
+        const std::size_t size = std::size_t(batch.text.size());
+        const std::size_t k = std::size_t(matcher.needle.size());
+        const qsizetype length = matcher.text.size();
+        std::size_t pos = 0;
+        while (const char* hit = findBytes(text + pos, size - pos, matcher.needle.constData(), k)) {
+            const qsizetype offset = hit - text;
+            const qsizetype line = qsizetype(std::upper_bound(batch.starts.cbegin(), batch.starts.cend(), offset)
+                                             - batch.starts.cbegin()) - 1;
+            const qsizetype start = batch.starts[line];
+            const qsizetype column = QString::fromUtf8(batch.text.constData() + start, offset - start).size();
+            record(line, column, length);
+            pos = std::size_t(offset) + k;
+        }
+        return result;
+    }
+
+    for (qsizetype i = 0; i < batch.starts.size(); ++i) {
+        const qsizetype start = batch.starts[i];
+        const qsizetype end = (i + 1 < batch.starts.size() ? batch.starts[i + 1] : batch.text.size()) - 1;
+        const QString line = QString::fromUtf8(batch.text.constData() + start, end - start);
+        if (matcher.mode == Matcher::Mode::Regex) {
+            auto it = matcher.regex.globalMatch(line);
+            while (it.hasNext()) {
+                const QRegularExpressionMatch match = it.next();
+                if (match.capturedLength() > 0) record(i, match.capturedStart(), match.capturedLength());
+            }
+        } else {
+            qsizetype from = 0;
+            while ((from = line.indexOf(matcher.text, from, Qt::CaseInsensitive)) >= 0) {
+                record(i, from, matcher.text.size());
+                from += matcher.text.size();
+            }
+        }
+    }
+    return result;
+}
+
+// Batches finish out of order; merging them strictly by sequence keeps the
+// match list sorted by line so views can binary-search it.
+void SearchEngine::batchFinished(quint64 generation, int seq, const Result& result) {
+    if (generation != m_generation) return;
+    --m_inFlight;
+    m_pending.insert(seq, result);
+
+    const qsizetype first = m_matches.size();
+    while (!m_pending.isEmpty() && m_pending.firstKey() == m_publishSeq) {
+        const Result next = m_pending.take(m_publishSeq++);
+        m_searchedLines += next.lineCount;
+        m_total += next.total;
+        const qsizetype room = kMaxMatches - m_matches.size();
+        m_matches.append(next.matches.mid(0, qMin(room, next.matches.size())));
+    }
+
+    if (m_matches.size() > first) emit matchesAdded(first, m_matches.size() - first);
+    emit progress(m_searchedLines, m_availableLines);
+    if (!m_feedTimer->isActive()) m_feedTimer->start(0);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <QByteArray>
+#include <QMap>
+#include <QObject>
+#include <QRegularExpression>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+
+#include "linesource.h"
+
+struct SearchMatch {
+    qsizetype line = -1;
+    qsizetype column = 0;
+    qsizetype length = 0;
+};
+
+// Finds every match of a query in a LineSource using a thread pool. The GUI
+// thread copies completed lines out in batches, workers scan them, and
+// results are merged back in line order. Once the backlog is done the engine
+// keeps polling the source so a live port stays searched as lines arrive.
+class SearchEngine : public QObject {
+    Q_OBJECT
+public:
+    struct Query {
+        QString text;
+        bool matchCase = false;
+        bool regex = false;
+
+        bool operator==(const Query& other) const {
+            return text == other.text && matchCase == other.matchCase && regex == other.regex;
+        }
+    };
+
+    explicit SearchEngine(QObject* parent = nullptr);
+    ~SearchEngine() override;
+
+    bool start(const LineSource* source, const Query& query, QString* error);
+    void cancel();
+
+    const LineSource* source() const { return m_source; }
+    Query query() const { return m_query; }
+    bool isActive() const { return m_source != nullptr; }
+    bool isCaughtUp() const;
+
+    // Stored matches are capped at kMaxMatches; totalMatches() keeps counting.
+    const QVector<SearchMatch>& matches() const { return m_matches; }
+    qint64 totalMatches() const { return m_total; }
+    qsizetype searchedLines() const { return m_searchedLines; }
+
+    static const qsizetype kMaxMatches = 1000000;
+
+signals:
+    void cleared();
+    void matchesAdded(qsizetype first, qsizetype count);
+    void progress(qsizetype searchedLines, qsizetype availableLines);
+
+private:
+    struct Batch {
+        int seq = 0;
+        qsizetype firstLine = 0;
+        QByteArray text;
+        QVector<qsizetype> starts;
+    };
+
+    // Bytes searches UTF-8 directly (ASCII-folded for case-insensitive
+    // ASCII queries); Text and Regex decode each line to a QString.
+    struct Matcher {
+        enum class Mode { Bytes, Text, Regex };
+        Mode mode = Mode::Bytes;
+        QByteArray needle;
+        QString text;
+        QRegularExpression regex;
+        bool foldAscii = false;
+    };
+
+    struct Result {
+        qsizetype lineCount = 0;
+        qint64 total = 0;
+        QVector<SearchMatch> matches;
+    };
+
+    void feed();
+    Batch takeBatch(qsizetype available);
+    static Result scan(const Batch& batch, const Matcher& matcher);
+    void batchFinished(quint64 generation, int seq, const Result& result);
+    void reset();
+
+    const LineSource* m_source = nullptr;
+    Query m_query;
+    Matcher m_matcher;
+
+    QThreadPool m_pool;
+    QTimer* m_feedTimer;
+    quint64 m_generation = 0;
+    int m_nextSeq = 0;
+    int m_publishSeq = 0;
+    int m_inFlight = 0;
+    int m_maxInFlight = 2;
+    qsizetype m_nextLine = 0;
+    qsizetype m_availableLines = 0;
+    QMap<int, Result> m_pending;
+
+    QVector<SearchMatch> m_matches;
+    qint64 m_total = 0;
+    qsizetype m_searchedLines = 0;
+};
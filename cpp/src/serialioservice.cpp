@@ -0,0 +1,58 @@
+#include "serialioservice.h"
+
+#include <QCoreApplication>
+
+#include <limits>
+
+static const int kDefaultMaxThreads = 4;
+
+// Lives as long as the application object, so every thread is stopped
+// before Qt itself shuts down.
+SerialIoService* SerialIoService::instance() {
+    static SerialIoService* service = new SerialIoService(QCoreApplication::instance());
+    return service;
+}
+
+SerialIoService::SerialIoService(QObject* parent) : QObject(parent) {}
+
+SerialIoService::~SerialIoService() {
+    for (QThread* thread : m_threads) {
+        thread->quit();
+        thread->wait();
+    }
+}
+
+void SerialIoService::setMaxThreads(int count) {
+    m_maxThreads = count;
+}
+
+int SerialIoService::maxThreads() const {
+    if (m_maxThreads > 0) return m_maxThreads;
+    return qBound(1, QThread::idealThreadCount() / 2, kDefaultMaxThreads);
+}
+
+QThread* SerialIoService::acquire() {
+    const int limit = maxThreads();
+    QThread* best = nullptr;
+    int bestLoad = std::numeric_limits<int>::max();
+    for (QThread* thread : m_threads) {
+        const int load = m_load.value(thread);
+        if (load < bestLoad) {
+            best = thread;
+            bestLoad = load;
+        }
+    }
+    if (!best || (bestLoad > 0 && m_threads.size() < limit)) {
+        best = new QThread(this);
+        best->setObjectName(QString("serial-io-%1").arg(m_threads.size()));
+        best->start();
+        m_threads.append(best);
+    }
+    ++m_load[best];
+    return best;
+}
+
+void SerialIoService::release(QThread* thread) {
+    auto it = m_load.find(thread);
+    if (it != m_load.end() && it.value() > 0) --it.value();
+}
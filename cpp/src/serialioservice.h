@@ -0,0 +1,32 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QThread>
+#include <QVector>
+
+// A small, process-wide pool of I/O threads shared by every open port.
+// Each thread runs one event loop that waits on all of its ports' notifiers
+// in a single poll, so adding ports adds file descriptors rather than
+// threads. Ports are placed on the least-loaded thread. GUI thread only.
+class SerialIoService : public QObject {
+    Q_OBJECT
+public:
+    static SerialIoService* instance();
+
+    // Takes effect for threads created after the call; 0 picks a default
+    // from the core count.
+    void setMaxThreads(int count);
+    int maxThreads() const;
+
+    QThread* acquire();
+    void release(QThread* thread);
+
+private:
+    explicit SerialIoService(QObject* parent);
+    ~SerialIoService() override;
+
+    int m_maxThreads = 0;
+    QVector<QThread*> m_threads;
+    QHash<QThread*, int> m_load;
+};
@@ -0,0 +1,557 @@
+#include "serialreader.h"
+
+static const qint64 kReplaySliceNs = 5000000;
+static const std::size_t kReplayRingReserve = 64 * 1024;
+// Chunks are fed in slices no larger than this, so a slice always fits the
+// rings at full speed however large the recorded read was.
+static const qsizetype kReplayChunkSlice = 64 * 1024;
+static const qsizetype kMaxFrameHexBytes = 256;
+static const int kQuickRetryMs = 20;
+static const int kQuickRetries = 50;
+static const int kSlowRetryMs = 1000;
+// A snapshot whose post-trigger lines stop coming (the board has hung) is
+// written with what it has after this long.
+static const int kTriggerPostTimeoutMs = 10000;
+// Live repeat counts go to the GUI at most this often.
+static const int kRepeatReportMs = 100;
+
+SerialReader::SerialReader(SpscRing* ring, QObject* parent)
+    : QObject(parent), m_ring(ring) {
+    m_serial = new QSerialPort(this);
+    connect(m_serial, &QSerialPort::readyRead, this, &SerialReader::onReadyRead);
+    connect(m_serial, &QSerialPort::errorOccurred, this, &SerialReader::onErrorOccurred);
+
+    m_transmit = new TransmitEngine(m_serial, this);
+    connect(m_transmit, &TransmitEngine::progress, this, &SerialReader::transmitProgress);
+    connect(m_transmit, &TransmitEngine::finished, this, &SerialReader::transmitFinished);
+
+    m_reconnectTimer = new QTimer(this);
+    m_reconnectTimer->setSingleShot(true);
+    connect(m_reconnectTimer, &QTimer::timeout, this, &SerialReader::tryReconnect);
+
+    m_triggerTimer = new QTimer(this);
+    m_triggerTimer->setSingleShot(true);
+    m_triggerTimer->setInterval(kTriggerPostTimeoutMs);
+    connect(m_triggerTimer, &QTimer::timeout, this, &SerialReader::triggerTimedOut);
+
+    m_repeatTimer = new QTimer(this);
+    m_repeatTimer->setSingleShot(true);
+    m_repeatTimer->setInterval(kRepeatReportMs);
+    connect(m_repeatTimer, &QTimer::timeout, this, &SerialReader::reportRepeats);
+
+    m_replayTimer = new QTimer(this);
+    m_replayTimer->setSingleShot(true);
+    m_replayTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_replayTimer, &QTimer::timeout, this, &SerialReader::replayStep);
+}
+
+void SerialReader::open(const QString& portName, int baud) {
+    m_transmit->stop("Port reopened.");
+    stopReconnect();
+    if (m_serial->isOpen()) m_serial->close();
+
+    m_portName = portName;
+    m_baud = baud;
+    stopReplay();
+    if (!openPort()) {
+        emit opened(false, m_serial->errorString());
+        return;
+    }
+    resetPipeline();
+    m_timestamps.start(TimestampFormatter::monotonicNs());
+    emit opened(true, QString());
+}
+
+bool SerialReader::openPort() {
+    m_serial->setPortName(m_portName);
+    m_serial->setBaudRate(m_baud);
+    m_serial->setDataBits(QSerialPort::Data8);
+    m_serial->setParity(QSerialPort::NoParity);
+    m_serial->setStopBits(QSerialPort::OneStop);
+    m_serial->setFlowControl(QSerialPort::NoFlowControl);
+    return m_serial->open(QIODevice::ReadWrite);
+}
+
+void SerialReader::resetPipeline() {
+    endRepeats();
+    m_lineBuffer.clear();
+    m_kernel.reset();
+    m_lineOpen = false;
+    if (m_frames) m_frames->reset();
+    m_frameSeq = 0;
+}
+
+void SerialReader::setFrameOptions(const FrameOptions& options) {
+    if (options.kind == FrameOptions::Kind::None) m_frames.reset();
+    else m_frames = std::make_unique<FrameDecoder>(options);
+    resetPipeline();
+}
+
+void SerialReader::close() {
+    endRepeats();
+    if (m_reconnecting) {
+        stopReconnect();
+        emit closed();
+        return;
+    }
+    if (!m_serial->isOpen()) return;
+    m_transmit->stop("Port closed.");
+    m_serial->close();
+    emit closed();
+}
+
+void SerialReader::write(const QByteArray& data) {
+    TransmitEngine::Step step;
+    step.data = data;
+    step.lines = true;
+    m_transmit->enqueue({step});
+}
+
+void SerialReader::onReadyRead() {
+    const qint64 arrivalNs = TimestampFormatter::monotonicNs();
+    QByteArray data = m_serial->readAll();
+    if (data.isEmpty()) return;
+
+    if (m_captureWriter) {
+        m_captureWriter->append(RawCapture::recordHeader(arrivalNs, quint32(data.size())));
+        m_captureWriter->append(data);
+    }
+    m_transmit->received(data);
+    if (m_metrics && m_metrics->enabled()) {
+        const qint64 ingestStart = TimestampFormatter::monotonicNs();
+        const std::size_t rows = ingest(data, arrivalNs);
+        m_metrics->recordRead(quint64(data.size()), quint64(rows),
+                              quint64(TimestampFormatter::monotonicNs() - ingestStart));
+        return;
+    }
+    ingest(data, arrivalNs);
+}
+
+std::size_t SerialReader::ingest(QByteArray& data, qint64 arrivalNs) {
+    if (m_rawRing && !m_rawRing->write(data.constData(), std::size_t(data.size()))) {
+        m_droppedRawBytes.fetch_add(quint64(data.size()), std::memory_order_relaxed);
+    }
+    if (m_frames) return ingestFrames(data, arrivalNs);
+
+    m_normalized.resize(data.size() + qsizetype(IngestKernel::kMaxCarry));
+    m_lineEnds.clear();
+    const std::size_t size = m_kernel.process(data.data(), std::size_t(data.size()), m_normalized.data(), m_lineEnds);
+    const QByteArrayView text(m_normalized.constData(), qsizetype(size));
+    if (m_collapser.mode() != RepeatCollapser::Mode::Off) {
+        const QByteArrayView out = collapseRepeats(text, arrivalNs);
+        if (!out.isEmpty() && !publish(out, m_keptLines, m_logDiverged ? &m_logText : nullptr)) {
+            m_repeatEvents.clear();
+            m_runLine = -1;
+        }
+        reportRepeats();
+        return m_lineEnds.size();
+    }
+    if (m_timeRing) stampLines(text.size(), arrivalNs);
+
+    const QByteArrayView out = m_timestampEnabled ? formatWithTimestamp(text, arrivalNs) : text;
+    if (!out.isEmpty()) publish(out, m_lineEnds.size());
+    return m_lineEnds.size();
+}
+
+// A line is stamped with the read that started it, so the first line ending
+// in this read may belong to an earlier one.
+void SerialReader::stampLines(qsizetype textSize, qint64 arrivalNs) {
+    m_lineTimes.clear();
+    for (std::size_t i = 0; i < m_lineEnds.size(); ++i) {
+        m_lineTimes.push_back(m_timestamps.wallNs(i == 0 && m_lineOpen ? m_lineOpenNs : arrivalNs));
+    }
+    const qsizetype lastEnd = m_lineEnds.empty() ? 0 : qsizetype(m_lineEnds.back());
+    if (textSize > lastEnd) {
+        if (!m_lineOpen || !m_lineEnds.empty()) m_lineOpenNs = arrivalNs;
+        m_lineOpen = true;
+    } else if (!m_lineEnds.empty()) {
+        m_lineOpen = false;
+    }
+}
+
+// Text and line times are dropped together so that the GUI can pair every
+// '\n' it receives with the next time in order.
+bool SerialReader::publish(QByteArrayView out, std::size_t lines, const QByteArray* log) {
+    bool written = false;
+    if (m_ring) {
+        const std::size_t timeBytes = m_timeRing ? m_lineTimes.size() * sizeof(qint64) : 0;
+        const bool timesFit = !m_timeRing || m_timeRing->capacity() - m_timeRing->size() >= timeBytes;
+        if (!timesFit || !m_ring->write(out.data(), std::size_t(out.size()))) {
+            m_droppedBytes.fetch_add(quint64(out.size()), std::memory_order_relaxed);
+        } else {
+            if (timeBytes) m_timeRing->write(reinterpret_cast<const char*>(m_lineTimes.data()), timeBytes);
+            m_ringLines += qint64(lines);
+            written = true;
+        }
+    }
+    if (m_logWriter) m_logWriter->append(log ? QByteArrayView(*log) : out);
+    if (m_trigger) {
+        m_trigger->feed(out);
+        if (!m_trigger->isCollecting()) m_triggerTimer->stop();
+        else if (!m_triggerTimer->isActive()) m_triggerTimer->start();
+    }
+    return written;
+}
+
+void SerialReader::setTrigger(const TriggerCapture::Options& options, const PatternMatcher& matcher) {
+    m_trigger.reset();
+    m_trigger = std::make_unique<TriggerCapture>(
+        options, matcher,
+        [this](const QString& path, const QByteArray& line) { emit triggerFired(path, line); },
+        [this](const QString& path, qint64 bytes, const QString& error) { emit triggerSaved(path, bytes, error); });
+}
+
+// Destroying the trigger saves a snapshot in progress and waits for it.
+void SerialReader::clearTrigger() {
+    m_triggerTimer->stop();
+    m_trigger.reset();
+}
+
+void SerialReader::triggerTimedOut() {
+    if (m_trigger) m_trigger->finish();
+}
+
+// Frames are decoded straight out of the read buffer; only the formatted rows
+// are copied, once, into m_formatted.
+std::size_t SerialReader::ingestFrames(QByteArray& data, qint64 arrivalNs) {
+    m_formatted.resize(0);
+    std::size_t rows = 0;
+    m_frames->feed(data.data(), data.size(), [&](const FrameDecoder::Frame& frame) {
+        appendFrameRow(frame, arrivalNs);
+        ++rows;
+    });
+    if (m_formatted.isEmpty()) return 0;
+    if (m_timeRing) m_lineTimes.assign(rows, m_timestamps.wallNs(arrivalNs));
+    publish(m_formatted, rows);
+    return rows;
+}
+
+// "<timestamp> #<seq> len=<n> crc=<ok|BAD> <hex bytes>", with the hex cut
+// short for very long frames.
+void SerialReader::appendFrameRow(const FrameDecoder::Frame& frame, qint64 arrivalNs) {
+    static const char digits[] = "0123456789abcdef";
+
+    m_formatted.append(m_timestamps.format(arrivalNs));
+    m_formatted.append(" #");
+    m_formatted.append(QByteArray::number(++m_frameSeq));
+    if (!frame.valid) {
+        m_formatted.append(" invalid frame\n");
+        return;
+    }
+    m_formatted.append(" len=");
+    m_formatted.append(QByteArray::number(frame.data.size()));
+    if (frame.crc == FrameDecoder::Check::Ok) m_formatted.append(" crc=ok");
+    else if (frame.crc == FrameDecoder::Check::Bad) m_formatted.append(" crc=BAD");
+
+    const qsizetype shown = qMin(frame.data.size(), kMaxFrameHexBytes);
+    const qsizetype start = m_formatted.size();
+    m_formatted.resize(start + 1 + shown * 3);
+    char* out = m_formatted.data() + start;
+    *out++ = ' ';
+    for (qsizetype i = 0; i < shown; ++i) {
+        const uchar byte = uchar(frame.data[i]);
+        *out++ = ' ';
+        *out++ = digits[byte >> 4];
+        *out++ = digits[byte & 15];
+    }
+    if (shown < frame.data.size()) m_formatted.append(" ...");
+    m_formatted.append('\n');
+}
+
+void SerialReader::startReplay(const QString& path, bool realTime) {
+    stopReplay();
+    if (m_serial->isOpen()) {
+        emit replayStarted(false, "Disconnect the port before replaying.");
+        return;
+    }
+    auto replay = std::make_unique<RawCaptureReader>();
+    QString error;
+    if (!replay->open(path, &error)) {
+        emit replayStarted(false, error);
+        return;
+    }
+
+    m_replay = std::move(replay);
+    m_replayRealTime = realTime;
+    m_replayHasChunk = false;
+    m_replayBytes = 0;
+    m_replayStartNs = TimestampFormatter::monotonicNs();
+    resetPipeline();
+    m_timestamps.start(m_replay->startMonoNs(), m_replay->startWallNs());
+    emit replayStarted(true, QString());
+    m_replayTimer->start(0);
+}
+
+void SerialReader::stopReplay() {
+    if (!m_replay) return;
+    m_replayTimer->stop();
+    finishReplay();
+}
+
+void SerialReader::finishReplay() {
+    const qint64 elapsedNs = TimestampFormatter::monotonicNs() - m_replayStartNs;
+    m_replay.reset();
+    m_replayHasChunk = false;
+    emit replayFinished(m_replayBytes, elapsedNs);
+}
+
+void SerialReader::replayStep() {
+    if (!m_replay) return;
+    const qint64 sliceEnd = TimestampFormatter::monotonicNs() + kReplaySliceNs;
+    for (;;) {
+        if (!m_replayHasChunk) {
+            if (!m_replay->next(&m_replayChunk)) {
+                finishReplay();
+                return;
+            }
+            m_replayHasChunk = true;
+            m_replayOffset = 0;
+        }
+        const qsizetype size = qMin(kReplayChunkSlice, m_replayChunk.data.size() - m_replayOffset);
+
+        const qint64 now = TimestampFormatter::monotonicNs();
+        if (m_replayRealTime) {
+            const qint64 due = m_replayStartNs + (m_replayChunk.monoNs - m_replay->startMonoNs());
+            if (due > now) {
+                m_replayTimer->start(int((due - now) / 1000000));
+                return;
+            }
+        } else if (m_ring) {
+            const std::size_t needed = std::size_t(size) * 4 + kReplayRingReserve;
+            const bool rawFull = m_rawRing && m_rawRing->capacity() - m_rawRing->size() < needed;
+            const bool timeFull = m_timeRing && m_timeRing->capacity() - m_timeRing->size()
+                                                    < std::size_t(size) * sizeof(qint64);
+            if (m_ring->capacity() - m_ring->size() < needed || rawFull || timeFull) {
+                m_replayTimer->start(1);
+                return;
+            }
+        }
+
+        if (size == m_replayChunk.data.size()) {
+            ingest(m_replayChunk.data, m_replayChunk.monoNs);
+        } else {
+            QByteArray slice = m_replayChunk.data.mid(m_replayOffset, size);
+            ingest(slice, m_replayChunk.monoNs);
+        }
+        m_replayBytes += size;
+        m_replayOffset += size;
+        if (m_replayOffset >= m_replayChunk.data.size()) m_replayHasChunk = false;
+
+        if (now >= sliceEnd) {
+            m_replayTimer->start(0);
+            return;
+        }
+    }
+}
+
+void SerialReader::onErrorOccurred(QSerialPort::SerialPortError error) {
+    if (error == QSerialPort::NoError) return;
+    if (m_metrics) m_metrics->recordSerialError(int(error));
+
+    if (error == QSerialPort::ResourceError || error == QSerialPort::DeviceNotFoundError) portGone();
+}
+
+void SerialReader::portGone() {
+    if (!m_serial->isOpen()) return;
+    m_transmit->stop("Port lost.");
+    m_serial->close();
+    if (m_autoReconnect) {
+        // A reset that does not re-enumerate never produces an event, so
+        // the port is also retried, quickly at first and then slowly.
+        m_reconnecting = true;
+        m_reconnectTries = 0;
+        m_lostNs = TimestampFormatter::monotonicNs();
+        m_appearedNs = 0;
+        m_reconnectTimer->start(kQuickRetryMs);
+    }
+    emit portLost(m_reconnecting);
+}
+
+void SerialReader::setAutoReconnect(bool enabled) {
+    m_autoReconnect = enabled;
+    if (!enabled && m_reconnecting) close();
+}
+
+// The kernel can announce a removal before the port reports an error.
+void SerialReader::onPortRemoved(const QString& name) {
+    if (name == m_serial->portName()) portGone();
+}
+
+void SerialReader::onPortAppeared(const QString& name, qint64 eventNs) {
+    if (!m_reconnecting || name != m_portName) return;
+    m_appearedNs = eventNs;
+    m_reconnectTries = 0;
+    tryReconnect();
+}
+
+// Nothing is reset: a line cut off by the loss continues with whatever the
+// device sends next, and the relative timestamp origin stays put.
+void SerialReader::tryReconnect() {
+    if (!m_reconnecting) return;
+    if (!openPort()) {
+        // The node can exist before udev has set its permissions.
+        ++m_reconnectTries;
+        m_reconnectTimer->start(m_reconnectTries < kQuickRetries ? kQuickRetryMs : kSlowRetryMs);
+        return;
+    }
+    const qint64 now = TimestampFormatter::monotonicNs();
+    stopReconnect();
+    if (m_frames) m_frames->reset();
+    emit reconnected(now - m_lostNs, m_appearedNs > 0 ? now - m_appearedNs : -1);
+}
+
+void SerialReader::stopReconnect() {
+    m_reconnecting = false;
+    m_reconnectTimer->stop();
+}
+
+QByteArrayView SerialReader::formatWithTimestamp(QByteArrayView text, qint64 arrivalNs) {
+    m_formatted.resize(0);
+    qsizetype start = 0;
+    for (const std::uint32_t end : m_lineEnds) {
+        const QByteArrayView line = text.sliced(start, qsizetype(end) - 1 - start);
+        start = qsizetype(end);
+        if (m_lineBuffer.isEmpty() && line.isEmpty()) {
+            m_formatted.append('\n');
+            continue;
+        }
+        m_formatted.append(m_timestamps.format(m_lineBuffer.isEmpty() ? arrivalNs : m_lineStartNs));
+        m_formatted.append(' ');
+        m_formatted.append(m_lineBuffer);
+        m_formatted.append(line);
+        m_formatted.append('\n');
+        m_lineBuffer.resize(0);
+    }
+    if (start < text.size()) {
+        if (m_lineBuffer.isEmpty()) m_lineStartNs = arrivalNs;
+        m_lineBuffer.append(text.sliced(start));
+    }
+    return m_formatted;
+}
+
+void SerialReader::setRepeatMode(RepeatCollapser::Mode mode) {
+    if (mode == m_collapser.mode()) return;
+    endRepeats();
+    // Without timestamps a partial line is normally published as it comes,
+    // so the one held back for collapsing goes out now.
+    if (mode == RepeatCollapser::Mode::Off && !m_timestampEnabled && !m_lineBuffer.isEmpty()) {
+        m_lineTimes.clear();
+        publish(m_lineBuffer, 0);
+        m_lineBuffer.resize(0);
+    }
+    m_collapser.setMode(mode);
+}
+
+// Like formatWithTimestamp, holds partial lines back: a line cannot be told
+// from a repeat before it ends. Its hash is rolled forward as it arrives.
+// Kept lines are stamped here too, one time per line written.
+QByteArrayView SerialReader::collapseRepeats(QByteArrayView text, qint64 arrivalNs) {
+    m_formatted.resize(0);
+    m_lineTimes.clear();
+    m_keptLines = 0;
+    m_logDiverged = false;
+    qsizetype start = 0;
+    for (const std::uint32_t end : m_lineEnds) {
+        const QByteArrayView line = text.sliced(start, qsizetype(end) - 1 - start);
+        start = qsizetype(end);
+        const qint64 lineNs = m_lineBuffer.isEmpty() ? arrivalNs : m_lineStartNs;
+        m_collapser.feed(line);
+        const quint64 repeats = m_collapser.repeats();
+        if (m_collapser.endLine()) {
+            m_runLastNs = lineNs;
+            m_lineBuffer.resize(0);
+            continue;
+        }
+        if (repeats > 0) finishRun(repeats, true);
+
+        const qsizetype from = m_formatted.size();
+        if (m_timestampEnabled && !(m_lineBuffer.isEmpty() && line.isEmpty())) {
+            m_formatted.append(m_timestamps.format(lineNs));
+            m_formatted.append(' ');
+        }
+        m_formatted.append(m_lineBuffer);
+        m_formatted.append(line);
+        m_formatted.append('\n');
+        if (m_logDiverged) m_logText.append(m_formatted.constData() + from, m_formatted.size() - from);
+        m_lineTimes.push_back(m_timestamps.wallNs(lineNs));
+        m_lineBuffer.resize(0);
+
+        m_runLine = m_ringLines + qint64(m_keptLines++);
+        m_runLastNs = lineNs;
+        m_runReported = 0;
+    }
+    if (start < text.size()) {
+        if (m_lineBuffer.isEmpty()) m_lineStartNs = arrivalNs;
+        const QByteArrayView rest = text.sliced(start);
+        m_collapser.feed(rest);
+        m_lineBuffer.append(rest);
+    }
+    return m_formatted;
+}
+
+// Ends the run of repeats of the last distinct line: the GUI gets the final
+// count and the log one summary line. Inside a batch the summary is spliced
+// into a copy of the batch made for the log.
+void SerialReader::finishRun(quint64 repeats, bool inBatch) {
+    if (m_runLine >= 0 && repeats != m_runReported) {
+        m_repeatEvents.push_back({m_runLine, repeats, m_timestamps.wallNs(m_runLastNs)});
+    }
+    m_runReported = repeats;
+    if (!m_logWriter) return;
+
+    QByteArray summary;
+    if (m_timestampEnabled) {
+        summary.append(m_timestamps.format(m_runLastNs));
+        summary.append(' ');
+    }
+    summary.append("[previous line repeated ");
+    summary.append(QByteArray::number(repeats));
+    summary.append(repeats == 1 ? " more time]\n" : " more times]\n");
+    if (!inBatch) {
+        m_logWriter->append(summary);
+        return;
+    }
+    if (!m_logDiverged) {
+        m_logText = m_formatted;
+        m_logDiverged = true;
+    }
+    m_logText.append(summary);
+}
+
+// For when the stream breaks off: the run is finished and the next line is
+// never counted as a repeat of one before the break.
+void SerialReader::endRepeats() {
+    const quint64 repeats = m_collapser.repeats();
+    if (repeats > 0) finishRun(repeats, false);
+    writeRepeatEvents();
+    m_repeatTimer->stop();
+    m_collapser.reset();
+    m_runLine = -1;
+}
+
+// A flood of repeats costs the GUI a few events a second: the live count is
+// sent at most every kRepeatReportMs, and the timer sends the last one.
+void SerialReader::reportRepeats() {
+    const quint64 repeats = m_collapser.repeats();
+    if (m_runLine >= 0 && repeats > m_runReported) {
+        const qint64 now = TimestampFormatter::monotonicNs();
+        if (now - m_runReportedNs >= qint64(kRepeatReportMs) * 1000000) {
+            m_repeatEvents.push_back({m_runLine, repeats, m_timestamps.wallNs(m_runLastNs)});
+            m_runReported = repeats;
+            m_runReportedNs = now;
+        } else if (!m_repeatTimer->isActive()) {
+            m_repeatTimer->start();
+        }
+    }
+    writeRepeatEvents();
+}
+
+// Counts are totals, so an event that does not fit is simply dropped.
+void SerialReader::writeRepeatEvents() {
+    if (m_repeatRing) {
+        for (const RepeatEvent& event : m_repeatEvents) {
+            m_repeatRing->write(reinterpret_cast<const char*>(&event), sizeof(event));
+        }
+    }
+    m_repeatEvents.clear();
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <QObject>
+#include <QSerialPort>
+#include <QTimeZone>
+#include <QTimer>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "framedecoder.h"
+#include "ingestkernel.h"
+#include "logwriter.h"
+#include "metrics.h"
+#include "rawcapture.h"
+#include "repeatcollapser.h"
+#include "spscring.h"
+#include "timestampformatter.h"
+#include "transmitengine.h"
+#include "triggercapture.h"
+
+// Owns a QSerialPort on a worker thread. Incoming bytes are normalized by an
+// IngestKernel, stamped with their arrival time, handed to the GUI through an
+// SpscRing and, while logging, queued to a LogWriter. Raw chunks can also be
+// captured, and a capture replayed through the same path in place of a port.
+// Outgoing data goes through a TransmitEngine on the same thread.
+// With auto-reconnect on, a lost port is reopened as soon as the PortMonitor
+// sees it again, and the stream and log carry on where they stopped.
+// An armed TriggerCapture sees the same formatted output as the LogWriter.
+// With repeat collapsing on, a line that repeats the previous one is only
+// counted: the count goes to the GUI as RepeatEvents and to the log as one
+// summary line when the run ends.
+// With framing selected, bytes go through a FrameDecoder instead and every
+// frame becomes one row. Without a ring (headless mode) output only goes to
+// the LogWriter.
+class SerialReader : public QObject {
+    Q_OBJECT
+public:
+    explicit SerialReader(SpscRing* ring, QObject* parent = nullptr);
+
+    quint64 droppedBytes() const { return m_droppedBytes.load(std::memory_order_relaxed); }
+    quint64 droppedRawBytes() const { return m_droppedRawBytes.load(std::memory_order_relaxed); }
+    void setMetrics(TabMetrics* metrics) { m_metrics = metrics; }
+    // Unmodified received bytes are also copied here, for the hex view.
+    void setRawRing(SpscRing* ring) { m_rawRing = ring; }
+    // Wall-clock start time (ns) of every line written to the ring, one
+    // qint64 per line, so tabs can be merged by arrival.
+    void setTimeRing(SpscRing* ring) { m_timeRing = ring; }
+    void setRepeatRing(SpscRing* ring) { m_repeatRing = ring; }
+
+    void setTimestampEnabled(bool enabled) { m_timestampEnabled = enabled; }
+    void setTimeZone(const QTimeZone& tz) { m_timestamps.setTimeZone(tz); }
+    void setTimestampMode(TimestampFormatter::Mode mode) { m_timestamps.setMode(mode); }
+    void setFrameOptions(const FrameOptions& options);
+    void setRepeatMode(RepeatCollapser::Mode mode);
+    void setLogWriter(std::shared_ptr<LogWriter> writer) { m_logWriter = std::move(writer); }
+    void setCaptureWriter(std::shared_ptr<LogWriter> writer) { m_captureWriter = std::move(writer); }
+    void startReplay(const QString& path, bool realTime);
+    void stopReplay();
+    void transmit(const QList<TransmitEngine::Step>& steps) { m_transmit->enqueue(steps); }
+    void stopTransmit() { m_transmit->stop(); }
+    void setAutoReconnect(bool enabled);
+    void setTrigger(const TriggerCapture::Options& options, const PatternMatcher& matcher);
+    void clearTrigger();
+
+public slots:
+    void open(const QString& portName, int baud);
+    void close();
+    void write(const QByteArray& data);
+    // Connected to the PortMonitor, whose signals come from its own thread.
+    void onPortAppeared(const QString& name, qint64 eventNs);
+    void onPortRemoved(const QString& name);
+
+signals:
+    void opened(bool ok, const QString& error);
+    void closed();
+    void portLost(bool reconnecting);
+    // `downNs` runs from the loss, `reopenNs` from when the port was seen
+    // again (-1 if it never went away).
+    void reconnected(qint64 downNs, qint64 reopenNs);
+    void transmitProgress(qint64 sent, qint64 total, qint64 bytesPerSec);
+    void transmitFinished(bool ok, const QString& error);
+    void triggerFired(const QString& path, const QByteArray& line);
+    // Emitted from the snapshot writer's thread.
+    void triggerSaved(const QString& path, qint64 bytes, const QString& error);
+    void replayStarted(bool ok, const QString& error);
+    void replayFinished(qint64 bytes, qint64 elapsedNs);
+
+private slots:
+    void onReadyRead();
+    void onErrorOccurred(QSerialPort::SerialPortError error);
+    void replayStep();
+    void tryReconnect();
+    void triggerTimedOut();
+    void reportRepeats();
+
+private:
+    bool openPort();
+    void portGone();
+    void stopReconnect();
+    void resetPipeline();
+    // Returns the number of rows produced. Framing decodes `data` in place.
+    std::size_t ingest(QByteArray& data, qint64 arrivalNs);
+    std::size_t ingestFrames(QByteArray& data, qint64 arrivalNs);
+    void appendFrameRow(const FrameDecoder::Frame& frame, qint64 arrivalNs);
+    void stampLines(qsizetype textSize, qint64 arrivalNs);
+    // Returns false when the ring had no room. `log`, when given, goes to
+    // the log in place of `out`.
+    bool publish(QByteArrayView out, std::size_t lines, const QByteArray* log = nullptr);
+    void finishReplay();
+    QByteArrayView formatWithTimestamp(QByteArrayView text, qint64 arrivalNs);
+    QByteArrayView collapseRepeats(QByteArrayView text, qint64 arrivalNs);
+    void finishRun(quint64 repeats, bool inBatch);
+    void endRepeats();
+    void writeRepeatEvents();
+
+    SpscRing* m_ring;
+    SpscRing* m_rawRing = nullptr;
+    SpscRing* m_timeRing = nullptr;
+    SpscRing* m_repeatRing = nullptr;
+    QSerialPort* m_serial;
+    TransmitEngine* m_transmit;
+    QString m_portName;
+    int m_baud = 0;
+
+    bool m_autoReconnect = false;
+    bool m_reconnecting = false;
+    QTimer* m_reconnectTimer;
+    int m_reconnectTries = 0;
+    qint64 m_lostNs = 0;
+    qint64 m_appearedNs = 0;
+    std::atomic<quint64> m_droppedBytes{0};
+    std::atomic<quint64> m_droppedRawBytes{0};
+    TabMetrics* m_metrics = nullptr;
+    std::shared_ptr<LogWriter> m_logWriter;
+    std::shared_ptr<LogWriter> m_captureWriter;
+
+    std::unique_ptr<RawCaptureReader> m_replay;
+    QTimer* m_replayTimer;
+    RawCapture::Chunk m_replayChunk;
+    bool m_replayHasChunk = false;
+    qsizetype m_replayOffset = 0;
+    bool m_replayRealTime = true;
+    qint64 m_replayStartNs = 0;
+    qint64 m_replayBytes = 0;
+
+    bool m_timestampEnabled = false;
+    TimestampFormatter m_timestamps;
+    qint64 m_lineStartNs = 0;
+    IngestKernel m_kernel;
+    QByteArray m_normalized;
+    std::vector<std::uint32_t> m_lineEnds;
+    QByteArray m_formatted;
+    QByteArray m_lineBuffer;
+    std::vector<qint64> m_lineTimes;
+    bool m_lineOpen = false;
+    qint64 m_lineOpenNs = 0;
+    std::unique_ptr<FrameDecoder> m_frames;
+    std::unique_ptr<TriggerCapture> m_trigger;
+    QTimer* m_triggerTimer;
+    quint64 m_frameSeq = 0;
+
+    RepeatCollapser m_collapser;
+    qint64 m_ringLines = 0;        // lines written to the ring so far
+    qint64 m_runLine = -1;         // ring line of the run's distinct line
+    qint64 m_runLastNs = 0;
+    quint64 m_runReported = 0;
+    qint64 m_runReportedNs = 0;
+    std::size_t m_keptLines = 0;
+    bool m_logDiverged = false;
+    QByteArray m_logText;
+    std::vector<RepeatEvent> m_repeatEvents;
+    QTimer* m_repeatTimer;
+};
@@ -1,22 +1,45 @@
 #include "serialtab.h"
 
+#include <QApplication>
+#include <QDir>
 #include <QHBoxLayout>
 #include <QVBoxLayout>
-#include <QTextCursor>
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QFile>
+#include <QFileInfo>
+#include <QLocale>
+#include <QMenu>
+#include <QScrollBar>
+#include <QByteArrayMatcher>
+#include <QRegularExpression>
+
+#include "framingdialog.h"
+#include "portmonitor.h"
+#include "rawcapture.h"
+#include "transmitdialog.h"
+#include "serialioservice.h"
+#include "timestampformatter.h"
 
 static const QStringList kBaudRates = {
     "300", "600", "1200", "2400", "4800", "9600", "19200",
-    "38400", "57600", "115200", "230400", "460800", "921600"
+    "38400", "57600", "115200", "230400", "460800", "921600",
+    "1500000", "2000000", "3000000"
 };
 
+static const std::size_t kRingCapacity = 4 * 1024 * 1024;
+static const std::size_t kTimeRingCapacity = 1024 * 1024;
+static const std::size_t kRepeatRingCapacity = 64 * 1024;
+static const int kDrainIntervalMs = 16;
+static const int kHiddenDrainIntervalMs = 250;
+static const int kStatsIntervalMs = 500;
+static const int kMetricsIntervalMs = 1000;
+
 SerialTab::SerialTab(const QString& portName, QWidget* parent)
-    : QWidget(parent), m_portName(portName) {
+    : QWidget(parent), m_portName(portName), m_ring(kRingCapacity), m_rawRing(kRingCapacity),
+      m_timeRing(kTimeRingCapacity), m_repeatRing(kRepeatRingCapacity) {
 
-    m_textEdit = new QTextEdit(this);
-    m_textEdit->setReadOnly(true);
+    m_logView = new LogView(&m_store, this);
 
     m_baudCombo = new QComboBox(this);
     m_baudCombo->addItems(kBaudRates);
@@ -25,58 +48,239 @@ SerialTab::SerialTab(const QString& portName, QWidget* parent)
     m_connectBtn = new QPushButton("Connect", this);
     connect(m_connectBtn, &QPushButton::clicked, this, &SerialTab::toggleConnect);
 
+    m_autoReconnectBox = new QCheckBox("Auto-reconnect", this);
+    m_autoReconnectBox->setToolTip("Reopen the port as soon as it reappears and keep logging to the same file");
+    connect(m_autoReconnectBox, &QCheckBox::toggled, this, &SerialTab::setAutoReconnect);
+
     m_sendEdit = new QLineEdit(this);
     m_sendBtn = new QPushButton("Enter", this);
     m_clearBtn = new QPushButton("Clear", this);
     m_logBtn = new QPushButton("Log...", this);
+    m_captureBtn = new QPushButton("Capture...", this);
 
     connect(m_sendBtn, &QPushButton::clicked, this, &SerialTab::sendLine);
     connect(m_clearBtn, &QPushButton::clicked, this, &SerialTab::clearSend);
     connect(m_sendEdit, &QLineEdit::returnPressed, this, &SerialTab::sendLine);
     connect(m_logBtn, &QPushButton::clicked, this, &SerialTab::toggleLogging);
+    connect(m_captureBtn, &QPushButton::clicked, this, &SerialTab::toggleCapture);
+
+    m_replayBtn = new QPushButton("Replay", this);
+    auto replayMenu = new QMenu(m_replayBtn);
+    replayMenu->addAction("Replay at Original Speed...", this, [this]() { startReplay(true); });
+    replayMenu->addAction("Replay at Max Speed...", this, [this]() { startReplay(false); });
+    replayMenu->addAction("Stop Replay", this, &SerialTab::stopReplay);
+    m_replayBtn->setMenu(replayMenu);
+
+    m_transmitBtn = new QPushButton("Transmit", this);
+    auto transmitMenu = new QMenu(m_transmitBtn);
+    transmitMenu->addAction("Send File...", this, &SerialTab::sendFile);
+    transmitMenu->addAction("Run Script...", this, &SerialTab::runScript);
+    transmitMenu->addAction("Stop Transmit", this, &SerialTab::stopTransmit);
+    m_transmitBtn->setMenu(transmitMenu);
+
+    m_triggerBtn = new QPushButton("Trigger", this);
+    auto triggerMenu = new QMenu(m_triggerBtn);
+    triggerMenu->addAction("Arm Trigger...", this, &SerialTab::armTrigger);
+    m_disarmAction = triggerMenu->addAction("Disarm Trigger", this, &SerialTab::disarmTrigger);
+    m_resumeAction = triggerMenu->addAction("Resume View", this, &SerialTab::resumeView);
+    m_disarmAction->setEnabled(false);
+    m_resumeAction->setEnabled(false);
+    m_triggerBtn->setMenu(triggerMenu);
+    m_triggerSettings.directory = QDir::homePath();
+
+    m_filterBar = new FilterBar(this);
+    connect(m_filterBar, &FilterBar::filterChanged, this, &SerialTab::applyFilter);
+
+    m_viewCombo = new QComboBox(this);
+    m_viewCombo->addItems({"Text", "Hex", "Hex + ASCII"});
+    connect(m_viewCombo, &QComboBox::currentIndexChanged, this, &SerialTab::setViewMode);
+
+    m_framingBtn = new QPushButton("Framing...", this);
+    connect(m_framingBtn, &QPushButton::clicked, this, &SerialTab::editFraming);
+
+    m_repeatCombo = new QComboBox(this);
+    m_repeatCombo->addItems({"Show All", "Collapse", "Collapse, Ignore Digits"});
+    m_repeatCombo->setToolTip("Show a line that repeats the one before it as a count on that line");
+    connect(m_repeatCombo, &QComboBox::currentIndexChanged, this, &SerialTab::setRepeatMode);
+
+    m_hexBar = new QWidget(this);
+    m_offsetEdit = new QLineEdit(m_hexBar);
+    m_offsetEdit->setPlaceholderText("0x0");
+    m_hexFindEdit = new QLineEdit(m_hexBar);
+    m_hexFindEdit->setPlaceholderText("de ad be ef");
+    auto hexFindBtn = new QPushButton("Find Next", m_hexBar);
+    connect(m_offsetEdit, &QLineEdit::returnPressed, this, &SerialTab::goToOffset);
+    connect(m_hexFindEdit, &QLineEdit::returnPressed, this, &SerialTab::findHexNext);
+    connect(hexFindBtn, &QPushButton::clicked, this, &SerialTab::findHexNext);
+    auto hexRow = new QHBoxLayout(m_hexBar);
+    hexRow->setContentsMargins(0, 0, 0, 0);
+    hexRow->addWidget(new QLabel("Go to offset:", m_hexBar));
+    hexRow->addWidget(m_offsetEdit);
+    hexRow->addWidget(new QLabel("Find bytes:", m_hexBar));
+    hexRow->addWidget(m_hexFindEdit, 1);
+    hexRow->addWidget(hexFindBtn);
+    m_hexBar->hide();
+
+    m_timeBar = new QWidget(this);
+    m_fromTimeEdit = new QDateTimeEdit(QDateTime::currentDateTime(), m_timeBar);
+    m_toTimeEdit = new QDateTimeEdit(QDateTime::currentDateTime(), m_timeBar);
+    m_fromTimeEdit->setDisplayFormat("dd-MM-yyyy HH:mm:ss.zzz");
+    m_toTimeEdit->setDisplayFormat("dd-MM-yyyy HH:mm:ss.zzz");
+    auto goTimeBtn = new QPushButton("Go", m_timeBar);
+    auto selectTimeBtn = new QPushButton("Select", m_timeBar);
+    selectTimeBtn->setToolTip("Select the lines between the two times for copying or Save Logs");
+    connect(goTimeBtn, &QPushButton::clicked, this, &SerialTab::goToTime);
+    connect(selectTimeBtn, &QPushButton::clicked, this, &SerialTab::selectTimeRange);
+    auto timeRow = new QHBoxLayout(m_timeBar);
+    timeRow->setContentsMargins(0, 0, 0, 0);
+    timeRow->addWidget(new QLabel("Go to time:", m_timeBar));
+    timeRow->addWidget(m_fromTimeEdit);
+    timeRow->addWidget(goTimeBtn);
+    timeRow->addWidget(new QLabel("to", m_timeBar));
+    timeRow->addWidget(m_toTimeEdit);
+    timeRow->addWidget(selectTimeBtn);
+    timeRow->addStretch();
 
     m_statusLabel = new QLabel("Disconnected", this);
+    m_droppedLabel = new QLabel(this);
+    m_transmitLabel = new QLabel(this);
+    m_logStatsLabel = new QLabel(this);
+    m_memoryLabel = new QLabel(this);
+
+    m_statsPanel = new StatsPanel(this);
+    m_statsPanel->hide();
+    m_statsBtn = new QPushButton("Stats", this);
+    m_statsBtn->setCheckable(true);
+    connect(m_statsBtn, &QPushButton::toggled, this, &SerialTab::toggleStats);
+    m_metricsTimer = new QTimer(this);
+    m_metricsTimer->setInterval(kMetricsIntervalMs);
+    connect(m_metricsTimer, &QTimer::timeout, this, &SerialTab::refreshStats);
 
     auto topRow = new QHBoxLayout();
     topRow->addWidget(new QLabel(QString("Port: %1").arg(m_portName), this));
     topRow->addStretch();
+    topRow->addWidget(new QLabel("View:", this));
+    topRow->addWidget(m_viewCombo);
+    topRow->addWidget(m_framingBtn);
+    topRow->addWidget(new QLabel("Repeats:", this));
+    topRow->addWidget(m_repeatCombo);
     topRow->addWidget(new QLabel("Baud:", this));
     topRow->addWidget(m_baudCombo);
     topRow->addWidget(m_connectBtn);
+    topRow->addWidget(m_autoReconnectBox);
+    topRow->addWidget(m_replayBtn);
 
     auto sendRow = new QHBoxLayout();
     sendRow->addWidget(m_sendEdit);
     sendRow->addWidget(m_sendBtn);
     sendRow->addWidget(m_clearBtn);
+    sendRow->addWidget(m_transmitBtn);
     sendRow->addWidget(m_logBtn);
+    sendRow->addWidget(m_captureBtn);
+    sendRow->addWidget(m_triggerBtn);
+
+    auto statusRow = new QHBoxLayout();
+    statusRow->addWidget(m_statusLabel);
+    statusRow->addStretch();
+    statusRow->addWidget(m_transmitLabel);
+    statusRow->addWidget(m_logStatsLabel);
+    statusRow->addWidget(m_memoryLabel);
+    statusRow->addWidget(m_droppedLabel);
+    statusRow->addWidget(m_statsBtn);
 
     auto layout = new QVBoxLayout(this);
     layout->addLayout(topRow);
-    layout->addWidget(m_textEdit);
+    layout->addWidget(m_filterBar);
+    layout->addWidget(m_hexBar);
+    layout->addWidget(m_timeBar);
+    layout->addWidget(m_logView);
+    layout->addWidget(m_statsPanel);
     layout->addLayout(sendRow);
-    layout->addWidget(m_statusLabel);
-
-    connect(&m_serial, &QSerialPort::readyRead, this, &SerialTab::onReadyRead);
-    connect(&m_serial, &QSerialPort::errorOccurred, this, &SerialTab::onErrorOccurred);
-
-    m_timeZone = QTimeZone::systemTimeZone();
+    layout->addLayout(statusRow);
+
+    m_drainBuffer.resize(qsizetype(m_ring.capacity()));
+    m_timeBuffer.resize(qsizetype(m_timeRing.capacity() / sizeof(qint64)));
+    m_repeatBuffer.resize(qsizetype(m_repeatRing.capacity() / sizeof(RepeatEvent)));
+    m_drainTimer = new QTimer(this);
+    m_drainTimer->setInterval(kHiddenDrainIntervalMs);
+    connect(m_drainTimer, &QTimer::timeout, this, &SerialTab::drainReader);
+
+    m_readerThread = SerialIoService::instance()->acquire();
+    m_reader = new SerialReader(&m_ring);
+    m_reader->setMetrics(&m_metrics);
+    m_reader->setRawRing(&m_rawRing);
+    m_reader->setTimeRing(&m_timeRing);
+    m_reader->setRepeatRing(&m_repeatRing);
+    m_reader->moveToThread(m_readerThread);
+    connect(m_reader, &SerialReader::opened, this, &SerialTab::onOpened);
+    connect(m_reader, &SerialReader::closed, this, &SerialTab::onClosed);
+    connect(m_reader, &SerialReader::portLost, this, &SerialTab::onPortLost);
+    connect(m_reader, &SerialReader::reconnected, this, &SerialTab::onReconnected);
+    // Straight to the reader's thread, so a reconnect does not wait on the GUI.
+    connect(PortMonitor::instance(), &PortMonitor::portAppeared, m_reader, &SerialReader::onPortAppeared);
+    connect(PortMonitor::instance(), &PortMonitor::portRemoved, m_reader, &SerialReader::onPortRemoved);
+    connect(m_reader, &SerialReader::replayStarted, this, &SerialTab::onReplayStarted);
+    connect(m_reader, &SerialReader::replayFinished, this, &SerialTab::onReplayFinished);
+    connect(m_reader, &SerialReader::transmitProgress, this, &SerialTab::onTransmitProgress);
+    connect(m_reader, &SerialReader::transmitFinished, this, &SerialTab::onTransmitFinished);
+    connect(m_reader, &SerialReader::triggerFired, this, &SerialTab::onTriggerFired);
+    connect(m_reader, &SerialReader::triggerSaved, this, &SerialTab::onTriggerSaved);
+
+    updateDroppedLabel();
+    m_statsClock.start();
+    m_memoryClock.start();
 }
 
 SerialTab::~SerialTab() {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader]() {
+        reader->stopReplay();
+        reader->close();
+        reader->clearTrigger();
+    }, Qt::BlockingQueuedConnection);
+    // The capture and log writers are detached with blocking calls into the
+    // reader, so it is only deleted after them.
+    stopCapture();
     stopLogging();
+    reader->deleteLater();
+    SerialIoService::instance()->release(m_readerThread);
+}
+
+void SerialTab::setTimestampEnabled(bool enabled) {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, enabled]() { reader->setTimestampEnabled(enabled); });
+}
+
+void SerialTab::setTimeZone(const QTimeZone& tz) {
+    m_store.setTimeZone(tz);
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, tz]() { reader->setTimeZone(tz); });
+}
+
+void SerialTab::setTimestampMode(TimestampFormatter::Mode mode) {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, mode]() { reader->setTimestampMode(mode); });
+}
+
+void SerialTab::setLogOptions(const LogWriter::Options& options) {
+    m_logOptions = options;
 }
 
 void SerialTab::setConnectedUi(bool connected) {
+    m_connected = connected;
     m_connectBtn->setText(connected ? "Disconnect" : "Connect");
     m_statusLabel->setText(connected ? QString("Connected @ %1").arg(m_baudCombo->currentText()) : "Disconnected");
     emit statusChanged(m_statusLabel->text());
 }
 
+void SerialTab::connectPort() {
+    if (!m_connected && !m_reconnecting && m_connectBtn->isEnabled()) toggleConnect();
+}
+
 void SerialTab::toggleConnect() {
-    if (m_serial.isOpen()) {
-        m_serial.close();
-        setConnectedUi(false);
-        stopLogging("Disconnected");
+    SerialReader* reader = m_reader;
+    if (m_connected || m_reconnecting) {
+        QMetaObject::invokeMethod(reader, [reader]() { reader->close(); });
         return;
     }
 
@@ -87,58 +291,349 @@ void SerialTab::toggleConnect() {
         return;
     }
 
-    m_serial.setPortName(m_portName);
-    m_serial.setBaudRate(baud);
-    m_serial.setDataBits(QSerialPort::Data8);
-    m_serial.setParity(QSerialPort::NoParity);
-    m_serial.setStopBits(QSerialPort::OneStop);
-    m_serial.setFlowControl(QSerialPort::NoFlowControl);
+    const QString name = m_portName;
+    QMetaObject::invokeMethod(reader, [reader, name, baud]() { reader->open(name, baud); });
+    m_connectBtn->setEnabled(false);
+}
+
+void SerialTab::onOpened(bool ok, const QString& error) {
+    m_connectBtn->setEnabled(true);
+    if (!ok) {
+        QMessageBox::critical(this, "UART Log Viewer", QString("Failed to open %1: %2").arg(m_portName, error));
+        return;
+    }
+    m_drainTimer->start();
+    setConnectedUi(true);
+}
+
+void SerialTab::onClosed() {
+    m_reconnecting = false;
+    m_drainTimer->stop();
+    drainReader();
+    setConnectedUi(false);
+    stopCapture();
+    stopLogging("Disconnected");
+}
 
-    if (!m_serial.open(QIODevice::ReadWrite)) {
-        QMessageBox::critical(this, "UART Log Viewer", QString("Failed to open %1: %2").arg(m_portName, m_serial.errorString()));
+// With auto-reconnect the log and capture stay open, so the lines the
+// device prints as it comes back land in the same file.
+void SerialTab::onPortLost(bool reconnecting) {
+    m_drainTimer->stop();
+    drainReader();
+    setConnectedUi(false);
+    if (reconnecting) {
+        m_reconnecting = true;
+        m_connectBtn->setText("Disconnect");
+        m_statusLabel->setText(QString("Port removed, waiting for %1").arg(m_portName));
+        emit statusChanged(m_statusLabel->text());
         return;
     }
+    m_statusLabel->setText(QString("Disconnected (port removed)"));
+    emit statusChanged(m_statusLabel->text());
+    stopCapture();
+    stopLogging("Port removed");
+}
 
+void SerialTab::onReconnected(qint64 downNs, qint64 reopenNs) {
+    m_reconnecting = false;
+    m_drainTimer->start();
     setConnectedUi(true);
+    const QString down = QString("down %1 s").arg(downNs / 1e9, 0, 'f', 2);
+    m_statusLabel->setText(reopenNs < 0
+                               ? QString("Reconnected @ %1 (%2)").arg(m_baudCombo->currentText(), down)
+                               : QString("Reconnected @ %1 in %2 ms after re-enumeration (%3)")
+                                     .arg(m_baudCombo->currentText())
+                                     .arg(reopenNs / 1e6, 0, 'f', 1)
+                                     .arg(down));
+    emit statusChanged(m_statusLabel->text());
+}
+
+void SerialTab::setAutoReconnect(bool enabled) {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, enabled]() { reader->setAutoReconnect(enabled); });
+}
+
+void SerialTab::startReplay(bool realTime) {
+    if (m_connected || m_reconnecting) {
+        QMessageBox::information(this, "UART Log Viewer", "Disconnect before replaying a capture.");
+        return;
+    }
+    const QString path = QFileDialog::getOpenFileName(this, "Replay Capture", QString(), "Raw Captures (*.ulraw);;All Files (*)");
+    if (path.isEmpty()) return;
+
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, path, realTime]() { reader->startReplay(path, realTime); });
+}
+
+void SerialTab::stopReplay() {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader]() { reader->stopReplay(); });
 }
 
-void SerialTab::onReadyRead() {
-    QByteArray data = m_serial.readAll();
-    if (data.isEmpty()) return;
+void SerialTab::onReplayStarted(bool ok, const QString& error) {
+    if (!ok) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Replay failed: %1").arg(error));
+        return;
+    }
+    m_connectBtn->setEnabled(false);
+    m_drainTimer->start();
+    m_statusLabel->setText("Replaying capture");
+    emit statusChanged(m_statusLabel->text());
+}
 
-    QString text = QString::fromUtf8(data.constData(), data.size());
-    text.replace("\x00", "");
-    text.replace("\r\n", "\n");
-    text.replace("\r", "\n");
+void SerialTab::onReplayFinished(qint64 bytes, qint64 elapsedNs) {
+    if (!m_connected) m_drainTimer->stop();
+    drainReader();
+    m_connectBtn->setEnabled(true);
 
-    const QString formatted = formatWithTimestamp(text);
-    appendText(formatted);
-    writeLog(formatted);
+    const double secs = qMax(elapsedNs, qint64(1)) / 1e9;
+    m_statusLabel->setText(QString("Replay finished: %1 in %2 s (%3/s)")
+                               .arg(QLocale().formattedDataSize(bytes))
+                               .arg(secs, 0, 'f', 3)
+                               .arg(QLocale().formattedDataSize(qint64(bytes / secs))));
+    emit statusChanged(m_statusLabel->text());
 }
 
-void SerialTab::onErrorOccurred(QSerialPort::SerialPortError error) {
-    if (error == QSerialPort::NoError) return;
+void SerialTab::toggleCapture() {
+    if (m_captureWriter) {
+        stopCapture("Capture stopped");
+        return;
+    }
+
+    const QString defaultName = QString("uart_capture_%1.ulraw").arg(m_portName);
+    const QString path = QFileDialog::getSaveFileName(this, "Start Raw Capture", defaultName, "Raw Captures (*.ulraw);;All Files (*)");
+    if (path.isEmpty()) return;
 
-    if (error == QSerialPort::ResourceError || error == QSerialPort::DeviceNotFoundError) {
-        m_serial.close();
-        setConnectedUi(false);
-        m_statusLabel->setText(QString("Disconnected (port removed)"));
+    LogWriter::Options options;
+    options.format = LogWriter::Format::Binary;
+    auto writer = std::make_shared<LogWriter>(path, options);
+    QString error;
+    if (!writer->open(&error)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Failed to open capture file: %1").arg(error));
+        return;
+    }
+    writer->append(RawCapture::fileHeader(TimestampFormatter::wallClockNs(), TimestampFormatter::monotonicNs()));
+    m_captureWriter = writer;
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, writer]() { reader->setCaptureWriter(writer); }, Qt::BlockingQueuedConnection);
+
+    m_captureBtn->setText("Stop Capture");
+    m_statusLabel->setText(QString("Capturing to %1").arg(path));
+    emit statusChanged(m_statusLabel->text());
+}
+
+void SerialTab::stopCapture(const QString& reason) {
+    if (!m_captureWriter) return;
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader]() { reader->setCaptureWriter(nullptr); }, Qt::BlockingQueuedConnection);
+    m_captureWriter->close();
+    m_captureWriter.reset();
+    m_captureBtn->setText("Capture...");
+    if (!reason.isEmpty()) {
+        m_statusLabel->setText(reason);
         emit statusChanged(m_statusLabel->text());
-        stopLogging("Port removed");
     }
 }
 
+void SerialTab::drainReader() {
+    drainRing();
+    if (m_reader->droppedBytes() != m_shownDropped || m_reader->droppedRawBytes() != m_shownRawDropped) {
+        updateDroppedLabel();
+    }
+    if (m_logWriter && m_statsClock.elapsed() >= kStatsIntervalMs) updateLogStats();
+    if (m_memoryClock.elapsed() >= kStatsIntervalMs) updateMemoryLabel();
+}
+
+void SerialTab::drainRing() {
+    const std::size_t raw = m_rawRing.read(m_drainBuffer.data(), std::size_t(m_drainBuffer.size()));
+    if (raw > 0) {
+        const qsizetype droppedRows = m_hex.append(QByteArrayView(m_drainBuffer.constData(), qsizetype(raw)));
+        if (droppedRows > 0 && m_logView->source() == &m_hex) {
+            // Keep the same rows on screen; the selection and highlight named
+            // rows that have moved, so they are dropped.
+            QScrollBar* bar = m_logView->verticalScrollBar();
+            const bool follow = bar->value() >= bar->maximum();
+            const qsizetype top = bar->value() - droppedRows;
+            m_logView->reset();
+            bar->setValue(follow ? bar->maximum() : int(qMax<qsizetype>(0, top)));
+        }
+    }
+
+    // Repeat events are read first: the line each one names was written to
+    // the ring before it, so it is in the store once the text below is.
+    const std::size_t repeatBytes = m_repeatRing.read(reinterpret_cast<char*>(m_repeatBuffer.data()),
+                                                      std::size_t(m_repeatBuffer.size()) * sizeof(RepeatEvent));
+    const std::size_t n = m_ring.read(m_drainBuffer.data(), std::size_t(m_drainBuffer.size()));
+    const std::size_t timeBytes = m_timeRing.read(reinterpret_cast<char*>(m_timeBuffer.data()),
+                                                  std::size_t(m_timeBuffer.size()) * sizeof(qint64));
+    m_store.appendTimes(m_timeBuffer.constData(), qsizetype(timeBytes / sizeof(qint64)));
+    if (n > 0) {
+        const QByteArrayView batch(m_drainBuffer.constData(), qsizetype(n));
+        appendData(batch);
+    } else if (raw > 0 && m_logView->source() == &m_hex) {
+        if (isVisible() && !m_viewPaused) refreshView();
+        else m_viewStale = true;
+    }
+    if (repeatBytes > 0) applyRepeats(qsizetype(repeatBytes / sizeof(RepeatEvent)));
+}
+
+// The reader numbers lines from the first it wrote, which is also the
+// store's numbering: nothing else is appended to it and it is never cleared.
+void SerialTab::applyRepeats(qsizetype count) {
+    for (qsizetype i = 0; i < count; ++i) {
+        const RepeatEvent& event = m_repeatBuffer.at(i);
+        m_store.setRepeats(event.line, event.repeats, event.lastNs);
+    }
+    if (m_logView->source() == &m_hex) return;
+    if (isVisible() && !m_viewPaused) m_logView->viewport()->update();
+    else m_viewStale = true;
+}
+
+void SerialTab::updateDroppedLabel() {
+    m_shownDropped = m_reader->droppedBytes();
+    m_shownRawDropped = m_reader->droppedRawBytes();
+    QString text = QString("Dropped: %1").arg(QLocale().formattedDataSize(qint64(m_shownDropped)));
+    if (m_shownRawDropped) text += QString(" (raw %1)").arg(QLocale().formattedDataSize(qint64(m_shownRawDropped)));
+    m_droppedLabel->setText(text);
+}
+
 void SerialTab::sendLine() {
-    if (!m_serial.isOpen()) {
+    if (!m_connected) {
         m_statusLabel->setText("Disconnected (not connected)");
         emit statusChanged(m_statusLabel->text());
         return;
     }
-    const QString data = m_sendEdit->text();
-    QByteArray out = (data + "\r\n").toUtf8();
-    if (m_serial.write(out) < 0) {
-        QMessageBox::warning(this, "UART Log Viewer", "Send failed.");
+    const QByteArray out = (m_sendEdit->text() + "\r\n").toUtf8();
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, out]() { reader->write(out); });
+}
+
+void SerialTab::sendFile() {
+    TransmitDialog dlg(this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    startTransmit(dlg.steps());
+}
+
+void SerialTab::runScript() {
+    const QString path = QFileDialog::getOpenFileName(this, "Run Script", QString(), "Scripts (*.txt *.script);;All Files (*)");
+    if (path.isEmpty()) return;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Failed to open %1: %2").arg(path, file.errorString()));
+        return;
+    }
+    QString error;
+    const QList<TransmitEngine::Step> steps =
+        TransmitEngine::parseScript(QString::fromUtf8(file.readAll()), QFileInfo(path).absolutePath(), &error);
+    if (!error.isEmpty()) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Invalid script: %1").arg(error));
+        return;
+    }
+    startTransmit(steps);
+}
+
+void SerialTab::startTransmit(const QList<TransmitEngine::Step>& steps) {
+    if (!m_connected) {
+        m_statusLabel->setText("Disconnected (not connected)");
+        emit statusChanged(m_statusLabel->text());
+        return;
     }
+    m_bulkTransmit = true;
+    m_transmitLabel->setText("TX starting...");
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, steps]() { reader->transmit(steps); });
+}
+
+void SerialTab::stopTransmit() {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader]() { reader->stopTransmit(); });
+}
+
+void SerialTab::onTransmitProgress(qint64 sent, qint64 total, qint64 bytesPerSec) {
+    if (!m_bulkTransmit) return;
+    const QLocale locale;
+    m_transmitLabel->setText(QString("TX %1 / %2 (%3/s)")
+                                 .arg(locale.formattedDataSize(sent), locale.formattedDataSize(total),
+                                      locale.formattedDataSize(bytesPerSec)));
+}
+
+// Failures are reported in the status bar rather than a dialog so a script
+// running unattended never blocks on one.
+void SerialTab::onTransmitFinished(bool ok, const QString& error) {
+    if (m_bulkTransmit) {
+        m_bulkTransmit = false;
+        m_transmitLabel->setText(ok ? "TX done" : "TX stopped");
+    }
+    if (ok) return;
+    m_statusLabel->setText(QString("Transmit failed: %1").arg(error));
+    emit statusChanged(m_statusLabel->text());
+}
+
+void SerialTab::armTrigger() {
+    TriggerDialog dialog(m_triggerSettings, this);
+    if (dialog.exec() != QDialog::Accepted) return;
+    const TriggerDialog::Settings settings = dialog.settings();
+
+    PatternMatcher matcher;
+    QString error;
+    if (!matcher.compile(settings.patternList(), settings.regex, settings.matchCase, &error)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Invalid trigger pattern: %1").arg(error));
+        return;
+    }
+    if (!QDir(settings.directory).exists()) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Folder %1 does not exist.").arg(settings.directory));
+        return;
+    }
+    m_triggerSettings = settings;
+
+    TriggerCapture::Options options;
+    options.preBytes = qint64(settings.preMb) * 1024 * 1024;
+    options.postLines = settings.postLines;
+    options.directory = settings.directory;
+    options.prefix = QString(m_portName).replace('/', '_');
+    options.rearm = settings.rearm;
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, options, matcher]() { reader->setTrigger(options, matcher); });
+
+    m_disarmAction->setEnabled(true);
+    m_statusLabel->setText(QString("Trigger armed on \"%1\"").arg(settings.patterns.trimmed()));
+    emit statusChanged(m_statusLabel->text());
+}
+
+void SerialTab::disarmTrigger() {
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader]() { reader->clearTrigger(); });
+    m_disarmAction->setEnabled(false);
+    m_statusLabel->setText("Trigger disarmed");
+    emit statusChanged(m_statusLabel->text());
+}
+
+void SerialTab::resumeView() {
+    m_viewPaused = false;
+    m_resumeAction->setEnabled(false);
+    if (isVisible()) refreshView();
+}
+
+// The view is brought up to the trigger line before it is frozen; lines
+// keep going into the store while it is paused.
+void SerialTab::onTriggerFired(const QString& path, const QByteArray& line) {
+    if (m_triggerSettings.pauseView && !m_viewPaused) {
+        drainRing();
+        m_viewPaused = true;
+        m_resumeAction->setEnabled(true);
+    }
+    if (m_triggerSettings.beep) QApplication::beep();
+    if (!m_triggerSettings.rearm) m_disarmAction->setEnabled(false);
+    m_statusLabel->setText(QString("Triggered: %1 (saving %2)")
+                               .arg(QString::fromUtf8(line).trimmed(), QFileInfo(path).fileName()));
+    emit statusChanged(m_statusLabel->text());
+}
+
+void SerialTab::onTriggerSaved(const QString& path, qint64 bytes, const QString& error) {
+    m_statusLabel->setText(error.isEmpty() ? QString("Trigger snapshot saved to %1 (%2)")
+                                                 .arg(path, QLocale().formattedDataSize(bytes))
+                                           : QString("Trigger snapshot %1 failed: %2").arg(path, error));
+    emit statusChanged(m_statusLabel->text());
 }
 
 void SerialTab::clearSend() {
@@ -152,72 +647,299 @@ void SerialTab::toggleLogging() {
     }
 
     QString defaultName = QString("uart_log_%1.txt").arg(m_portName);
-    QString path = QFileDialog::getSaveFileName(this, "Start Log", defaultName, "Text Files (*.txt);;All Files (*)");
+    QString path = QFileDialog::getSaveFileName(this, "Start Log", defaultName,
+                                                "Text Files (*.txt);;Compressed Logs (*.ulz);;All Files (*)");
     if (path.isEmpty()) return;
 
-    m_logFile = new QFile(path, this);
-    if (!m_logFile->open(QIODevice::WriteOnly | QIODevice::Text | QIODevice::Append)) {
-        QMessageBox::warning(this, "UART Log Viewer", "Failed to open log file.");
-        delete m_logFile;
-        m_logFile = nullptr;
+    LogWriter::Options options = m_logOptions;
+    options.format = CompressedLog::isCompressedLogPath(path) ? LogWriter::Format::Compressed
+                                                              : LogWriter::Format::PlainText;
+    auto writer = std::make_shared<LogWriter>(path, options);
+    QString error;
+    if (!writer->open(&error)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Failed to open log file: %1").arg(error));
         return;
     }
+    m_logWriter = writer;
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, writer]() { reader->setLogWriter(writer); }, Qt::BlockingQueuedConnection);
 
     m_logging = true;
     m_logBtn->setText("Stop Log");
     m_statusLabel->setText(QString("Logging to %1").arg(path));
     emit statusChanged(m_statusLabel->text());
+    updateLogStats();
 }
 
 void SerialTab::appendText(const QString& text) {
-    QTextCursor cursor = m_textEdit->textCursor();
-    cursor.movePosition(QTextCursor::End);
-    cursor.insertText(text);
-    m_textEdit->setTextCursor(cursor);
+    appendData(text.toUtf8());
 }
 
-void SerialTab::writeLog(const QString& text) {
-    if (!m_logging || !m_logFile) return;
-    m_logFile->write(text.toUtf8());
-    m_logFile->flush();
+void SerialTab::appendData(QByteArrayView utf8) {
+    const qint64 start = m_metrics.enabled() ? TimestampFormatter::monotonicNs() : 0;
+    m_store.append(utf8);
+    if (isVisible() && !m_viewPaused) {
+        refreshView();
+    } else {
+        m_viewStale = true;
+    }
+    if (start) m_metrics.recordAppend(quint64(TimestampFormatter::monotonicNs() - start));
 }
 
-void SerialTab::stopLogging(const QString& reason) {
-    if (!m_logging) return;
-    m_logging = false;
-    if (m_logFile) {
-        m_logFile->flush();
-        m_logFile->close();
-        m_logFile->deleteLater();
-        m_logFile = nullptr;
+void SerialTab::refreshView() {
+    m_viewStale = false;
+    if (m_logView->source() == &m_filtered) {
+        m_filtered.update();
+        updateFilterSummary();
     }
-    m_logBtn->setText("Log...");
-    if (!reason.isEmpty()) {
-        m_statusLabel->setText(reason);
+    m_logView->linesAppended();
+}
+
+// Hidden tabs keep draining their ring into the store, just less often, and
+// leave filtering and view updates until they are shown again.
+void SerialTab::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    m_drainTimer->setInterval(kDrainIntervalMs);
+    if (m_drainTimer->isActive()) drainRing();
+    if (m_viewStale && !m_viewPaused) refreshView();
+}
+
+void SerialTab::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    m_drainTimer->setInterval(kHiddenDrainIntervalMs);
+}
+
+void SerialTab::applyFilter() {
+    LineFilter filter;
+    QString error;
+    if (!filter.compile(m_filterBar->spec(), &error)) {
+        QMessageBox::warning(this, "UART Log Viewer", QString("Invalid filter: %1").arg(error));
+        return;
+    }
+
+    if (!filter.isActive()) {
+        m_logView->setSource(&m_store);
+        m_filterBar->setSummary(QString());
+    } else {
+        m_filtered.setFilter(filter, m_filterBar->mode());
+        m_logView->setSource(&m_filtered);
+        updateFilterSummary();
+    }
+    QScrollBar* bar = m_logView->verticalScrollBar();
+    bar->setValue(bar->maximum());
+}
+
+// Hex modes show the raw byte stream; the text filter only applies to text.
+void SerialTab::setViewMode(int mode) {
+    const bool hex = mode != 0;
+    m_filterBar->setVisible(!hex);
+    m_hexBar->setVisible(hex);
+    m_timeBar->setVisible(!hex);
+    if (!hex) {
+        applyFilter();
+        return;
+    }
+    m_hex.setShowAscii(mode == 2);
+    m_logView->setSource(&m_hex);
+    QScrollBar* bar = m_logView->verticalScrollBar();
+    bar->setValue(bar->maximum());
+}
+
+void SerialTab::goToOffset() {
+    bool ok = false;
+    const qint64 offset = m_offsetEdit->text().trimmed().toLongLong(&ok, 0);
+    if (!ok || offset < 0 || offset >= m_hex.endOffset()) {
+        QMessageBox::information(this, "UART Log Viewer", "Offset is outside the received data.");
+        return;
+    }
+    if (offset < m_hex.firstOffset()) {
+        QMessageBox::information(this, "UART Log Viewer",
+                                 QString("Only bytes from offset 0x%1 on are still held.")
+                                     .arg(m_hex.firstOffset(), 0, 16));
+        return;
+    }
+    m_hexHit = offset;
+    m_logView->setHighlight(qsizetype((offset - m_hex.firstOffset()) / HexDumpSource::kBytesPerRow),
+                            m_hex.columnForOffset(offset), 2);
+}
+
+// Every line's arrival time is recorded at ingest whether or not timestamps
+// are shown, so this works on any live tab; the lookup is a binary search.
+void SerialTab::goToTime() {
+    const LineSource* source = m_logView->source();
+    const qsizetype line = source->lineForTime(m_fromTimeEdit->dateTime().toMSecsSinceEpoch());
+    if (line < 0) {
+        m_statusLabel->setText("No lines to go to");
+        emit statusChanged(m_statusLabel->text());
+        return;
+    }
+    m_logView->setHighlight(line, 0, source->lineText(line).size());
+}
+
+void SerialTab::selectTimeRange() {
+    const LineSource* source = m_logView->source();
+    qint64 from = m_fromTimeEdit->dateTime().toMSecsSinceEpoch();
+    qint64 to = m_toTimeEdit->dateTime().toMSecsSinceEpoch();
+    if (from > to) std::swap(from, to);
+    const qsizetype first = source->lineForTime(from);
+    const qsizetype last = source->lineForTime(to);
+    if (first < 0 || last < 0) {
+        m_statusLabel->setText("No lines in that time range");
         emit statusChanged(m_statusLabel->text());
+        return;
     }
+    m_logView->selectLines(first, last);
+    m_statusLabel->setText(QString("Selected %1 lines").arg(last - first + 1));
+    emit statusChanged(m_statusLabel->text());
 }
 
-QString SerialTab::formatWithTimestamp(const QString& text) {
-    if (!m_timestampEnabled) return text;
+// Searches the raw bytes from just after the current position and wraps
+// once. A hit that runs onto the next row is highlighted on its first row.
+void SerialTab::findHexNext() {
+    QString digits = m_hexFindEdit->text();
+    digits.remove(' ');
+    static const QRegularExpression hexDigits("^[0-9A-Fa-f]+$");
+    if (digits.size() % 2 != 0 || !hexDigits.match(digits).hasMatch()) {
+        QMessageBox::warning(this, "UART Log Viewer", "Enter the bytes as hex, e.g. \"de ad be ef\".");
+        return;
+    }
+    const QByteArray pattern = QByteArray::fromHex(digits.toLatin1());
+
+    const QByteArrayMatcher matcher(pattern);
+    // m_hexHit is an absolute offset; the held bytes start at `base`.
+    const qint64 base = m_hex.firstOffset();
+    const qint64 from = qMax<qint64>(0, m_hexHit + 1 - base);
+    qint64 hit = matcher.indexIn(m_hex.bytes(), from);
+    if (hit < 0 && from > 0) hit = matcher.indexIn(m_hex.bytes(), 0);
+    if (hit < 0) {
+        QMessageBox::information(this, "UART Log Viewer", "Byte pattern not found.");
+        return;
+    }
+    m_hexHit = base + hit;
 
-    QString combined = m_lineBuffer + text;
-    QStringList lines = combined.split('\n');
-    m_lineBuffer = lines.takeLast();
+    const qint64 rowEnd = (hit / HexDumpSource::kBytesPerRow + 1) * HexDumpSource::kBytesPerRow;
+    const qint64 last = qMin<qint64>(hit + pattern.size(), rowEnd) - 1;
+    const qsizetype column = m_hex.columnForOffset(hit);
+    m_logView->setHighlight(qsizetype(hit / HexDumpSource::kBytesPerRow), column,
+                            m_hex.columnForOffset(last) + 2 - column);
+}
 
-    QString out;
-    for (const QString& line : lines) {
-        if (line.isEmpty()) {
-            out += "\n";
-            continue;
-        }
-        out += QString("%1 %2\n").arg(currentTimestamp(), line);
+void SerialTab::setRepeatMode(int index) {
+    const RepeatCollapser::Mode mode = index == 2   ? RepeatCollapser::Mode::IgnoreDigits
+                                       : index == 1 ? RepeatCollapser::Mode::Exact
+                                                    : RepeatCollapser::Mode::Off;
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader, mode]() { reader->setRepeatMode(mode); });
+}
+
+void SerialTab::editFraming() {
+    FramingDialog dlg(m_frameOptions, this);
+    if (dlg.exec() != QDialog::Accepted) return;
+    m_frameOptions = dlg.selectedOptions();
+    m_framingBtn->setText(m_frameOptions.kind == FrameOptions::Kind::None
+                              ? QString("Framing...")
+                              : QString("Framing: %1").arg(m_frameOptions.describe()));
+
+    SerialReader* reader = m_reader;
+    const FrameOptions options = m_frameOptions;
+    QMetaObject::invokeMethod(reader, [reader, options]() { reader->setFrameOptions(options); });
+}
+
+void SerialTab::updateFilterSummary() {
+    m_filterBar->setSummary(QString("%1 of %2 lines")
+                                .arg(QLocale().toString(qlonglong(m_filtered.matchedCount())))
+                                .arg(QLocale().toString(qlonglong(m_filtered.checkedCount()))));
+}
+
+TabMetrics::Snapshot SerialTab::metricsSnapshot() const {
+    TabMetrics::Snapshot snapshot = m_metrics.snapshot();
+    snapshot.droppedBytes = m_reader->droppedBytes();
+    if (m_logWriter) {
+        snapshot.logQueuedBytes = m_logWriter->queuedBytes();
+        snapshot.logLastWriteUs = m_logWriter->lastWriteUs();
+        snapshot.logMaxWriteUs = m_logWriter->maxWriteUs();
     }
-    return out;
+    return snapshot;
 }
 
-QString SerialTab::currentTimestamp() const {
-    const QDateTime now = QDateTime::currentDateTime().toTimeZone(m_timeZone);
-    const int ms = now.time().msec();
-    return QString("[%1]").arg(now.toString("dd-MM-yyyy HH:mm:ss:") + QString("%1").arg(ms, 3, 10, QChar('0')));
+void SerialTab::setMetricsExported(bool exported) {
+    if (m_metricsExported == exported) return;
+    m_metricsExported = exported;
+    updateMetricsEnabled();
+}
+
+void SerialTab::updateMetricsEnabled() {
+    m_metrics.setEnabled(m_metricsExported || m_statsBtn->isChecked());
+}
+
+void SerialTab::toggleStats(bool visible) {
+    m_statsPanel->setVisible(visible);
+    updateMetricsEnabled();
+    if (visible) {
+        m_lastSnapshot = metricsSnapshot();
+        m_metricsTimer->start();
+    } else {
+        m_metricsTimer->stop();
+    }
+}
+
+void SerialTab::refreshStats() {
+    const TabMetrics::Snapshot now = metricsSnapshot();
+    m_statsPanel->showInterval(now, m_lastSnapshot);
+    m_lastSnapshot = now;
+}
+
+void SerialTab::updateLogStats() {
+    m_statsClock.restart();
+    if (!m_logWriter) {
+        m_logStatsLabel->clear();
+        return;
+    }
+    const QString error = m_logWriter->errorString();
+    if (!error.isEmpty()) {
+        m_logStatsLabel->setText(QString("Log error: %1 (%2 lost)")
+                                     .arg(error, QLocale().formattedDataSize(m_logWriter->droppedBytes())));
+        return;
+    }
+    QString text = QString("Log queue: %1, write %2 ms (max %3 ms)")
+                       .arg(QLocale().formattedDataSize(m_logWriter->queuedBytes()))
+                       .arg(m_logWriter->lastWriteUs() / 1000.0, 0, 'f', 1)
+                       .arg(m_logWriter->maxWriteUs() / 1000.0, 0, 'f', 1);
+    if (m_logWriter->droppedBytes() > 0) {
+        text += QString(", %1 lost").arg(QLocale().formattedDataSize(m_logWriter->droppedBytes()));
+    }
+    m_logStatsLabel->setText(text);
+}
+
+void SerialTab::updateMemoryLabel() {
+    m_memoryClock.restart();
+    const QLocale locale;
+    QString text = QString("Scrollback: %1").arg(locale.formattedDataSize(m_store.residentBytes()));
+    if (m_store.spilledBytes() > 0) {
+        text += QString(" + %1 on disk").arg(locale.formattedDataSize(m_store.spilledBytes()));
+    }
+    if (m_hex.residentBytes() > 0) {
+        text += QString(", hex %1").arg(locale.formattedDataSize(m_hex.residentBytes()));
+    }
+    m_memoryLabel->setText(text);
+    m_memoryLabel->setToolTip(m_store.spillError().isEmpty()
+                                  ? QString()
+                                  : QString("Could not move scrollback to disk: %1").arg(m_store.spillError()));
+}
+
+void SerialTab::stopLogging(const QString& reason) {
+    if (!m_logging) return;
+    m_logging = false;
+    SerialReader* reader = m_reader;
+    QMetaObject::invokeMethod(reader, [reader]() { reader->setLogWriter(nullptr); }, Qt::BlockingQueuedConnection);
+    if (m_logWriter) {
+        m_logWriter->close();
+        m_logWriter.reset();
+    }
+    updateLogStats();
+    m_logBtn->setText("Log...");
+    if (!reason.isEmpty()) {
+        m_statusLabel->setText(reason);
+        emit statusChanged(m_statusLabel->text());
+    }
 }
@@ -1,16 +1,31 @@
 #pragma once
 
 #include <QWidget>
-#include <QSerialPort>
-#include <QTextEdit>
 #include <QComboBox>
 #include <QPushButton>
 #include <QLineEdit>
 #include <QLabel>
 #include <QCheckBox>
 #include <QDateTime>
+#include <QDateTimeEdit>
 #include <QTimeZone>
-#include <QFile>
+#include <QThread>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include <memory>
+
+#include "filterbar.h"
+#include "framedecoder.h"
+#include "hexdumpsource.h"
+#include "linefilter.h"
+#include "linestore.h"
+#include "logview.h"
+#include "logwriter.h"
+#include "serialreader.h"
+#include "statspanel.h"
+#include "triggerdialog.h"
+#include "spscring.h"
 
 class SerialTab : public QWidget {
     Q_OBJECT
@@ -19,44 +34,151 @@ public:
     ~SerialTab() override;
 
     QString portName() const { return m_portName; }
-    void setTimestampEnabled(bool enabled) { m_timestampEnabled = enabled; }
-    void setTimeZone(const QTimeZone& tz) { m_timeZone = tz; }
+    bool isConnected() const { return m_connected; }
+    void connectPort();
+    quint64 droppedBytes() const { return m_reader->droppedBytes(); }
+    // Moves everything the reader has produced so far into the line store.
+    void drainNow() { drainRing(); }
+
+    TabMetrics::Snapshot metricsSnapshot() const;
+    void setMetricsExported(bool exported);
+    void setTimestampEnabled(bool enabled);
+    void setTimeZone(const QTimeZone& tz);
+    void setTimestampMode(TimestampFormatter::Mode mode);
+    void setLogOptions(const LogWriter::Options& options);
 
     void appendText(const QString& text);
-    QTextEdit* textEdit() const { return m_textEdit; }
+    LogView* logView() const { return m_logView; }
+    const LineStore& lineStore() const { return m_store; }
 
 signals:
     void statusChanged(const QString& status);
 
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
 private slots:
     void toggleConnect();
-    void onReadyRead();
-    void onErrorOccurred(QSerialPort::SerialPortError error);
+    void drainReader();
+    void onOpened(bool ok, const QString& error);
+    void onClosed();
+    void onPortLost(bool reconnecting);
+    void onReconnected(qint64 downNs, qint64 reopenNs);
+    void setAutoReconnect(bool enabled);
     void sendLine();
+    void sendFile();
+    void runScript();
+    void stopTransmit();
+    void onTransmitProgress(qint64 sent, qint64 total, qint64 bytesPerSec);
+    void onTransmitFinished(bool ok, const QString& error);
+    void armTrigger();
+    void disarmTrigger();
+    void resumeView();
+    void onTriggerFired(const QString& path, const QByteArray& line);
+    void onTriggerSaved(const QString& path, qint64 bytes, const QString& error);
     void clearSend();
     void toggleLogging();
+    void applyFilter();
+    void setViewMode(int mode);
+    void goToOffset();
+    void goToTime();
+    void selectTimeRange();
+    void findHexNext();
+    void editFraming();
+    void setRepeatMode(int index);
+    void toggleStats(bool visible);
+    void refreshStats();
+    void toggleCapture();
+    void stopReplay();
+    void onReplayStarted(bool ok, const QString& error);
+    void onReplayFinished(qint64 bytes, qint64 elapsedNs);
 
 private:
-    QString formatWithTimestamp(const QString& text);
-    QString currentTimestamp() const;
+    void drainRing();
+    void applyRepeats(qsizetype count);
+    void appendData(QByteArrayView utf8);
+    void refreshView();
     void setConnectedUi(bool connected);
+    void updateDroppedLabel();
+    void updateFilterSummary();
+    void updateMetricsEnabled();
     void stopLogging(const QString& reason = QString());
-    void writeLog(const QString& text);
+    void stopCapture(const QString& reason = QString());
+    void startReplay(bool realTime);
+    void startTransmit(const QList<TransmitEngine::Step>& steps);
+    void updateLogStats();
+    void updateMemoryLabel();
 
     QString m_portName;
-    QSerialPort m_serial;
-    QTextEdit* m_textEdit;
+    SpscRing m_ring;
+    SpscRing m_rawRing;
+    SpscRing m_timeRing;
+    SpscRing m_repeatRing;
+    QThread* m_readerThread;
+    SerialReader* m_reader;
+    QTimer* m_drainTimer;
+    QByteArray m_drainBuffer;
+    QVector<qint64> m_timeBuffer;
+    QVector<RepeatEvent> m_repeatBuffer;
+    quint64 m_shownDropped = 0;
+    quint64 m_shownRawDropped = 0;
+    bool m_viewStale = false;
+    bool m_connected = false;
+    bool m_reconnecting = false;
+
+    LineStore m_store;
+    FilteredLineSource m_filtered{&m_store};
+    FilterBar* m_filterBar;
+
+    HexDumpSource m_hex;
+    QComboBox* m_viewCombo;
+    QWidget* m_hexBar;
+    QWidget* m_timeBar;
+    QDateTimeEdit* m_fromTimeEdit;
+    QDateTimeEdit* m_toTimeEdit;
+    QLineEdit* m_offsetEdit;
+    QLineEdit* m_hexFindEdit;
+    qint64 m_hexHit = -1;
+
+    FrameOptions m_frameOptions;
+    QPushButton* m_framingBtn;
+    QComboBox* m_repeatCombo;
+
+    TabMetrics m_metrics;
+    TabMetrics::Snapshot m_lastSnapshot;
+    StatsPanel* m_statsPanel;
+    QPushButton* m_statsBtn;
+    QTimer* m_metricsTimer;
+    bool m_metricsExported = false;
+    LogView* m_logView;
     QComboBox* m_baudCombo;
     QPushButton* m_connectBtn;
+    QCheckBox* m_autoReconnectBox;
     QLineEdit* m_sendEdit;
     QPushButton* m_sendBtn;
     QPushButton* m_clearBtn;
     QPushButton* m_logBtn;
+    QPushButton* m_captureBtn;
+    QPushButton* m_replayBtn;
+    QPushButton* m_transmitBtn;
+    QLabel* m_transmitLabel;
+    QPushButton* m_triggerBtn;
+    QAction* m_disarmAction;
+    QAction* m_resumeAction;
+    TriggerDialog::Settings m_triggerSettings;
+    bool m_viewPaused = false;
+    bool m_bulkTransmit = false;
     QLabel* m_statusLabel;
+    QLabel* m_droppedLabel;
+
+    QLabel* m_logStatsLabel;
+    QLabel* m_memoryLabel;
+    QElapsedTimer m_statsClock;
+    QElapsedTimer m_memoryClock;
 
-    bool m_timestampEnabled = false;
-    QTimeZone m_timeZone;
-    QString m_lineBuffer;
     bool m_logging = false;
-    QFile* m_logFile = nullptr;
+    LogWriter::Options m_logOptions;
+    std::shared_ptr<LogWriter> m_logWriter;
+    std::shared_ptr<LogWriter> m_captureWriter;
 };
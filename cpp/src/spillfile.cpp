@@ -0,0 +1,57 @@
+#include "spillfile.h"
+
+#include <QDir>
+
+static const qint64 kSegmentBytes = 64 * 1024 * 1024;
+
+const char* SpillFile::append(std::initializer_list<Piece> pieces, QString* error) {
+    qint64 total = 0;
+    for (const Piece& piece : pieces) total += aligned(piece.size);
+
+    if (m_segments.empty() || m_segments.back().size - m_segments.back().used < total) {
+        if (!addSegment(qMax(kSegmentBytes, total), error)) return nullptr;
+    }
+    Segment& segment = m_segments.back();
+    const qint64 start = segment.used;
+    if (!segment.file->seek(start)) {
+        *error = segment.file->errorString();
+        return nullptr;
+    }
+    static const char padding[8] = {};
+    for (const Piece& piece : pieces) {
+        const qint64 pad = aligned(piece.size) - piece.size;
+        if (segment.file->write(static_cast<const char*>(piece.data), piece.size) != piece.size
+            || segment.file->write(padding, pad) != pad) {
+            *error = segment.file->errorString();
+            return nullptr;
+        }
+    }
+    // QFileDevice keeps small writes in its own buffer; the mapping only sees
+    // them once they reach the file, and a full disk only shows up here.
+    if (!segment.file->flush()) {
+        *error = segment.file->errorString();
+        return nullptr;
+    }
+    segment.used += total;
+    m_bytes += total;
+    return reinterpret_cast<const char*>(segment.map + start);
+}
+
+// The file is sized up front, sparsely, so the whole segment can be mapped
+// once before anything is written to it.
+bool SpillFile::addSegment(qint64 size, QString* error) {
+    Segment segment;
+    segment.file = std::make_unique<QTemporaryFile>(QDir::tempPath() + "/uart-log-viewer-XXXXXX.spill");
+    if (!segment.file->open() || !segment.file->resize(size)) {
+        *error = segment.file->errorString();
+        return false;
+    }
+    segment.map = segment.file->map(0, size);
+    if (!segment.map) {
+        *error = segment.file->errorString();
+        return false;
+    }
+    segment.size = size;
+    m_segments.push_back(std::move(segment));
+    return true;
+}
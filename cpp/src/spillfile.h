@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QString>
+#include <QTemporaryFile>
+
+#include <memory>
+#include <vector>
+
+// Append-only temporary storage that cold scrollback is moved into. Data is
+// written with ordinary writes, so a full disk is an error rather than a
+// fault, and read back through one read-only mapping per segment file, so it
+// costs page cache the kernel can reclaim instead of heap. Each segment is
+// its own temp file: a file cannot grow while it is mapped on every
+// platform. All temp files are removed when the SpillFile is destroyed.
+class SpillFile {
+public:
+    // Copies the pieces in back to back, each 8-byte aligned, and returns
+    // the address of the first one, or nullptr with `error` set.
+    struct Piece {
+        const void* data;
+        qsizetype size;
+    };
+    const char* append(std::initializer_list<Piece> pieces, QString* error);
+    static qint64 aligned(qint64 size) { return (size + 7) & ~qint64(7); }
+
+    qint64 bytes() const { return m_bytes; }
+
+private:
+    struct Segment {
+        std::unique_ptr<QTemporaryFile> file;
+        const uchar* map = nullptr;
+        qint64 size = 0;
+        qint64 used = 0;
+    };
+
+    bool addSegment(qint64 size, QString* error);
+
+    std::vector<Segment> m_segments;
+    qint64 m_bytes = 0;
+};
@@ -0,0 +1,45 @@
+#include "spscring.h"
+
+#include <algorithm>
+#include <cstring>
+
+static std::size_t roundUpPow2(std::size_t v) {
+    std::size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+SpscRing::SpscRing(std::size_t capacity)
+    : m_buffer(roundUpPow2(std::max<std::size_t>(capacity, 64))),
+      m_mask(m_buffer.size() - 1) {}
+
+bool SpscRing::write(const char* data, std::size_t size) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    const std::size_t tail = m_tail.load(std::memory_order_acquire);
+    if (size > m_buffer.size() - (head - tail)) return false;
+
+    const std::size_t offset = head & m_mask;
+    const std::size_t first = std::min(size, m_buffer.size() - offset);
+    std::memcpy(m_buffer.data() + offset, data, first);
+    std::memcpy(m_buffer.data(), data + first, size - first);
+    m_head.store(head + size, std::memory_order_release);
+    return true;
+}
+
+std::size_t SpscRing::read(char* out, std::size_t maxSize) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    const std::size_t head = m_head.load(std::memory_order_acquire);
+    const std::size_t size = std::min(maxSize, head - tail);
+    if (size == 0) return 0;
+
+    const std::size_t offset = tail & m_mask;
+    const std::size_t first = std::min(size, m_buffer.size() - offset);
+    std::memcpy(out, m_buffer.data() + offset, first);
+    std::memcpy(out + first, m_buffer.data(), size - first);
+    m_tail.store(tail + size, std::memory_order_release);
+    return size;
+}
+
+std::size_t SpscRing::size() const {
+    return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+// Lock-free single-producer/single-consumer byte ring. The producer (a reader
+// thread) only calls write(), the consumer (the GUI) only calls read().
+class SpscRing {
+public:
+    explicit SpscRing(std::size_t capacity);
+
+    bool write(const char* data, std::size_t size);
+    std::size_t read(char* out, std::size_t maxSize);
+
+    std::size_t size() const;
+    std::size_t capacity() const { return m_buffer.size(); }
+
+private:
+    std::vector<char> m_buffer;
+    std::size_t m_mask;
+    alignas(64) std::atomic<std::size_t> m_head{0};
+    alignas(64) std::atomic<std::size_t> m_tail{0};
+};
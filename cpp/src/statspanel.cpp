@@ -0,0 +1,62 @@
+#include "statspanel.h"
+
+#include <QFormLayout>
+#include <QJsonArray>
+#include <QLocale>
+
+static QString histogramText(const QJsonObject& h, const QString& unit) {
+    return QString("mean %1 %4, p50 %2 %4, p99 %3 %4")
+        .arg(h["mean"].toDouble(), 0, 'f', 1)
+        .arg(h["p50"].toDouble(), 0, 'f', 1)
+        .arg(h["p99"].toDouble(), 0, 'f', 1)
+        .arg(unit);
+}
+
+StatsPanel::StatsPanel(QWidget* parent)
+    : QWidget(parent) {
+    m_throughput = new QLabel(this);
+    m_reads = new QLabel(this);
+    m_ingest = new QLabel(this);
+    m_append = new QLabel(this);
+    m_log = new QLabel(this);
+    m_errors = new QLabel(this);
+
+    auto form = new QFormLayout(this);
+    form->setContentsMargins(0, 0, 0, 0);
+    form->addRow("Throughput:", m_throughput);
+    form->addRow("Reads:", m_reads);
+    form->addRow("Ingest:", m_ingest);
+    form->addRow("Append:", m_append);
+    form->addRow("Log writer:", m_log);
+    form->addRow("Serial errors:", m_errors);
+}
+
+void StatsPanel::showInterval(const TabMetrics::Snapshot& now, const TabMetrics::Snapshot& previous) {
+    const QJsonObject m = TabMetrics::toJson(now, previous);
+    const QLocale locale;
+
+    m_throughput->setText(QString("%1/s, %2 lines/s, %3 dropped")
+                              .arg(locale.formattedDataSize(qint64(m["bytes_per_s"].toDouble())))
+                              .arg(locale.toString(qlonglong(m["lines_per_s"].toDouble())))
+                              .arg(locale.formattedDataSize(m["dropped_bytes"].toInteger())));
+    m_reads->setText(QString("%1/s, size %2")
+                         .arg(m["reads_per_s"].toDouble(), 0, 'f', 0)
+                         .arg(histogramText(m["read_bytes"].toObject(), "B")));
+    m_ingest->setText(histogramText(m["ingest_us"].toObject(), "µs"));
+    m_append->setText(histogramText(m["append_us"].toObject(), "µs"));
+    if (m.contains("log_queue_bytes")) {
+        m_log->setText(QString("queue %1, write %2 µs (max %3 µs)")
+                           .arg(locale.formattedDataSize(m["log_queue_bytes"].toInteger()))
+                           .arg(m["log_write_last_us"].toInteger())
+                           .arg(m["log_write_max_us"].toInteger()));
+    } else {
+        m_log->setText("Not logging");
+    }
+
+    const QJsonObject errors = m["serial_errors"].toObject();
+    QStringList parts;
+    for (auto it = errors.begin(); it != errors.end(); ++it) {
+        parts.append(QString("%1: %2").arg(it.key()).arg(it.value().toInteger()));
+    }
+    m_errors->setText(parts.isEmpty() ? QString("None") : parts.join(", "));
+}
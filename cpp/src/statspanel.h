@@ -0,0 +1,23 @@
+#pragma once
+
+#include <QLabel>
+#include <QWidget>
+
+#include "metrics.h"
+
+// Read-only view of a tab's TabMetrics over the last refresh interval.
+class StatsPanel : public QWidget {
+    Q_OBJECT
+public:
+    explicit StatsPanel(QWidget* parent = nullptr);
+
+    void showInterval(const TabMetrics::Snapshot& now, const TabMetrics::Snapshot& previous);
+
+private:
+    QLabel* m_throughput;
+    QLabel* m_reads;
+    QLabel* m_ingest;
+    QLabel* m_append;
+    QLabel* m_log;
+    QLabel* m_errors;
+};
@@ -0,0 +1,41 @@
+#include "timelinedialog.h"
+
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+TimelineDialog::TimelineDialog(const QStringList& ports, QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Merged Timeline");
+
+    m_list = new QListWidget(this);
+    for (const QString& port : ports) {
+        auto item = new QListWidgetItem(port, m_list);
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Checked);
+    }
+
+    auto okBtn = new QPushButton("Open", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, &QDialog::accept);
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addWidget(new QLabel("Ports to merge:", this));
+    layout->addWidget(m_list);
+    layout->addLayout(buttons);
+}
+
+QList<int> TimelineDialog::selectedIndexes() const {
+    QList<int> indexes;
+    for (int i = 0; i < m_list->count(); ++i) {
+        if (m_list->item(i)->checkState() == Qt::Checked) indexes << i;
+    }
+    return indexes;
+}
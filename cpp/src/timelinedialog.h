@@ -0,0 +1,16 @@
+#pragma once
+
+#include <QDialog>
+#include <QListWidget>
+
+// Picks the serial tabs to merge into a timeline.
+class TimelineDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit TimelineDialog(const QStringList& ports, QWidget* parent = nullptr);
+
+    QList<int> selectedIndexes() const;
+
+private:
+    QListWidget* m_list;
+};
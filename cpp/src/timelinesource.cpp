@@ -0,0 +1,199 @@
+#include "timelinesource.h"
+
+void TimelineSource::addInput(const LineStore* store, const QString& tag, quint32 color) {
+    Input input;
+    input.store = store;
+    input.tag = QString("[%1]").arg(tag).toUtf8();
+    input.color = color;
+    m_tagWidth = qMax(m_tagWidth, input.tag.size() + 1);
+    m_inputs.append(input);
+    invalidate();
+}
+
+void TimelineSource::removeInput(const LineStore* store) {
+    m_tagWidth = 0;
+    for (qsizetype i = m_inputs.size() - 1; i >= 0; --i) {
+        if (m_inputs[i].store == store) {
+            m_count -= m_inputs[i].count;
+            m_inputs.remove(i);
+        } else {
+            m_tagWidth = qMax(m_tagWidth, m_inputs[i].tag.size() + 1);
+        }
+    }
+    updateLast();
+    invalidate();
+}
+
+bool TimelineSource::update(qint64 untilNs, bool* inserted) {
+    for (const Input& input : m_inputs) {
+        const qint64 open = input.store->openLineTime();
+        if (open >= 0) untilNs = qMin(untilNs, open);
+    }
+
+    bool before = false;
+    qsizetype total = 0;
+    for (int i = 0; i < m_inputs.size(); ++i) {
+        Input& input = m_inputs[i];
+        const qsizetype end = input.store->timedLineCount();
+        const qsizetype from = qMin(input.count, end);
+        input.count = input.store->lowerBoundTime(untilNs, from, end);
+        if (input.count > from) {
+            const qint64 first = input.store->lineTime(from);
+            if (first < m_lastNs || (first == m_lastNs && i < m_lastInput)) before = true;
+        }
+        total += input.count;
+    }
+    if (inserted) *inserted = before;
+    if (total == m_count) return false;
+    m_count = total;
+    updateLast();
+    invalidate();
+    return true;
+}
+
+// The last row is the latest last line, the later input winning ties.
+void TimelineSource::updateLast() {
+    m_lastNs = std::numeric_limits<qint64>::min();
+    m_lastInput = -1;
+    for (int i = 0; i < m_inputs.size(); ++i) {
+        if (m_inputs[i].count == 0) continue;
+        const qint64 time = m_inputs[i].store->lineTime(m_inputs[i].count - 1);
+        if (time >= m_lastNs) {
+            m_lastNs = time;
+            m_lastInput = i;
+        }
+    }
+}
+
+void TimelineSource::invalidate() {
+    m_cursorRow = -1;
+    m_row = -1;
+}
+
+// The earliest line under the cursors; ties go to the earlier input.
+int TimelineSource::nextInput() const {
+    int best = -1;
+    qint64 bestTime = 0;
+    for (int i = 0; i < m_inputs.size(); ++i) {
+        if (m_cursor[i] >= m_inputs[i].count) continue;
+        const qint64 time = m_inputs[i].store->lineTime(m_cursor[i]);
+        if (best < 0 || time < bestTime) {
+            best = i;
+            bestTime = time;
+        }
+    }
+    return best;
+}
+
+// Positions the cursors so that exactly `row` lines precede them: find the
+// smallest time T with more than `row` lines at or before it, take every
+// line before T and then lines at T in input order.
+void TimelineSource::seek(qsizetype row) const {
+    m_cursor.resize(m_inputs.size());
+    auto store = [this](int i) { return m_inputs[i].store; };
+
+    qint64 lo = std::numeric_limits<qint64>::max();
+    qint64 hi = std::numeric_limits<qint64>::min();
+    for (int i = 0; i < m_inputs.size(); ++i) {
+        if (m_inputs[i].count == 0) continue;
+        lo = qMin(lo, store(i)->lineTime(0));
+        hi = qMax(hi, store(i)->lineTime(m_inputs[i].count - 1));
+    }
+    while (lo < hi) {
+        const qint64 mid = lo + qint64(quint64(hi - lo) / 2);
+        qsizetype atOrBefore = 0;
+        for (int i = 0; i < m_inputs.size(); ++i) {
+            atOrBefore += store(i)->upperBoundTime(mid, 0, m_inputs[i].count);
+        }
+        if (atOrBefore > row) hi = mid;
+        else lo = mid + 1;
+    }
+
+    qsizetype remaining = row;
+    for (int i = 0; i < m_inputs.size(); ++i) {
+        m_cursor[i] = store(i)->lowerBoundTime(lo, 0, m_inputs[i].count);
+        remaining -= m_cursor[i];
+    }
+    for (int i = 0; i < m_inputs.size() && remaining > 0; ++i) {
+        const qsizetype equal = store(i)->upperBoundTime(lo, m_cursor[i], m_inputs[i].count) - m_cursor[i];
+        const qsizetype take = qMin(equal, remaining);
+        m_cursor[i] += take;
+        remaining -= take;
+    }
+    m_cursorRow = row;
+}
+
+// Painting asks for the same row several times and then the next one, so
+// the last row is cached and the cursors only step forward between rows.
+bool TimelineSource::locate(qsizetype row) const {
+    if (row < 0 || row >= m_count) return false;
+    if (row == m_row) return true;
+    if (row != m_cursorRow) seek(row);
+    m_rowInput = nextInput();
+    m_rowLine = m_cursor[m_rowInput]++;
+    ++m_cursorRow;
+    m_row = row;
+    return true;
+}
+
+QByteArrayView TimelineSource::line(qsizetype index) const {
+    if (!locate(index)) return {};
+    const Input& input = m_inputs[m_rowInput];
+    m_text.resize(0);
+    m_text.append(input.tag);
+    m_text.resize(m_tagWidth, ' ');
+    m_text.append(input.store->line(m_rowLine));
+    return m_text;
+}
+
+qsizetype TimelineSource::longestLine() const {
+    qsizetype longest = 0;
+    for (const Input& input : m_inputs) longest = qMax(longest, input.store->longestLine());
+    return longest + m_tagWidth;
+}
+
+QVector<StyleRun> TimelineSource::styleRuns(qsizetype index) const {
+    QVector<StyleRun> runs;
+    if (!locate(index)) return runs;
+    const Input& input = m_inputs[m_rowInput];
+    TextStyle tagStyle;
+    tagStyle.fg = input.color;
+    tagStyle.flags = TextStyle::Bold;
+    runs.append({0, tagStyle});
+    runs.append({input.tag.size(), TextStyle()});
+    for (const StyleRun& run : input.store->styleRuns(m_rowLine)) runs.append({run.offset + m_tagWidth, run.style});
+    return runs;
+}
+
+QString TimelineSource::lineNote(qsizetype index) const {
+    if (!locate(index)) return {};
+    return m_inputs[m_rowInput].store->lineNote(m_rowLine);
+}
+
+// Rows are in time order, so the rows at or before a time are just the
+// lines at or before it in every input.
+qsizetype TimelineSource::lineForTime(qint64 ms) const {
+    if (m_count == 0) return -1;
+    const qint64 ns = ms * 1000000;
+    qsizetype atOrBefore = 0;
+    for (const Input& input : m_inputs) {
+        atOrBefore += input.store->upperBoundTime(ns, 0, input.count);
+    }
+    return qMax<qsizetype>(0, atOrBefore - 1);
+}
+
+qint64 TimelineSource::firstTime() const {
+    qint64 first = std::numeric_limits<qint64>::max();
+    for (const Input& input : m_inputs) {
+        if (input.count > 0) first = qMin(first, input.store->lineTime(0));
+    }
+    return m_count > 0 ? first / 1000000 : 0;
+}
+
+qint64 TimelineSource::lastTime() const {
+    qint64 last = std::numeric_limits<qint64>::min();
+    for (const Input& input : m_inputs) {
+        if (input.count > 0) last = qMax(last, input.store->lineTime(input.count - 1));
+    }
+    return m_count > 0 ? last / 1000000 : 0;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include <limits>
+
+#include "linesource.h"
+#include "linestore.h"
+
+// Interleaves the timed lines of several LineStores by arrival time, ties
+// going to the earlier input, and prefixes each with a coloured port tag.
+// Nothing is merged up front: a row is found by binary searching the time
+// it falls at, then one cursor per input walks forward in a k-way merge, so
+// a repaint costs one seek plus a step per visible row.
+class TimelineSource : public LineSource {
+public:
+    void addInput(const LineStore* store, const QString& tag, quint32 color);
+    // The store is not touched, so this is safe while it is being destroyed.
+    void removeInput(const LineStore* store);
+    int inputCount() const { return int(m_inputs.size()); }
+
+    // Takes in lines that started before `untilNs` and before any input's
+    // unfinished line, which would otherwise land among rows already shown.
+    // Returns true when rows were added; `inserted` is set when some of them
+    // still sort before the last row already merged.
+    bool update(qint64 untilNs, bool* inserted = nullptr);
+
+    qsizetype lineCount() const override { return m_count; }
+    QByteArrayView line(qsizetype index) const override;
+    qsizetype longestLine() const override;
+    QVector<StyleRun> styleRuns(qsizetype index) const override;
+    QString lineNote(qsizetype index) const override;
+    bool hasTimeIndex() const override { return m_count > 0; }
+    qsizetype lineForTime(qint64 ms) const override;
+    qint64 firstTime() const override;
+    qint64 lastTime() const override;
+
+private:
+    struct Input {
+        const LineStore* store = nullptr;
+        QByteArray tag;
+        quint32 color = 0;
+        qsizetype count = 0;
+    };
+
+    bool locate(qsizetype row) const;
+    void seek(qsizetype row) const;
+    int nextInput() const;
+    void invalidate();
+    void updateLast();
+
+    QVector<Input> m_inputs;
+    qsizetype m_count = 0;
+    qsizetype m_tagWidth = 0;
+    // Time and input of the last merged row.
+    qint64 m_lastNs = std::numeric_limits<qint64>::min();
+    int m_lastInput = -1;
+
+    mutable QVector<qsizetype> m_cursor;
+    mutable qsizetype m_cursorRow = -1;
+    mutable qsizetype m_row = -1;
+    mutable int m_rowInput = -1;
+    mutable qsizetype m_rowLine = -1;
+    mutable QByteArray m_text;
+};
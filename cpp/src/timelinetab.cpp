@@ -0,0 +1,99 @@
+#include "timelinetab.h"
+
+#include <QHBoxLayout>
+#include <QLocale>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+#include <iterator>
+
+#include "serialtab.h"
+#include "timestampformatter.h"
+
+static const int kRefreshIntervalMs = 50;
+static const int kSettleMs = 250;
+
+// Port tag colours, readable on both the dark and the light theme.
+static const quint32 kTagColors[] = {
+    0xFF2E9BD6, 0xFFD9822B, 0xFF3FA34D, 0xFF9C5CC4,
+    0xFFCF4A4A, 0xFF1FA39A, 0xFFB5942A, 0xFFC2569A,
+};
+
+TimelineTab::TimelineTab(const QList<SerialTab*>& tabs, QWidget* parent)
+    : QWidget(parent) {
+
+    m_logView = new LogView(&m_source, this);
+
+    for (int i = 0; i < tabs.size(); ++i) {
+        SerialTab* tab = tabs[i];
+        const LineStore* store = &tab->lineStore();
+        const QString port = tab->portName();
+        m_tabs.append(tab);
+        m_ports.append(port);
+        m_source.addInput(store, port, kTagColors[i % std::size(kTagColors)]);
+        connect(tab, &QObject::destroyed, this, [this, store, port]() {
+            m_ports.removeOne(port);
+            m_source.removeInput(store);
+            m_logView->setSource(&m_source);
+            updateLabels();
+        });
+    }
+
+    auto closeBtn = new QPushButton("Close", this);
+    connect(closeBtn, &QPushButton::clicked, this, &TimelineTab::closeRequested);
+
+    m_portsLabel = new QLabel(this);
+    m_statusLabel = new QLabel(this);
+
+    auto topRow = new QHBoxLayout();
+    topRow->addWidget(m_portsLabel);
+    topRow->addStretch();
+    topRow->addWidget(closeBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(topRow);
+    layout->addWidget(m_logView);
+    layout->addWidget(m_statusLabel);
+
+    m_refreshTimer = new QTimer(this);
+    m_refreshTimer->setInterval(kRefreshIntervalMs);
+    connect(m_refreshTimer, &QTimer::timeout, this, &TimelineTab::refresh);
+
+    updateLabels();
+}
+
+void TimelineTab::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    refresh();
+    m_refreshTimer->start();
+}
+
+void TimelineTab::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    m_refreshTimer->stop();
+}
+
+// Draining first brings in what the readers have published; lines still in
+// a reader are covered by taking only those older than kSettleMs, and
+// unfinished lines are held back by the source. Should rows still land
+// above the end (a clock step, say), the rows on screen have moved, so the
+// view is reset rather than told lines were appended.
+void TimelineTab::refresh() {
+    const qint64 now = TimestampFormatter::wallClockNs();
+    for (const QPointer<SerialTab>& tab : m_tabs) {
+        if (tab) tab->drainNow();
+    }
+    bool inserted = false;
+    if (!m_source.update(now - qint64(kSettleMs) * 1000000, &inserted)) return;
+    if (inserted) {
+        m_logView->reset();
+    } else {
+        m_logView->linesAppended();
+    }
+    updateLabels();
+}
+
+void TimelineTab::updateLabels() {
+    m_portsLabel->setText(QString("Timeline: %1").arg(m_ports.join(", ")));
+    m_statusLabel->setText(QString("%1 lines").arg(QLocale().toString(qlonglong(m_source.lineCount()))));
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <QWidget>
+#include <QLabel>
+#include <QList>
+#include <QPointer>
+#include <QStringList>
+#include <QTimer>
+
+#include "logview.h"
+#include "timelinesource.h"
+
+class SerialTab;
+
+// Pseudo-tab that merges the lines of several serial tabs by arrival time.
+// While visible it drains its tabs and takes in newly completed lines on a
+// timer; hidden, it does no work.
+class TimelineTab : public QWidget {
+    Q_OBJECT
+public:
+    explicit TimelineTab(const QList<SerialTab*>& tabs, QWidget* parent = nullptr);
+
+    LogView* logView() const { return m_logView; }
+    const LineSource& source() const { return m_source; }
+
+signals:
+    void closeRequested();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private slots:
+    void refresh();
+
+private:
+    void updateLabels();
+
+    QList<QPointer<SerialTab>> m_tabs;
+    QStringList m_ports;
+    TimelineSource m_source;
+    LogView* m_logView;
+    QLabel* m_portsLabel;
+    QLabel* m_statusLabel;
+    QTimer* m_refreshTimer;
+};
@@ -0,0 +1,106 @@
+#include "timestampformatter.h"
+
+#include <QDateTime>
+
+#include <chrono>
+#include <cstring>
+
+static const qint64 kNsPerSec = 1000000000;
+
+static char* writeDigits(char* p, quint64 value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        p[i] = char('0' + value % 10);
+        value /= 10;
+    }
+    return p + width;
+}
+
+static char* writeNumber(char* p, quint64 value) {
+    char tmp[20];
+    int n = 0;
+    do {
+        tmp[n++] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (n) *p++ = tmp[--n];
+    return p;
+}
+
+qint64 TimestampFormatter::monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 TimestampFormatter::wallClockNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void TimestampFormatter::setTimeZone(const QTimeZone& tz) {
+    m_timeZone = tz;
+    m_cachedSecond = -1;
+}
+
+void TimestampFormatter::start(qint64 monoNs) {
+    start(monoNs, wallClockNs());
+}
+
+void TimestampFormatter::start(qint64 monoNs, qint64 wallNs) {
+    m_anchorMonoNs = monoNs;
+    m_anchorWallNs = wallNs;
+    m_lastNs = -1;
+    m_cachedSecond = -1;
+}
+
+QByteArrayView TimestampFormatter::format(qint64 arrivalNs) {
+    const qint64 previous = m_lastNs < 0 ? arrivalNs : m_lastNs;
+    m_lastNs = arrivalNs;
+    switch (m_mode) {
+    case Mode::Relative:
+        return formatElapsed("[+", arrivalNs - m_anchorMonoNs);
+    case Mode::Delta:
+        return formatElapsed("[\xCE\x94+", arrivalNs - previous);
+    case Mode::Absolute:
+    case Mode::AbsoluteMicro:
+        break;
+    }
+    return formatAbsolute(arrivalNs);
+}
+
+QByteArrayView TimestampFormatter::formatAbsolute(qint64 arrivalNs) {
+    const qint64 wall = wallNs(arrivalNs);
+    qint64 second = wall / kNsPerSec;
+    qint64 subNs = wall % kNsPerSec;
+    if (subNs < 0) {
+        subNs += kNsPerSec;
+        --second;
+    }
+
+    if (second != m_cachedSecond) {
+        const QByteArray prefix = QDateTime::fromSecsSinceEpoch(second, m_timeZone)
+                                      .toString("[dd-MM-yyyy HH:mm:ss:").toLatin1();
+        m_prefixLen = int(qMin<qsizetype>(prefix.size(), sizeof(m_absolute) - 8));
+        std::memcpy(m_absolute, prefix.constData(), std::size_t(m_prefixLen));
+        m_cachedSecond = second;
+    }
+
+    char* p = m_absolute + m_prefixLen;
+    if (m_mode == Mode::AbsoluteMicro) {
+        p = writeDigits(p, quint64(subNs / 1000), 6);
+    } else {
+        p = writeDigits(p, quint64(subNs / 1000000), 3);
+    }
+    *p++ = ']';
+    return QByteArrayView(m_absolute, p - m_absolute);
+}
+
+QByteArrayView TimestampFormatter::formatElapsed(const char* tag, qint64 ns) {
+    if (ns < 0) ns = 0;
+    const std::size_t tagLen = std::strlen(tag);
+    std::memcpy(m_elapsed, tag, tagLen);
+    char* p = writeNumber(m_elapsed + tagLen, quint64(ns / kNsPerSec));
+    *p++ = '.';
+    p = writeDigits(p, quint64((ns % kNsPerSec) / 1000), 6);
+    *p++ = ']';
+    return QByteArrayView(m_elapsed, p - m_elapsed);
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <QByteArrayView>
+#include <QTimeZone>
+
+// Formats per-line timestamp prefixes from monotonic arrival times without
+// allocating. The date/time text is rebuilt once per second (or timezone
+// change) and only the sub-second digits are patched in for each line.
+class TimestampFormatter {
+public:
+    enum class Mode { Absolute, AbsoluteMicro, Relative, Delta };
+
+    static qint64 monotonicNs();
+    static qint64 wallClockNs();
+
+    void setMode(Mode mode) { m_mode = mode; }
+    Mode mode() const { return m_mode; }
+    void setTimeZone(const QTimeZone& tz);
+
+    void start(qint64 monoNs);
+    void start(qint64 monoNs, qint64 wallNs);
+    QByteArrayView format(qint64 arrivalNs);
+    qint64 wallNs(qint64 monoNs) const { return m_anchorWallNs + (monoNs - m_anchorMonoNs); }
+
+private:
+    QByteArrayView formatAbsolute(qint64 arrivalNs);
+    QByteArrayView formatElapsed(const char* tag, qint64 ns);
+
+    Mode m_mode = Mode::Absolute;
+    QTimeZone m_timeZone = QTimeZone::systemTimeZone();
+    qint64 m_anchorMonoNs = 0;
+    qint64 m_anchorWallNs = 0;
+    qint64 m_lastNs = -1;
+    qint64 m_cachedSecond = -1;
+    int m_prefixLen = 0;
+    char m_absolute[48] = {};
+    char m_elapsed[48] = {};
+};
@@ -0,0 +1,85 @@
+#include "transmitdialog.h"
+
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+TransmitDialog::TransmitDialog(QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Send File");
+
+    m_pathEdit = new QLineEdit(this);
+    auto browseBtn = new QPushButton("Browse...", this);
+    connect(browseBtn, &QPushButton::clicked, this, &TransmitDialog::browse);
+    auto pathRow = new QHBoxLayout();
+    pathRow->addWidget(m_pathEdit, 1);
+    pathRow->addWidget(browseBtn);
+
+    m_modeCombo = new QComboBox(this);
+    m_modeCombo->addItem("Raw bytes", false);
+    m_modeCombo->addItem("Line by line", true);
+
+    m_rateSpin = new QSpinBox(this);
+    m_rateSpin->setRange(0, 1000000);
+    m_rateSpin->setSingleStep(1000);
+    m_rateSpin->setSuffix(" B/s");
+    m_rateSpin->setSpecialValueText("Unlimited");
+
+    m_lineDelaySpin = new QSpinBox(this);
+    m_lineDelaySpin->setRange(0, 60000);
+    m_lineDelaySpin->setSuffix(" ms");
+    m_lineDelaySpin->setSpecialValueText("None");
+
+    connect(m_modeCombo, &QComboBox::currentIndexChanged, this, &TransmitDialog::updateEnabled);
+
+    auto form = new QFormLayout();
+    form->addRow("File:", pathRow);
+    form->addRow("Send as:", m_modeCombo);
+    form->addRow("Rate limit:", m_rateSpin);
+    form->addRow("Delay after line:", m_lineDelaySpin);
+
+    auto okBtn = new QPushButton("Send", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, [this]() {
+        if (!m_pathEdit->text().isEmpty()) accept();
+    });
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+
+    updateEnabled();
+}
+
+void TransmitDialog::browse() {
+    const QString path = QFileDialog::getOpenFileName(this, "Send File", m_pathEdit->text());
+    if (!path.isEmpty()) m_pathEdit->setText(path);
+}
+
+void TransmitDialog::updateEnabled() {
+    m_lineDelaySpin->setEnabled(m_modeCombo->currentData().toBool());
+}
+
+QList<TransmitEngine::Step> TransmitDialog::steps() const {
+    TransmitEngine::Step rate;
+    rate.kind = TransmitEngine::Step::Kind::SetRate;
+    rate.value = m_rateSpin->value();
+
+    TransmitEngine::Step lineDelay;
+    lineDelay.kind = TransmitEngine::Step::Kind::SetLineDelay;
+    lineDelay.value = m_lineDelaySpin->value();
+
+    TransmitEngine::Step file;
+    file.kind = TransmitEngine::Step::Kind::SendFile;
+    file.path = m_pathEdit->text();
+    file.lines = m_modeCombo->currentData().toBool();
+    return {rate, lineDelay, file};
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLineEdit>
+#include <QSpinBox>
+
+#include "transmitengine.h"
+
+class TransmitDialog : public QDialog {
+    Q_OBJECT
+public:
+    explicit TransmitDialog(QWidget* parent = nullptr);
+
+    QList<TransmitEngine::Step> steps() const;
+
+private:
+    void browse();
+    void updateEnabled();
+
+    QLineEdit* m_pathEdit;
+    QComboBox* m_modeCombo;
+    QSpinBox* m_rateSpin;
+    QSpinBox* m_lineDelaySpin;
+};
@@ -0,0 +1,323 @@
+#include "transmitengine.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QRegularExpression>
+#include <QSerialPort>
+
+#include <cmath>
+
+#include "timestampformatter.h"
+
+static const qint64 kMaxInFlight = 16 * 1024;
+static const qint64 kChunkSize = 4096;
+static const qint64 kFileReadSize = 64 * 1024;
+static const qint64 kPaceSliceMs = 20;
+static const qint64 kProgressIntervalNs = 100000000;
+
+QByteArray TransmitEngine::unescape(const QString& text) {
+    const QByteArray in = text.toUtf8();
+    QByteArray out;
+    out.reserve(in.size());
+    for (qsizetype i = 0; i < in.size(); ++i) {
+        const char c = in[i];
+        if (c != '\\' || i + 1 == in.size()) {
+            out.append(c);
+            continue;
+        }
+        const char e = in[++i];
+        switch (e) {
+        case 'r': out.append('\r'); break;
+        case 'n': out.append('\n'); break;
+        case 't': out.append('\t'); break;
+        case '0': out.append('\0'); break;
+        case 'x': {
+            bool ok = false;
+            const int value = in.mid(i + 1, 2).toInt(&ok, 16);
+            if (ok && i + 2 < in.size()) {
+                out.append(char(value));
+                i += 2;
+            } else {
+                out.append("\\x");
+            }
+            break;
+        }
+        default: out.append(e); break;
+        }
+    }
+    return out;
+}
+
+QList<TransmitEngine::Step> TransmitEngine::parseScript(const QString& text, const QString& baseDir, QString* error) {
+    static const QRegularExpression space("\\s");
+    QList<Step> steps;
+    const QStringList lines = text.split('\n');
+    for (qsizetype i = 0; i < lines.size(); ++i) {
+        const QString line = lines[i].trimmed();
+        if (line.isEmpty() || line.startsWith('#')) continue;
+
+        const qsizetype split = line.indexOf(space);
+        const QString command = (split < 0 ? line : line.left(split)).toLower();
+        const QString arg = split < 0 ? QString() : line.mid(split + 1);
+        auto fail = [&](const QString& what) {
+            if (error) *error = QString("Line %1: %2").arg(i + 1).arg(what);
+            return QList<Step>();
+        };
+        auto number = [](const QString& s, qint64* value) {
+            bool ok = false;
+            *value = s.trimmed().toLongLong(&ok);
+            return ok && *value >= 0;
+        };
+
+        Step step;
+        if (command == "send") {
+            step.data = unescape(arg);
+        } else if (command == "sendline") {
+            step.data = unescape(arg) + "\r\n";
+            step.lines = true;
+        } else if (command == "file" || command == "lines") {
+            step.kind = Step::Kind::SendFile;
+            step.path = QDir(baseDir).filePath(arg.trimmed());
+            step.lines = command == "lines";
+            if (!QFileInfo(step.path).isFile()) return fail(QString("no such file \"%1\"").arg(arg.trimmed()));
+        } else if (command == "delay") {
+            step.kind = Step::Kind::Delay;
+            if (!number(arg, &step.value)) return fail("expected a delay in ms");
+        } else if (command == "wait") {
+            step.kind = Step::Kind::WaitFor;
+            const QString rest = arg.trimmed();
+            const qsizetype textAt = rest.indexOf(space);
+            if (textAt < 0 || !number(rest.left(textAt), &step.value)) return fail("expected: wait <ms> <text>");
+            step.data = unescape(rest.mid(textAt + 1));
+        } else if (command == "rate") {
+            step.kind = Step::Kind::SetRate;
+            if (!number(arg, &step.value)) return fail("expected a rate in bytes/s");
+        } else if (command == "linedelay") {
+            step.kind = Step::Kind::SetLineDelay;
+            if (!number(arg, &step.value)) return fail("expected a delay in ms");
+        } else {
+            return fail(QString("unknown command \"%1\"").arg(command));
+        }
+        steps.append(step);
+    }
+    if (error) error->clear();
+    return steps;
+}
+
+TransmitEngine::TransmitEngine(QSerialPort* port, QObject* parent)
+    : QObject(parent), m_port(port) {
+    m_timer = new QTimer(this);
+    m_timer->setSingleShot(true);
+    m_timer->setTimerType(Qt::PreciseTimer);
+    connect(m_timer, &QTimer::timeout, this, &TransmitEngine::onTimer);
+    connect(m_port, &QSerialPort::bytesWritten, this, &TransmitEngine::onBytesWritten);
+}
+
+void TransmitEngine::enqueue(const QList<Step>& steps) {
+    if (!m_port->isOpen()) {
+        emit finished(false, "Port is not open.");
+        return;
+    }
+    if (m_state == State::Idle) {
+        m_total = 0;
+        m_sent = 0;
+        m_reportedSent = 0;
+        m_reportedNs = TimestampFormatter::monotonicNs();
+        m_rate = 0;
+        m_lineDelayMs = 0;
+        m_state = State::Running;
+    }
+    for (const Step& step : steps) {
+        if (step.kind == Step::Kind::Send) m_total += step.data.size();
+        else if (step.kind == Step::Kind::SendFile) m_total += QFileInfo(step.path).size();
+    }
+    m_queue.append(steps);
+    pump();
+}
+
+void TransmitEngine::stop(const QString& reason) {
+    if (m_state == State::Idle) return;
+    if (m_port->isOpen()) m_port->clear(QSerialPort::Output);
+    finish(false, reason.isEmpty() ? QString("Stopped.") : reason);
+}
+
+void TransmitEngine::received(QByteArrayView data) {
+    if (m_state != State::Waiting) return;
+    m_waitWindow.append(data);
+    if (m_waitWindow.contains(m_waitFor)) {
+        m_timer->stop();
+        m_waitWindow.clear();
+        m_state = State::Running;
+        pump();
+        return;
+    }
+    const qsizetype keep = m_waitFor.size() - 1;
+    if (m_waitWindow.size() > keep) m_waitWindow.remove(0, m_waitWindow.size() - keep);
+}
+
+void TransmitEngine::pump() {
+    while (m_state == State::Running) {
+        if (m_pendingOffset < m_pending.size()) {
+            if (!writePending()) return;
+            continue;
+        }
+        if (m_lineDone && m_lineDelayMs > 0) {
+            // The delay counts from when the line has left the port.
+            if (m_port->bytesToWrite() > 0) return;
+            m_lineDone = false;
+            m_state = State::Delaying;
+            m_timer->start(int(m_lineDelayMs));
+            return;
+        }
+        m_lineDone = false;
+        if (m_file.isOpen()) {
+            if (!refillFromFile()) return;
+            continue;
+        }
+        if (m_queue.isEmpty()) {
+            if (m_port->bytesToWrite() == 0) finish(true, QString());
+            return;
+        }
+        if (!startStep(m_queue.takeFirst())) return;
+    }
+}
+
+// Writes one chunk if the port buffer has room and, when pacing, enough
+// credit has built up. Returns false when the caller has to wait for
+// bytesWritten or the pacing timer.
+bool TransmitEngine::writePending() {
+    const qint64 room = kMaxInFlight - m_port->bytesToWrite();
+    if (room <= 0) return false;
+    qint64 n = qMin(qMin(room, kChunkSize), qint64(m_pending.size() - m_pendingOffset));
+
+    if (m_rate > 0) {
+        const double wanted = qMin(qMax(1.0, double(m_rate) * kPaceSliceMs / 1000.0), double(n));
+        const double credit = paceCredit();
+        if (credit < wanted) {
+            m_timer->start(qMax(1, int(std::ceil((wanted - credit) * 1000.0 / double(m_rate)))));
+            return false;
+        }
+        n = qMin(n, qint64(credit));
+    }
+
+    const qint64 written = m_port->write(m_pending.constData() + m_pendingOffset, n);
+    if (written < 0) {
+        finish(false, QString("Write failed: %1").arg(m_port->errorString()));
+        return false;
+    }
+    if (m_rate > 0) m_credit -= double(written);
+    m_pendingOffset += written;
+    if (m_pendingOffset == m_pending.size()) {
+        m_lineDone = m_pendingIsLine;
+        m_pending.clear();
+        m_pendingOffset = 0;
+    }
+    return true;
+}
+
+// Token bucket: credit accrues at the rate and is capped at one pacing
+// slice, so a pause is not followed by a burst.
+double TransmitEngine::paceCredit() {
+    const qint64 now = TimestampFormatter::monotonicNs();
+    const double slice = qMax(1.0, double(m_rate) * kPaceSliceMs / 1000.0);
+    m_credit = qMin(slice, m_credit + double(now - m_creditNs) * double(m_rate) / 1e9);
+    m_creditNs = now;
+    return m_credit;
+}
+
+bool TransmitEngine::refillFromFile() {
+    if (m_file.atEnd()) {
+        m_file.close();
+        return true;
+    }
+    m_pending = m_fileLines ? m_file.readLine(kFileReadSize) : m_file.read(kFileReadSize);
+    m_pendingOffset = 0;
+    m_pendingIsLine = m_fileLines;
+    if (m_pending.isEmpty()) {
+        finish(false, QString("Failed to read %1: %2").arg(m_file.fileName(), m_file.errorString()));
+        return false;
+    }
+    return true;
+}
+
+bool TransmitEngine::startStep(const Step& step) {
+    switch (step.kind) {
+    case Step::Kind::Send:
+        m_pending = step.data;
+        m_pendingOffset = 0;
+        m_pendingIsLine = step.lines;
+        break;
+    case Step::Kind::SendFile:
+        m_file.setFileName(step.path);
+        if (!m_file.open(QIODevice::ReadOnly)) {
+            finish(false, QString("Failed to open %1: %2").arg(step.path, m_file.errorString()));
+            return false;
+        }
+        m_fileLines = step.lines;
+        break;
+    case Step::Kind::Delay:
+        m_state = State::Delaying;
+        m_timer->start(int(step.value));
+        break;
+    case Step::Kind::WaitFor:
+        m_waitFor = step.data;
+        m_waitWindow.clear();
+        m_state = State::Waiting;
+        if (step.value > 0) m_timer->start(int(step.value));
+        else m_timer->stop();
+        break;
+    case Step::Kind::SetRate:
+        m_rate = step.value;
+        m_credit = 0;
+        m_creditNs = TimestampFormatter::monotonicNs();
+        break;
+    case Step::Kind::SetLineDelay:
+        m_lineDelayMs = step.value;
+        break;
+    }
+    return true;
+}
+
+void TransmitEngine::onBytesWritten(qint64 bytes) {
+    if (m_state == State::Idle) return;
+    m_sent += bytes;
+    emitProgress(false);
+    pump();
+}
+
+void TransmitEngine::onTimer() {
+    switch (m_state) {
+    case State::Waiting:
+        finish(false, QString("Timed out waiting for \"%1\".").arg(QString::fromUtf8(m_waitFor)));
+        return;
+    case State::Delaying:
+        m_state = State::Running;
+        break;
+    case State::Running:
+    case State::Idle:
+        break;
+    }
+    pump();
+}
+
+void TransmitEngine::finish(bool ok, const QString& error) {
+    m_state = State::Idle;
+    m_timer->stop();
+    m_queue.clear();
+    m_pending.clear();
+    m_pendingOffset = 0;
+    m_lineDone = false;
+    m_file.close();
+    emitProgress(true);
+    emit finished(ok, error);
+}
+
+void TransmitEngine::emitProgress(bool force) {
+    const qint64 now = TimestampFormatter::monotonicNs();
+    const qint64 elapsed = now - m_reportedNs;
+    if (!force && elapsed < kProgressIntervalNs) return;
+    const qint64 rate = elapsed > 0 ? qint64(double(m_sent - m_reportedSent) * 1e9 / double(elapsed)) : 0;
+    m_reportedSent = m_sent;
+    m_reportedNs = now;
+    emit progress(m_sent, m_total, rate);
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+class QSerialPort;
+
+// Queued, non-blocking transmit for a serial port. Steps are written in
+// chunks only while the port's write buffer has room, so a long transfer
+// never stalls the thread that also reads the port; bytesWritten drives the
+// next chunk. Sends can be paced to a byte rate or spaced by a delay after
+// each line, and a script can wait for a prompt in the received data.
+class TransmitEngine : public QObject {
+    Q_OBJECT
+public:
+    struct Step {
+        enum class Kind { Send, SendFile, Delay, WaitFor, SetRate, SetLineDelay };
+
+        Kind kind = Kind::Send;
+        QByteArray data;    // Send bytes, WaitFor prompt
+        QString path;       // SendFile
+        bool lines = false; // Send: ends a line; SendFile: sent line by line
+        qint64 value = 0;   // Delay and WaitFor timeout in ms, rate in bytes/s, line delay in ms
+    };
+
+    // One step per line:
+    //   send <text>       bytes, with \r \n \t \\ and \xNN escapes
+    //   sendline <text>   text plus CR LF, counted as a line
+    //   file <path>       raw file contents, relative to `baseDir`
+    //   lines <path>      file sent line by line
+    //   delay <ms>
+    //   wait <ms> <text>  wait for text to be received, 0 ms waits forever
+    //   rate <bytes/s>    0 turns pacing off
+    //   linedelay <ms>
+    // Blank lines and lines starting with '#' are skipped.
+    static QList<Step> parseScript(const QString& text, const QString& baseDir, QString* error);
+    static QByteArray unescape(const QString& text);
+
+    explicit TransmitEngine(QSerialPort* port, QObject* parent = nullptr);
+
+    bool isActive() const { return m_state != State::Idle; }
+
+    void enqueue(const QList<Step>& steps);
+    void stop(const QString& reason = QString());
+    // Received bytes, checked against a pending wait step.
+    void received(QByteArrayView data);
+
+signals:
+    // `total` covers everything queued so far in this run.
+    void progress(qint64 sent, qint64 total, qint64 bytesPerSec);
+    void finished(bool ok, const QString& error);
+
+private slots:
+    void pump();
+    void onBytesWritten(qint64 bytes);
+    void onTimer();
+
+private:
+    enum class State { Idle, Running, Delaying, Waiting };
+
+    bool writePending();
+    bool refillFromFile();
+    bool startStep(const Step& step);
+    double paceCredit();
+    void finish(bool ok, const QString& error);
+    void emitProgress(bool force);
+
+    QSerialPort* m_port;
+    QTimer* m_timer;
+    State m_state = State::Idle;
+    QList<Step> m_queue;
+
+    QByteArray m_pending;
+    qsizetype m_pendingOffset = 0;
+    bool m_pendingIsLine = false;
+    bool m_lineDone = false;
+    QFile m_file;
+    bool m_fileLines = false;
+
+    qint64 m_rate = 0;
+    qint64 m_lineDelayMs = 0;
+    double m_credit = 0;
+    qint64 m_creditNs = 0;
+
+    QByteArray m_waitFor;
+    QByteArray m_waitWindow;
+
+    qint64 m_total = 0;
+    qint64 m_sent = 0;
+    qint64 m_reportedSent = 0;
+    qint64 m_reportedNs = 0;
+};
@@ -0,0 +1,170 @@
+#include "triggercapture.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+
+#include <cstring>
+
+// Longer lines are matched on their first part only.
+static const qsizetype kMaxMatchLine = 64 * 1024;
+static const qsizetype kMaxEventLine = 256;
+// Triggers that fire while this many snapshots are still being written are
+// skipped, which keeps memory bounded when a device floods the pattern.
+static const int kMaxWritesInFlight = 2;
+
+TriggerCapture::TriggerCapture(const Options& options, const PatternMatcher& matcher, FiredCallback onFired,
+                               SavedCallback onSaved)
+    : m_options(options), m_matcher(matcher), m_onFired(std::move(onFired)), m_onSaved(std::move(onSaved)) {
+    m_pool.setMaxThreadCount(1);
+}
+
+TriggerCapture::~TriggerCapture() {
+    finish();
+    m_pool.waitForDone();
+}
+
+void TriggerCapture::feed(QByteArrayView text) {
+    qsizetype pos = 0;
+    while (pos < text.size()) {
+        switch (m_state) {
+        case State::Armed: pos = scan(text, pos); break;
+        case State::Collecting: pos = collect(text, pos); break;
+        case State::Done: return;
+        }
+    }
+}
+
+// Looks for a trigger line, keeping the text it passes over. Returns the
+// position just after the trigger line, or the end of the text.
+qsizetype TriggerCapture::scan(QByteArrayView text, qsizetype from) {
+    qsizetype pos = from;
+    while (pos < text.size()) {
+        const qsizetype newline = text.indexOf('\n', pos);
+        if (newline < 0) {
+            appendPartial(text.sliced(pos));
+            break;
+        }
+        QByteArrayView line = text.sliced(pos, newline - pos);
+        if (!m_partial.isEmpty()) {
+            appendPartial(line);
+            line = m_partial;
+        }
+        pos = newline + 1;
+        if (m_matcher.matches(line)) {
+            keep(text.sliced(from, pos - from));
+            fire(line);
+            m_partial.resize(0);
+            return pos;
+        }
+        m_partial.resize(0);
+    }
+    keep(text.sliced(from));
+    return text.size();
+}
+
+qsizetype TriggerCapture::collect(QByteArrayView text, qsizetype from) {
+    qsizetype pos = from;
+    while (m_postLeft > 0 && pos < text.size()) {
+        const qsizetype newline = text.indexOf('\n', pos);
+        if (newline < 0) {
+            pos = text.size();
+            break;
+        }
+        pos = newline + 1;
+        --m_postLeft;
+    }
+    m_snapshot.post.append(text.sliced(from, pos - from));
+    if (m_postLeft == 0 || m_snapshot.post.size() >= m_options.preBytes) finish();
+    return pos;
+}
+
+void TriggerCapture::keep(QByteArrayView data) {
+    const qsizetype capacity = qsizetype(m_options.preBytes);
+    if (capacity <= 0 || data.isEmpty()) return;
+    if (m_ring.isEmpty()) m_ring = QByteArray(capacity, Qt::Uninitialized);
+    if (data.size() >= capacity) {
+        std::memcpy(m_ring.data(), data.data() + data.size() - capacity, std::size_t(capacity));
+        m_head = 0;
+        m_filled = capacity;
+        return;
+    }
+    const qsizetype first = qMin(data.size(), capacity - m_head);
+    std::memcpy(m_ring.data() + m_head, data.data(), std::size_t(first));
+    std::memcpy(m_ring.data(), data.data() + first, std::size_t(data.size() - first));
+    m_head = (m_head + data.size()) % capacity;
+    m_filled = qMin(capacity, m_filled + data.size());
+}
+
+void TriggerCapture::appendPartial(QByteArrayView data) {
+    const qsizetype room = kMaxMatchLine - m_partial.size();
+    if (room > 0) m_partial.append(data.first(qMin(room, data.size())));
+}
+
+void TriggerCapture::fire(QByteArrayView line) {
+    if (m_writesInFlight.load(std::memory_order_acquire) >= kMaxWritesInFlight) return;
+
+    // The sequence number keeps re-armed triggers firing in the same
+    // millisecond apart.
+    const QString name = QString("%1_trigger_%2_%3.txt")
+                             .arg(m_options.prefix, QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss-zzz"))
+                             .arg(++m_sequence);
+    m_snapshot = Snapshot();
+    m_snapshot.path = QDir(m_options.directory).filePath(name);
+    m_snapshot.ring = std::move(m_ring);
+    m_snapshot.head = m_head;
+    m_snapshot.filled = m_filled;
+    m_ring = QByteArray();
+    m_head = 0;
+    m_filled = 0;
+    m_postLeft = m_options.postLines;
+    m_state = State::Collecting;
+
+    if (m_onFired) m_onFired(m_snapshot.path, line.first(qMin(line.size(), kMaxEventLine)).toByteArray());
+    if (m_postLeft == 0) finish();
+}
+
+void TriggerCapture::finish() {
+    if (m_state != State::Collecting) return;
+    m_state = m_options.rearm ? State::Armed : State::Done;
+
+    const Snapshot snapshot = std::move(m_snapshot);
+    m_snapshot = Snapshot();
+    m_writesInFlight.fetch_add(1, std::memory_order_acq_rel);
+    m_pool.start([this, snapshot]() {
+        qint64 bytes = 0;
+        const QString error = write(snapshot, &bytes);
+        m_writesInFlight.fetch_sub(1, std::memory_order_acq_rel);
+        if (m_onSaved) m_onSaved(snapshot.path, bytes, error);
+    });
+}
+
+QString TriggerCapture::write(const Snapshot& snapshot, qint64* bytes) {
+    QFile file(snapshot.path);
+    // Never overwrites: an existing file is reported as an error.
+    if (!file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) return file.errorString();
+
+    const QByteArrayView ring(snapshot.ring);
+    const bool wrapped = snapshot.filled == ring.size() && !ring.isEmpty();
+    QByteArrayView older = wrapped ? ring.sliced(snapshot.head) : QByteArrayView();
+    QByteArrayView newer = ring.first(wrapped ? snapshot.head : snapshot.filled);
+    // A full ring starts part way through a line; that piece is dropped.
+    if (wrapped) {
+        const qsizetype newline = older.indexOf('\n');
+        if (newline >= 0) {
+            older = older.sliced(newline + 1);
+        } else {
+            older = QByteArrayView();
+            const qsizetype inNewer = newer.indexOf('\n');
+            newer = inNewer >= 0 ? newer.sliced(inNewer + 1) : QByteArrayView();
+        }
+    }
+
+    for (const QByteArrayView part : {older, newer, QByteArrayView(snapshot.post)}) {
+        if (part.isEmpty()) continue;
+        if (file.write(part.data(), part.size()) != part.size()) return file.errorString();
+        *bytes += part.size();
+    }
+    if (!file.flush()) return file.errorString();
+    return QString();
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QString>
+#include <QThreadPool>
+
+#include <atomic>
+#include <functional>
+
+#include "patternmatcher.h"
+
+// Oscilloscope-style trigger on the formatted output. While armed, the
+// newest `preBytes` of text are kept in a fixed ring; when a line matches,
+// the ring (ending with that line) and the next `postLines` lines become one
+// snapshot file. Firing hands the ring's buffer to the snapshot instead of
+// copying it, and files are written by a private pool thread, so the reader
+// thread only ever scans lines and copies them into the ring.
+class TriggerCapture {
+public:
+    struct Options {
+        qint64 preBytes = 4 * 1024 * 1024;
+        int postLines = 200;
+        QString directory;
+        QString prefix;     // file name prefix, usually the port
+        bool rearm = true;
+    };
+
+    // `onFired` runs on the calling thread from feed(); `onSaved` runs on
+    // the pool thread once a snapshot is on disk or has failed.
+    using FiredCallback = std::function<void(const QString& path, const QByteArray& line)>;
+    using SavedCallback = std::function<void(const QString& path, qint64 bytes, const QString& error)>;
+
+    TriggerCapture(const Options& options, const PatternMatcher& matcher, FiredCallback onFired, SavedCallback onSaved);
+    // Saves a snapshot still collecting post-trigger lines and waits for
+    // every pending write.
+    ~TriggerCapture();
+
+    void feed(QByteArrayView text);
+    bool isCollecting() const { return m_state == State::Collecting; }
+    // Writes the snapshot being collected with the lines it has so far.
+    void finish();
+
+private:
+    enum class State { Armed, Collecting, Done };
+
+    struct Snapshot {
+        QString path;
+        QByteArray ring;
+        qsizetype head = 0;
+        qsizetype filled = 0;
+        QByteArray post;
+    };
+
+    qsizetype scan(QByteArrayView text, qsizetype from);
+    qsizetype collect(QByteArrayView text, qsizetype from);
+    void keep(QByteArrayView data);
+    void appendPartial(QByteArrayView data);
+    void fire(QByteArrayView line);
+    static QString write(const Snapshot& snapshot, qint64* bytes);
+
+    const Options m_options;
+    const PatternMatcher m_matcher;
+    FiredCallback m_onFired;
+    SavedCallback m_onSaved;
+    State m_state = State::Armed;
+
+    QByteArray m_ring;
+    qsizetype m_head = 0;
+    qsizetype m_filled = 0;
+    QByteArray m_partial;
+
+    Snapshot m_snapshot;
+    int m_postLeft = 0;
+    int m_sequence = 0;
+
+    std::atomic<int> m_writesInFlight{0};
+    QThreadPool m_pool;
+};
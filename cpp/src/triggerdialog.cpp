@@ -0,0 +1,104 @@
+#include "triggerdialog.h"
+
+#include <QFileDialog>
+#include <QFormLayout>
+#include <QHBoxLayout>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+QStringList TriggerDialog::Settings::patternList() const {
+    const QString text = patterns.trimmed();
+    if (text.isEmpty()) return {};
+    if (regex) return {text};
+
+    QStringList out;
+    for (const QString& part : text.split(',')) {
+        const QString pattern = part.trimmed();
+        if (!pattern.isEmpty()) out.append(pattern);
+    }
+    return out;
+}
+
+TriggerDialog::TriggerDialog(const Settings& current, QWidget* parent)
+    : QDialog(parent) {
+    setWindowTitle("Arm Trigger");
+
+    m_patternEdit = new QLineEdit(current.patterns, this);
+    m_patternEdit->setPlaceholderText("HardFault, assert");
+    m_regexCheck = new QCheckBox("Regex", this);
+    m_regexCheck->setChecked(current.regex);
+    m_matchCaseCheck = new QCheckBox("Match case", this);
+    m_matchCaseCheck->setChecked(current.matchCase);
+    auto patternRow = new QHBoxLayout();
+    patternRow->addWidget(m_patternEdit, 1);
+    patternRow->addWidget(m_regexCheck);
+    patternRow->addWidget(m_matchCaseCheck);
+
+    m_preSpin = new QSpinBox(this);
+    m_preSpin->setRange(1, 1024);
+    m_preSpin->setSuffix(" MB");
+    m_preSpin->setValue(current.preMb);
+
+    m_postSpin = new QSpinBox(this);
+    m_postSpin->setRange(0, 1000000);
+    m_postSpin->setSuffix(" lines");
+    m_postSpin->setValue(current.postLines);
+
+    m_dirEdit = new QLineEdit(current.directory, this);
+    auto browseBtn = new QPushButton("Browse...", this);
+    connect(browseBtn, &QPushButton::clicked, this, &TriggerDialog::browse);
+    auto dirRow = new QHBoxLayout();
+    dirRow->addWidget(m_dirEdit, 1);
+    dirRow->addWidget(browseBtn);
+
+    m_rearmCheck = new QCheckBox("Re-arm after each snapshot", this);
+    m_rearmCheck->setChecked(current.rearm);
+    m_pauseCheck = new QCheckBox("Pause the view", this);
+    m_pauseCheck->setChecked(current.pauseView);
+    m_beepCheck = new QCheckBox("Beep", this);
+    m_beepCheck->setChecked(current.beep);
+
+    auto form = new QFormLayout();
+    form->addRow("Trigger on:", patternRow);
+    form->addRow("Keep before:", m_preSpin);
+    form->addRow("Keep after:", m_postSpin);
+    form->addRow("Save to:", dirRow);
+    form->addRow(QString(), m_rearmCheck);
+    form->addRow("On trigger:", m_pauseCheck);
+    form->addRow(QString(), m_beepCheck);
+
+    auto okBtn = new QPushButton("Arm", this);
+    auto cancelBtn = new QPushButton("Cancel", this);
+    connect(okBtn, &QPushButton::clicked, this, [this]() {
+        if (!settings().patternList().isEmpty() && !m_dirEdit->text().isEmpty()) accept();
+    });
+    connect(cancelBtn, &QPushButton::clicked, this, &QDialog::reject);
+
+    auto buttons = new QHBoxLayout();
+    buttons->addStretch();
+    buttons->addWidget(okBtn);
+    buttons->addWidget(cancelBtn);
+
+    auto layout = new QVBoxLayout(this);
+    layout->addLayout(form);
+    layout->addLayout(buttons);
+}
+
+void TriggerDialog::browse() {
+    const QString dir = QFileDialog::getExistingDirectory(this, "Save Snapshots To", m_dirEdit->text());
+    if (!dir.isEmpty()) m_dirEdit->setText(dir);
+}
+
+TriggerDialog::Settings TriggerDialog::settings() const {
+    Settings settings;
+    settings.patterns = m_patternEdit->text();
+    settings.regex = m_regexCheck->isChecked();
+    settings.matchCase = m_matchCaseCheck->isChecked();
+    settings.preMb = m_preSpin->value();
+    settings.postLines = m_postSpin->value();
+    settings.directory = m_dirEdit->text();
+    settings.rearm = m_rearmCheck->isChecked();
+    settings.pauseView = m_pauseCheck->isChecked();
+    settings.beep = m_beepCheck->isChecked();
+    return settings;
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QDialog>
+#include <QCheckBox>
+#include <QLineEdit>
+#include <QSpinBox>
+
+class TriggerDialog : public QDialog {
+    Q_OBJECT
+public:
+    struct Settings {
+        QString patterns;
+        bool regex = false;
+        bool matchCase = false;
+        int preMb = 4;
+        int postLines = 200;
+        QString directory;
+        bool rearm = true;
+        bool pauseView = false;
+        bool beep = false;
+
+        // Comma separated unless the text is a regex, as in the filter bar.
+        QStringList patternList() const;
+    };
+
+    explicit TriggerDialog(const Settings& current, QWidget* parent = nullptr);
+
+    Settings settings() const;
+
+private:
+    void browse();
+
+    QLineEdit* m_patternEdit;
+    QCheckBox* m_regexCheck;
+    QCheckBox* m_matchCaseCheck;
+    QSpinBox* m_preSpin;
+    QSpinBox* m_postSpin;
+    QLineEdit* m_dirEdit;
+    QCheckBox* m_rearmCheck;
+    QCheckBox* m_pauseCheck;
+    QCheckBox* m_beepCheck;
+};